@@ -0,0 +1,94 @@
+/*
+ * beat_drift.c: host-side drift report for the metronome beat timing
+ *
+ * ----------------------------
+ *  Created on: Dec 2, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Compares the cumulative timing error after 10,000 beats, at every BPM from 50 to 150, between
+ * the old millisecond scheme (beat_time_ms = 60000 / BPM, rescheduled from event->time) and the
+ * periodic metronome event, whose beat period comes from the tempo table and is stepped by
+ * EventPeriodAdvance() in Util/event.h. The error is measured against the exact ideal beat time
+ * N * 60 / BPM seconds, so it includes truncation of the beat period but not dispatch latency.
+ *
+ * Built by Host/Makefile, and run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "event.h"
+#include "tempo_table.h"
+
+#define BEATS       10000
+#define MIN_BPM     50
+#define MAX_BPM     150
+
+// Ticks in one minute; one beat lasts TICKS_PER_MINUTE / BPM ticks
+#define TICKS_PER_MINUTE (60 * EVENT_TICK_RATE)
+
+// Nanoseconds per event tick
+#define NS_PER_TICK (1000000000ULL / EVENT_TICK_RATE)
+
+// Error of the old scheme after the given number of beats, in nanoseconds. Every beat
+// lasted the truncated beat_time_ms, so the error grows linearly with the beat count.
+static double OldSchemeError(uint32_t bpm, uint32_t beats)
+{
+    uint32_t beat_time_ms = 60000 / bpm;
+    double ideal_ns = (double) beats * 60e9 / bpm;
+    double actual_ns = (double) beats * beat_time_ms * 1e6;
+    return ideal_ns - actual_ns;
+}
+
+// Largest error of the periodic event over the given number of beats, in nanoseconds. The
+// error is computed exactly as (N * TICKS_PER_MINUTE - time * BPM) / BPM ticks.
+static double PeriodicMaxError(uint32_t bpm, uint32_t beats)
+{
+    const TempoEntry *tempo = TempoLookup(bpm);
+    EventPeriod period = {.time = 0, .ticks = tempo->period, .remainder = tempo->remainder, .divisor = bpm};
+    uint64_t max_error = 0; // in units of 1/BPM tick
+    uint32_t n;
+
+    for (n = 1; n <= beats; n++)
+    {
+        time_t time = EventPeriodAdvance(&period);
+        uint64_t ideal = (uint64_t) n * TICKS_PER_MINUTE;
+        uint64_t actual = time * bpm;
+        uint64_t error = ideal > actual ? ideal - actual : actual - ideal;
+        if (error > max_error)
+            max_error = error;
+    }
+
+    return (double) max_error * NS_PER_TICK / bpm;
+}
+
+int main(void)
+{
+    double worst_old = 0, worst_new = 0;
+    uint32_t bpm;
+
+    printf("Cumulative beat error after %d beats (ideal - scheduled)\n", BEATS);
+    printf("%5s %18s %18s\n", "BPM", "old scheme (ms)", "periodic (ns)");
+
+    for (bpm = MIN_BPM; bpm <= MAX_BPM; bpm++)
+    {
+        double old_ns = OldSchemeError(bpm, BEATS);
+        double new_ns = PeriodicMaxError(bpm, BEATS);
+
+        printf("%5u %18.3f %18.3f\n", bpm, old_ns / 1e6, new_ns);
+
+        if (old_ns > worst_old)
+            worst_old = old_ns;
+        if (new_ns > worst_new)
+            worst_new = new_ns;
+    }
+
+    printf("Worst case: old scheme %.3f ms, periodic event %.3f ns\n", worst_old / 1e6, worst_new);
+
+    // The periodic event must stay within one tick of the ideal time at every beat
+    return worst_new < NS_PER_TICK ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+/*
+ * bench.c: shared helpers of the host benchmarks
+ *
+ * ----------------------------
+ *  Created on: Dec 10, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ */
+
+#include <time.h>
+#include "bench.h"
+
+double BenchSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
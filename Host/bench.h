@@ -0,0 +1,35 @@
+/*
+ * bench.h: shared helpers of the host benchmarks
+ *
+ * ----------------------------
+ *  Created on: Dec 10, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * The clock lives in bench.c, so that benchmarks of firmware code can include event.h, whose
+ * time_t conflicts with the one of <time.h>.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+
+// Monotonic wall-clock time, in seconds
+double BenchSeconds(void);
+
+// Small deterministic pseudo-random generator (xorshift32); the state must not be 0
+static inline uint32_t BenchRandom(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,356 @@
+/*
+ * crc_bench.c: host-side conformance test and benchmark of TivaWare's driverlib/sw_crc.c
+ *
+ * ----------------------------
+ *  Created on: Dec 17, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Checks every CRC of sw_crc.c, bit for bit, on random data at random alignments, lengths and
+ * splits of a running CRC, against bit-at-a-time references of their polynomials: Crc8CCITT()
+ * and Crc32(), which still make one lookup in their tables per byte, the word steps of Crc16(),
+ * Crc16Array() and Crc16Array3(), the sliced CRC-32s and Crc32Accel().
+ *
+ * Crc32Accel() runs against a model of the hardware CRC module of the TM4C129 devices, in
+ * place of driverlib/crc.c: it shifts the bits of each word or byte written into the CRC, most
+ * significant first, after the byte and half-word swaps and the bit reversal of the
+ * configuration, as the TM4C129 data sheet describes the module. The model is checked first on
+ * the standard CRC-32 check value, in the byte-wide configuration TI documents for it.
+ *
+ * Then it times each CRC over a 16 KB buffer and over 12-byte settings records, in bytes per
+ * cycle of the host's time-stamp counter. The table lookups cost about the same against the
+ * arithmetic on a Cortex-M4 with zero-wait-state flash, so the ratios carry over better than
+ * the figures.
+ *
+ * Built by Host/Makefile, and run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/crc.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/sw_crc.h>
+#include "bench.h"
+
+#define TEST_BUFFER         4096
+#define TEST_CASES          20000
+#define BENCH_BUFFER        (16 * 1024)
+#define BENCH_BYTES         (64 * 1024 * 1024)  // through each CRC per measurement
+#define RECORD_BYTES        12                  // CRC'd bytes of a settings record
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Bit-at-a-time references
+ */
+static uint8_t RefCrc8(uint8_t crc, const uint8_t *data, uint32_t count)
+{
+    int bit;
+
+    while (count--)
+    {
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++)
+            crc = crc & 0x80 ? (uint8_t) (crc << 1) ^ 0x07 : (uint8_t) (crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t RefCrc16(uint16_t crc, const uint8_t *data, uint32_t count)
+{
+    int bit;
+
+    while (count--)
+    {
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++)
+            crc = crc & 1 ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    return crc;
+}
+
+static uint32_t RefCrc32(uint32_t crc, const uint8_t *data, uint32_t count)
+{
+    int bit;
+
+    while (count--)
+    {
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++)
+            crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    return crc;
+}
+
+static uint32_t Reverse(uint32_t value, int bits)
+{
+    uint32_t reversed = 0;
+    int i;
+
+    for (i = 0; i < bits; i++)
+        reversed |= ((value >> i) & 1) << (bits - 1 - i);
+    return reversed;
+}
+
+/*
+ * Model of the TM4C129 hardware CRC module, polynomial 0x04C11DB7 only
+ */
+static struct
+{
+    uint32_t ctrl;
+    uint32_t state;
+    uint32_t writes;        // of data, since the start
+} ccm;
+
+bool SysCtlPeripheralPresent(uint32_t ui32Peripheral) { return ui32Peripheral == SYSCTL_PERIPH_CCM0; }
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral) {}
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral) { return true; }
+
+void CRCConfigSet(uint32_t ui32Base, uint32_t ui32CRCConfig)
+{
+    CHECK((ui32CRCConfig & 0x0F) == CRC_CFG_TYPE_P4C11DB7, "the model has one polynomial, not type %u",
+          ui32CRCConfig & 0x0F);
+    ccm.ctrl = ui32CRCConfig;
+    if ((ui32CRCConfig & CRC_CFG_INIT_1) == CRC_CFG_INIT_1)
+        ccm.state = 0xFFFFFFFF;
+    else if ((ui32CRCConfig & CRC_CFG_INIT_1) == CRC_CFG_INIT_0)
+        ccm.state = 0;
+}
+
+void CRCSeedSet(uint32_t ui32Base, uint32_t ui32Seed)
+{
+    ccm.state = ui32Seed;
+}
+
+void CRCDataWrite(uint32_t ui32Base, uint32_t ui32Data)
+{
+    uint32_t bits = 32, i;
+
+    if (ccm.ctrl & CRC_CFG_SIZE_8BIT)
+    {
+        bits = 8;
+        ui32Data <<= 24;
+    }
+    else
+    {
+        if (ccm.ctrl & CRC_CFG_ENDIAN_SBHW)
+            ui32Data = ((ui32Data & 0x00FF00FF) << 8) | ((ui32Data >> 8) & 0x00FF00FF);
+        if (ccm.ctrl & CRC_CFG_ENDIAN_SHW)
+            ui32Data = (ui32Data << 16) | (ui32Data >> 16);
+    }
+    if (ccm.ctrl & CRC_CFG_IBR)
+        for (i = 0; i < 4; i++)
+            ui32Data = (ui32Data & ~(0xFFu << 8 * i)) | Reverse(ui32Data >> 8 * i & 0xFF, 8) << 8 * i;
+
+    for (i = 0; i < bits; i++)
+    {
+        bool feedback = ((ccm.state ^ ui32Data) >> 31) & 1;
+        ccm.state = feedback ? (ccm.state << 1) ^ 0x04C11DB7 : ccm.state << 1;
+        ui32Data <<= 1;
+    }
+    ccm.writes++;
+}
+
+uint32_t CRCResultRead(uint32_t ui32Base, bool bPPResult)
+{
+    uint32_t result = ccm.state;
+
+    if (bPPResult && (ccm.ctrl & CRC_CFG_OBR))
+        result = Reverse(result, 32);
+    if (bPPResult && (ccm.ctrl & CRC_CFG_RESINV))
+        result = ~result;
+    return result;
+}
+
+uint32_t CRCDataProcess(uint32_t ui32Base, uint32_t *pui32DataIn, uint32_t ui32DataLength, bool bPPResult)
+{
+    uint8_t *pui8DataIn = (uint8_t *) pui32DataIn;
+
+    while (ui32DataLength--)
+        CRCDataWrite(ui32Base, ccm.ctrl & CRC_CFG_SIZE_8BIT ? *pui8DataIn++ : *pui32DataIn++);
+    return CRCResultRead(ui32Base, bPPResult);
+}
+
+/*
+ * Check values, and the model on the standard CRC-32
+ */
+static void CheckValues(void)
+{
+    static const uint8_t check[] = "123456789";
+    uint32_t crc;
+
+    CHECK((Crc32(0xFFFFFFFF, check, 9) ^ 0xFFFFFFFF) == 0xCBF43926, "Crc32() check value");
+    CHECK(Crc16(0, check, 9) == 0xBB3D, "Crc16() check value");
+    CHECK(Crc8CCITT(0, check, 9) == 0xF4, "Crc8CCITT() check value");
+
+    CRCConfigSet(CCM0_BASE, CRC_CFG_INIT_1 | CRC_CFG_TYPE_P4C11DB7 | CRC_CFG_SIZE_8BIT | CRC_CFG_IBR | CRC_CFG_OBR |
+                 CRC_CFG_RESINV);
+    crc = CRCDataProcess(CCM0_BASE, (uint32_t *) check, 9, true);
+    CHECK(crc == 0xCBF43926, "the model of the CRC module gives %08X for the check value", crc);
+}
+
+/*
+ * Every CRC on random slices of a random buffer, in two running pieces
+ */
+static void Conformance(void)
+{
+    static uint32_t words[TEST_BUFFER / 4 + 1];
+    static uint8_t even[TEST_BUFFER / 2], odd[TEST_BUFFER / 2];
+    uint8_t *buffer = (uint8_t *) words;
+    uint32_t seed = 0x2545F491, hardware_writes, n, i;
+    uint32_t crc32_errors = 0, slice4_errors = 0, slice8_errors = 0, accel_errors = 0, crc16_errors = 0;
+    uint32_t crc8_errors = 0, array_errors = 0;
+
+    for (i = 0; i < TEST_BUFFER; i++)
+        buffer[i] = (uint8_t) BenchRandom(&seed);
+
+    hardware_writes = ccm.writes;
+    for (n = 0; n < TEST_CASES; n++)
+    {
+        uint32_t r = BenchRandom(&seed), offset = r % 8, length, split, crc32, expected32, start32;
+        uint16_t expected16;
+        uint8_t expected8;
+        const uint8_t *data = buffer + offset;
+
+        // Mostly short buffers, like records and packets, some up to the whole buffer
+        length = (r >> 8) % 4 == 0 ? BenchRandom(&seed) % (TEST_BUFFER - offset) : BenchRandom(&seed) % 64;
+        split = length ? BenchRandom(&seed) % (length + 1) : 0;
+        start32 = n % 2 ? 0xFFFFFFFF : BenchRandom(&seed);
+
+        expected32 = RefCrc32(start32, data, length);
+        crc32_errors += Crc32(Crc32(start32, data, split), data + split, length - split) != expected32;
+        crc32 = Crc32Slice4(Crc32Slice4(start32, data, split), data + split, length - split);
+        slice4_errors += crc32 != expected32;
+        crc32 = Crc32Slice8(Crc32Slice8(start32, data, split), data + split, length - split);
+        slice8_errors += crc32 != expected32;
+        crc32 = Crc32Accel(Crc32Accel(start32, data, split), data + split, length - split);
+        accel_errors += crc32 != expected32;
+
+        expected16 = RefCrc16((uint16_t) start32, data, length);
+        crc16_errors += Crc16(Crc16((uint16_t) start32, data, split), data + split, length - split) != expected16;
+
+        expected8 = RefCrc8((uint8_t) start32, data, length);
+        crc8_errors += Crc8CCITT(Crc8CCITT((uint8_t) start32, data, split), data + split, length - split) !=
+                       expected8;
+
+        // The word arrays start at a word
+        if (n % 16 == 0)
+        {
+            uint32_t word_length = length / 4, base = offset / 4;
+            uint16_t crc3[3];
+
+            for (i = 0; i < 2 * word_length; i++)
+            {
+                even[i] = buffer[4 * base + 2 * i];
+                odd[i] = buffer[4 * base + 2 * i + 1];
+            }
+            Crc16Array3(word_length, words + base, crc3);
+            array_errors += Crc16Array(word_length, words + base) != RefCrc16(0, buffer + 4 * base, 4 * word_length);
+            array_errors += crc3[0] != RefCrc16(0, buffer + 4 * base, 4 * word_length);
+            array_errors += crc3[1] != RefCrc16(0, even, 2 * word_length);
+            array_errors += crc3[2] != RefCrc16(0, odd, 2 * word_length);
+        }
+    }
+    hardware_writes = ccm.writes - hardware_writes;
+
+    CHECK(crc32_errors == 0, "Crc32() wrong %u times", crc32_errors);
+    CHECK(slice4_errors == 0, "Crc32Slice4() wrong %u times", slice4_errors);
+    CHECK(slice8_errors == 0, "Crc32Slice8() wrong %u times", slice8_errors);
+    CHECK(accel_errors == 0, "Crc32Accel() wrong %u times", accel_errors);
+    CHECK(crc16_errors == 0, "Crc16() wrong %u times", crc16_errors);
+    CHECK(crc8_errors == 0, "Crc8CCITT() wrong %u times", crc8_errors);
+    CHECK(array_errors == 0, "Crc16Array() or Crc16Array3() wrong %u times", array_errors);
+    CHECK(hardware_writes > 0, "Crc32Accel() did not use the CRC module");
+
+    printf("  conformance: %u cases of every CRC against the references, %u words through the CRC module model, "
+           "%d failures\n", TEST_CASES, hardware_writes, failures);
+}
+
+/*
+ * Throughput
+ */
+typedef uint32_t (*Crc32Function)(uint32_t, const uint8_t *, uint32_t);
+typedef uint16_t (*Crc16Function)(uint16_t, const uint8_t *, uint32_t);
+
+static volatile uint32_t sink;
+
+// Byte-at-a-time CRC-16, the way Crc16() was before its word steps
+static uint16_t Crc16ByteTable[256];
+
+static uint16_t ByteCrc16(uint16_t crc, const uint8_t *data, uint32_t count)
+{
+    while (count--)
+        crc = (crc >> 8) ^ Crc16ByteTable[(uint8_t) (crc ^ *data++)];
+    return crc;
+}
+
+// Bytes per cycle of a CRC over chunks of the given size
+static double BytesPerCycle(Crc32Function crc32, Crc16Function crc16, const uint8_t *data, uint32_t chunk)
+{
+    uint32_t crc = 0xFFFFFFFF, span = BENCH_BUFFER / chunk * chunk, done;
+    uint64_t start = __rdtsc();
+
+    for (done = 0; done < BENCH_BYTES; done += chunk)
+        crc = crc32 ? crc32(crc, data + done % span, chunk) : crc16((uint16_t) crc, data + done % span, chunk);
+    sink = crc;
+    return (double) BENCH_BYTES / (__rdtsc() - start);
+}
+
+int main(void)
+{
+    static uint32_t words[BENCH_BUFFER / 4];
+    static const struct
+    {
+        const char *name;
+        Crc32Function crc32;
+        Crc16Function crc16;
+    } engines[] =
+    {
+        {"Crc32()      ", Crc32, NULL},
+        {"Crc32Slice4()", Crc32Slice4, NULL},
+        {"Crc32Slice8()", Crc32Slice8, NULL},
+        {"CRC-16 bytes ", NULL, ByteCrc16},
+        {"Crc16()      ", NULL, Crc16},
+    };
+    uint32_t seed = 0x9E3779B9, i;
+
+    printf("Software CRCs:\n");
+    CheckValues();
+    Conformance();
+
+    for (i = 0; i < 256; i++)
+        Crc16ByteTable[i] = RefCrc16(0, (const uint8_t *) &i, 1);
+    for (i = 0; i < BENCH_BUFFER / 4; i++)
+        words[i] = BenchRandom(&seed);
+
+    for (i = 0; i < sizeof(engines) / sizeof(engines[0]); i++)
+    {
+        double buffer = BytesPerCycle(engines[i].crc32, engines[i].crc16, (const uint8_t *) words, BENCH_BUFFER);
+        double record = BytesPerCycle(engines[i].crc32, engines[i].crc16, (const uint8_t *) words, RECORD_BYTES);
+
+        printf("  %s %5.2f bytes per cycle over 16 KB, %5.2f over %u-byte records\n", engines[i].name, buffer, record,
+               RECORD_BYTES);
+    }
+
+    return failures ? 1 : 0;
+}
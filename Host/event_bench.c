@@ -0,0 +1,292 @@
+/*
+ * event_bench.c: host-side check and benchmark of the event scheduler
+ *
+ * ----------------------------
+ *  Created on: Dec 10, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Runs Util/event.c against a stub event timer whose time the benchmark sets. With 10, 100 and
+ * 1000 pending events, spread over the next second, it times scheduling, moving a scheduled
+ * event, cancelling and expiring, and checks that the events run in time order and that the
+ * cancelled ones do not run at all. It also times EventPost() from a stub ISR, and the taking in
+ * of the posted events by EventExecute(), and checks the dispatch order of the priority classes.
+ *
+ * The Makefile builds it twice: event_bench_wheel with the timing wheel and event_bench_heap with
+ * the bins and heap (EVENT_WHEEL=0). Both are run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "launchpad.h"
+#include "bench.h"
+
+#define MAX_EVENTS      1000
+#define OPERATIONS      200000      // timed operations per measurement
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Stub event timer: the benchmark sets the time; the rest does nothing
+ */
+static time_t bench_now = 0;
+
+uint32_t SysCtlClockGet(void) { return EVENT_TICK_RATE; }
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral) {}
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config) {}
+void TimerLoadSet64(uint32_t ui32Base, uint64_t ui64Value) {}
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer, void (*pfnHandler)(void)) {}
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer) {}
+void TimerMatchSet64(uint32_t ui32Base, uint64_t ui64Value) {}
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void IntPendSet(uint32_t ui32Interrupt) {}
+uint32_t CPUcpsid(void) { return 0; }
+uint32_t CPUcpsie(void) { return 0; }
+void CPUwfi(void) {}
+uint64_t TimerValueGet64(uint32_t ui32Base) { return bench_now; }
+void SysCtlPeripheralSleepEnable(uint32_t ui32Peripheral) {}
+
+// Stub profiling: no CPU time and no output
+void CPUUsageInit(uint32_t ui32ClockRate, uint32_t ui32Rate, uint32_t ui32Timer) {}
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer) { return 0; }
+int uprintf(char *fmt, ...) { return 0; }
+
+/*
+ * Stub NVIC: HWREG() reads the number of the running "ISR" (0 in thread context), and all
+ * interrupts have one priority
+ */
+static uint32_t bench_active = 0;
+
+volatile uint32_t *SimRegister(uint32_t addr)
+{
+    static volatile uint32_t value;
+    value = bench_active;
+    return &value;
+}
+
+int32_t IntPriorityGet(uint32_t ui32Interrupt) { return 0x20; }
+
+/*
+ * Events
+ */
+static Event events[MAX_EVENTS];
+static uint32_t seed = 0x2545F491;
+
+// Dispatch record of the last expiry run
+static int dispatched;
+static time_t last_dispatch;
+static bool dispatch_in_order;
+static Event *first_dispatches[3];
+
+static void Dispatch(Event *ev)
+{
+    if (dispatched < 3)
+        first_dispatches[dispatched] = ev;
+    if (ev->time < last_dispatch || ev->time > bench_now)
+        dispatch_in_order = false;
+    last_dispatch = ev->time;
+    dispatched++;
+}
+
+// A random time in the next second
+static time_t RandomTime()
+{
+    return bench_now + 1 + BenchRandom(&seed) % EVENT_TICK_RATE;
+}
+
+// Expire every pending event; return the number of dispatches
+static int ExpireAll()
+{
+    dispatched = 0;
+    last_dispatch = 0;
+    dispatch_in_order = true;
+    bench_now += 2 * EVENT_TICK_RATE;
+    EventExecute();
+    return dispatched;
+}
+
+/*
+ * Time the operations with n pending events, in nanoseconds per operation
+ */
+static void Measure(int n)
+{
+    double start, schedule_ns, move_ns, cancel_ns, expire_ns;
+    int i, op, rounds = OPERATIONS / n, pending;
+
+    // Scheduling n events, and expiring them all
+    schedule_ns = expire_ns = 0;
+    for (op = 0; op < rounds; op++)
+    {
+        start = BenchSeconds();
+        for (i = 0; i < n; i++)
+            EventSchedule(&events[i], RandomTime());
+        schedule_ns += BenchSeconds() - start;
+
+        start = BenchSeconds();
+        pending = ExpireAll();
+        expire_ns += BenchSeconds() - start;
+
+        CHECK(pending == n && dispatch_in_order, "%d of %d events ran, %s", pending, n,
+              dispatch_in_order ? "in order" : "out of order");
+    }
+    schedule_ns *= 1e9 / (rounds * n);
+    expire_ns *= 1e9 / (rounds * n);
+
+    // Moving scheduled events to new times
+    for (i = 0; i < n; i++)
+        EventSchedule(&events[i], RandomTime());
+    start = BenchSeconds();
+    for (op = 0; op < OPERATIONS; op++)
+        EventSchedule(&events[BenchRandom(&seed) % n], RandomTime());
+    move_ns = (BenchSeconds() - start) * 1e9 / OPERATIONS;
+
+    // Cancelling n scheduled events, from an empty queue; none of them runs
+    cancel_ns = 0;
+    ExpireAll();
+    for (op = 0; op < rounds; op++)
+    {
+        for (i = 0; i < n; i++)
+            EventSchedule(&events[i], RandomTime());
+
+        start = BenchSeconds();
+        for (i = 0; i < n; i++)
+            EventDeschedule(&events[i]);
+        cancel_ns += BenchSeconds() - start;
+
+        pending = ExpireAll();
+        CHECK(pending == 0, "%d of %d cancelled events ran", pending, n);
+    }
+    cancel_ns *= 1e9 / (rounds * n);
+
+    // Cancelling half of them leaves the others in order
+    for (i = 0; i < n; i++)
+        EventSchedule(&events[i], RandomTime());
+    for (i = 0; i < n; i += 2)
+        EventDeschedule(&events[i]);
+    pending = ExpireAll();
+    CHECK(pending == n / 2 && dispatch_in_order, "%d of %d events ran after cancelling half", pending,
+          n / 2);
+
+    printf("  %4d events: schedule %6.1f ns, move %6.1f ns, cancel %6.1f ns, expire %6.1f ns\n", n,
+           schedule_ns, move_ns, cancel_ns, expire_ns);
+}
+
+/*
+ * Time EventPost() from an ISR, and EventExecute() taking the posts in, per post
+ */
+static void MeasurePost()
+{
+    double start, post_ns = 0, take_ns = 0;
+    int i, op, rounds = OPERATIONS / 8;
+
+    for (op = 0; op < rounds; op++)
+    {
+        start = BenchSeconds();
+        bench_active = INT_GPIOF;
+        for (i = 0; i < 8; i++)
+            EventPost(&events[i], RandomTime());
+        bench_active = 0;
+        post_ns += BenchSeconds() - start;
+
+        start = BenchSeconds();
+        EventExecute();
+        take_ns += BenchSeconds() - start;
+    }
+    ExpireAll();
+
+    printf("  ISR posts: post %6.1f ns, taking in %6.1f ns\n", post_ns * 1e9 / (rounds * 8),
+           take_ns * 1e9 / (rounds * 8));
+}
+
+int main(void)
+{
+    int i;
+
+    EventSchedulerInit();
+    for (i = 0; i < MAX_EVENTS; i++)
+        EventInit(&events[i], Dispatch);
+
+    // Events scheduled together for one time run in the order they were scheduled
+    bench_now = EVENT_TICK_RATE;
+    for (i = 0; i < 3; i++)
+        EventSchedule(&events[i], bench_now + 100);
+    CHECK(ExpireAll() == 3 && first_dispatches[0] == &events[0] && first_dispatches[1] == &events[1] &&
+              first_dispatches[2] == &events[2], "events of the same time did not run in order");
+
+    // Posts from an ISR are scheduled by the next EventExecute(); the posts to a full queue are
+    // dropped and counted
+    bench_active = INT_GPIOF;
+    for (i = 0; i < 20; i++)
+        EventPost(&events[i], bench_now + 100 + i);
+    bench_active = 0;
+    CHECK(ExpireAll() + EventPostDroppedCount() == 20 && EventPostDroppedCount() > 0 &&
+              dispatch_in_order && first_dispatches[0] == &events[0],
+          "posted events did not run in order, or the drops were not counted");
+
+    // A periodic event of 10 1/3 ticks runs floor(n * 31 / 3) ticks after its anchor. Behind
+    // time, BURST runs every occurrence past, and SKIP the first one only.
+    static EventPeriod period;
+    time_t anchor = bench_now + 100;
+    EventSetPeriod(&events[0], &period, 10, 1, 3, EVENT_OVERRUN_BURST);
+    EventSchedulePeriodic(&events[0], anchor);
+    bench_now = anchor + 62;
+    dispatched = 0;
+    EventExecute();
+    CHECK(dispatched == 7 && period.time == anchor + 62 && events[0].time == anchor + 72,
+          "%d periodic runs up to %llu ticks after the anchor", dispatched,
+          (unsigned long long) (period.time - anchor));
+    EventSetPeriod(&events[0], &period, 10, 1, 3, EVENT_OVERRUN_SKIP);
+    bench_now = anchor + 200;
+    dispatched = 0;
+    EventExecute();
+    CHECK(dispatched == 1 && period.skipped == 12 && events[0].time == anchor + 206,
+          "%d periodic runs and %u skipped behind time", dispatched, period.skipped);
+    EventDeschedule(&events[0]);
+    CHECK(ExpireAll() == 0, "a stopped periodic event ran");
+
+    // Of the events ready together, a higher class runs first, and within a class the earliest
+    // deadline; the profile counts each dispatch
+    static EventProfile profile;
+    EventSetPriority(&events[0], EVENT_PRIORITY_LOW, 0);
+    EventSetPriority(&events[1], EVENT_PRIORITY_HIGH, 1000);
+    EventSetPriority(&events[2], EVENT_PRIORITY_HIGH, 100);
+    EventSetProfile(&events[2], &profile, "bench");
+    for (i = 0; i < 3; i++)
+        EventSchedule(&events[i], bench_now + 100 + i);
+    CHECK(ExpireAll() == 3 && first_dispatches[0] == &events[2] && first_dispatches[1] == &events[1] &&
+              first_dispatches[2] == &events[0], "events did not run by priority and deadline");
+#if EVENT_PROFILE
+    CHECK(profile.runs == 1 && profile.lateness.max == 2 * EVENT_TICK_RATE - 102 && profile.missed == 1 &&
+              profile.lateness.count[EVENT_HISTOGRAM_BINS - 1] == 1, "the dispatch was not profiled");
+#endif
+    for (i = 0; i < 3; i++)
+        EventSetPriority(&events[i], EVENT_PRIORITY_NORMAL, 0);
+    EventSetProfile(&events[2], NULL, NULL);
+
+    printf("%s\n", EVENT_WHEEL ? "Timing wheel:" : "Bins and heap:");
+    Measure(10);
+    Measure(100);
+    Measure(1000);
+    MeasurePost();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,938 @@
+/*
+ * metronome_sim.c: Simulation scenarios for the metronome firmware
+ *
+ * ----------------------------
+ *  Created on: Dec 4, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Each scenario boots the firmware on the simulator (sim/sim.h), applies button presses and knob
+ * turns at given virtual times, and checks the recorded BuzzerSet() calls and display frames.
+ * Scenarios run in their own process, so every one of them starts from a fresh power-up.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <inc/hw_ints.h>
+#include <driverlib/cpu.h>
+#include "sim.h"
+
+// The Makefile renames the firmware's main() to MetronomeMain(); this file has the real main()
+#undef main
+void MetronomeMain(void);
+
+// Firmware functions read by the scenarios
+uint32_t EventGetWakeupCount(void);
+uint32_t PushButtonDroppedCount(void);
+uint32_t EventPostDroppedCount(void);
+uint32_t Seg7RawCyclesPerUpdate(void);
+bool uDMAChannelIsEnabled(uint32_t ui32ChannelNum);
+uint32_t BeatTimerOnsetCount(void);
+uint32_t BeatTimerJitterMax(void);
+uint32_t SettingsWriteCount(void);
+uint32_t SettingsInitReads(void);
+
+// Settings of the firmware (Program/metronome.h)
+extern uint32_t pitch_index, BPM;
+
+// Number of beat patterns in the menu (Program/pattern_table.c)
+extern const uint32_t PATTERN_COUNT;
+
+// Menu positions of two of the patterns in Program/patterns.txt
+#define PATTERN_7_8         6       // 2+2+3
+#define PATTERN_3_2         8       // three against two
+
+// Profiles of the beat and push button events; the layout of EventProfile in Util/event.h
+typedef struct
+{
+    uint32_t count[24];
+    uint32_t min, max;
+    uint64_t sum;
+} EventStats;
+
+typedef struct
+{
+    const char *name;
+    uint32_t runs;
+    uint32_t missed;
+    EventStats lateness;
+    EventStats duration;
+    void *next;
+} EventProfile;
+
+extern EventProfile beat_profile, button_profile;
+
+// Firmware functions run by the UART scenario (see launchpad.h)
+typedef enum
+{
+    UART_TX_DROP,
+    UART_TX_BLOCK,
+} UartTxPolicy;
+
+void LaunchPadInit(void);
+void UartSetTxPolicy(UartTxPolicy policy);
+int uprintf(char *fmt, ...);
+uint32_t UartTxDroppedCount(void);
+uint32_t UartTxHighWater(void);
+uint32_t TraceDroppedCount(void);
+
+// Trace format IDs, as the firmware numbers them
+typedef enum
+{
+#define TRACE_FORMAT(id, format) id,
+#include "trace_formats.h"
+#undef TRACE_FORMAT
+} TraceId;
+
+#ifndef EVENT_TICKLESS
+#define EVENT_TICKLESS 1
+#endif
+
+#ifndef SEG7_ASYNC
+#define SEG7_ASYNC 1
+#endif
+
+#ifndef RAS_UDMA
+#define RAS_UDMA 1
+#endif
+
+#ifndef UART_TX_UDMA
+#define UART_TX_UDMA 0
+#endif
+
+#ifndef BUZZER_CLICKS
+#define BUZZER_CLICKS 1
+#endif
+
+#ifndef BEAT_TIMER
+#define BEAT_TIMER 0
+#endif
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+// Beat timing tolerance: the SysTick time base dispatches events on 1 ms boundaries only
+#if EVENT_TICKLESS
+#define BEAT_TOLERANCE  0
+#else
+#define BEAT_TOLERANCE  SIM_MS(1)
+#endif
+
+// Onset tolerance: the beat timer starts the clicks itself, off the event time base
+#if BEAT_TIMER
+#define ONSET_TOLERANCE 0
+#else
+#define ONSET_TOLERANCE BEAT_TOLERANCE
+#endif
+
+// ADC readings of the rotary angle sensor for a few tempos (BPM = 150 - reading * 100 / 4095),
+// in the middle of the readings that the tempo table maps to them
+#define KNOB_120_BPM    1216
+#define KNOB_60_BPM     3672
+
+// A reading 4 counts from the 120/119 BPM boundary of the tempo table
+#define KNOB_NEAR_119   1228
+
+// 7-segment codes of the menu, with the colon on
+#define SEG7_COLON      0x80
+#define SEG7_DIGIT_1    0x06
+#define SEG7_DIGIT_3    0x4F
+#define SEG7_DIGIT_4    0x66
+#define SEG7_DIGIT_7    0x07
+#define SEG7_DIGIT_8    0x7F
+
+// Button press duration, and the time a press takes to register: the debounce delay, then the
+// chord window (see launchpad.h)
+#define PRESS           SIM_MS(80)
+#define PRESS_REGISTERS SIM_MS(20 + 50)
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("    FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Trace helpers
+ */
+
+// The last trace record of the given type at or before the given time, NULL if none
+static const SimTrace *LastRecord(SimTraceType type, uint64_t time)
+{
+    const SimTrace *frame = NULL;
+    int i;
+
+    for (i = 0; i < SimTraceCount(); i++)
+    {
+        const SimTrace *record = SimTraceGet(i);
+        if (record->time > time)
+            break;
+        if (record->type == type)
+            frame = record;
+    }
+
+    return frame;
+}
+
+// The last frame the display received at or before the given time
+static const SimTrace *LastDisplayFrame(uint64_t time)
+{
+    return LastRecord(SIM_TRACE_DISPLAY, time);
+}
+
+// Whether the display shows the given time signature menu option (digit[2]:digit[1])
+static bool ShowsMenu(const SimTrace *frame, int upper_code, int lower_code)
+{
+    return frame != NULL && frame->arg[2] == (upper_code | SEG7_COLON) &&
+           frame->arg[1] == (lower_code | SEG7_COLON);
+}
+
+// Collect the beat onsets (BuzzerSet calls with a non-zero volume, or clicks, whose arg[1] is
+// their peak volume) in [from, to)
+static int BeatOnsets(uint64_t from, uint64_t to, const SimTrace *onsets[], int max)
+{
+    int i, n = 0;
+
+    for (i = 0; i < SimTraceCount() && n < max; i++)
+    {
+        const SimTrace *record = SimTraceGet(i);
+        if ((record->type == SIM_TRACE_BUZZER || record->type == SIM_TRACE_CLICK) && record->arg[1] > 0 &&
+            record->time >= from && record->time < to)
+            onsets[n++] = record;
+    }
+
+    return n;
+}
+
+// Check that consecutive onsets are one beat period apart
+static void CheckBeatPeriod(const SimTrace *onsets[], int n, uint64_t period)
+{
+    int i;
+
+    for (i = 1; i < n; i++)
+    {
+        uint64_t interval = onsets[i]->time - onsets[i - 1]->time;
+        uint64_t error = interval > period ? interval - period : period - interval;
+        CHECK(error <= ONSET_TOLERANCE, "beat %d came %llu cycles after beat %d, expected %llu", i,
+              (unsigned long long) interval, i - 1, (unsigned long long) period);
+    }
+}
+
+/*
+ * Scenarios
+ */
+
+static void BootShowsMenu()
+{
+    SimRun(MetronomeMain, SIM_MS(100));
+
+    CHECK(ShowsMenu(LastDisplayFrame(SimNow()), SEG7_DIGIT_4, SEG7_DIGIT_4), "menu does not show 4:4");
+    CHECK(strstr(SimUartOutput(), "Metronome") != NULL, "no greeting on UART0");
+}
+
+static void MenuRotates()
+{
+    int i;
+
+    // SW1 once per pattern, 500 ms apart
+    for (i = 0; i < (int) PATTERN_COUNT; i++)
+        SimPressButton(SIM_MS(500 + 500 * i), 1, PRESS);
+    SimRun(MetronomeMain, SIM_MS(700 + 500 * PATTERN_COUNT));
+
+    CHECK(ShowsMenu(LastDisplayFrame(SIM_MS(900)), SEG7_DIGIT_3, SEG7_DIGIT_4), "first SW1 does not show 3:4");
+    CHECK(ShowsMenu(LastDisplayFrame(SimNow()), SEG7_DIGIT_4, SEG7_DIGIT_4), "SW1 %u times does not wrap to 4:4",
+          PATTERN_COUNT);
+    CHECK(EventPostDroppedCount() == 0, "%u button posts dropped", EventPostDroppedCount());
+}
+
+// Taps of bouncing contacts at 300 a minute, shorter than the chord window, all register
+static void FastTapsRegister()
+{
+    int i;
+
+    SimSetButtonBounce(SIM_MS(5));
+    for (i = 0; i < 19; i++)
+        SimPressButton(SIM_MS(500 + 200 * i), 1, SIM_MS(45));
+    SimRun(MetronomeMain, SIM_MS(500 + 200 * 19 + 200));
+
+    CHECK(ShowsMenu(LastDisplayFrame(SimNow()), SEG7_DIGIT_3, SEG7_DIGIT_4), "19 taps of SW1 do not show 3:4");
+    CHECK(PushButtonDroppedCount() == 0, "%u button inputs dropped", PushButtonDroppedCount());
+}
+
+// Holding SW1 rotates the menu on: a press, a long press at 600 ms, then a repeat every 150 ms
+// until the release at 1400 ms. SW1 and SW2 pressed together make a chord, which neither
+// rotates nor selects.
+static void HoldRepeatsChordIgnored()
+{
+    const SimTrace *onsets[4];
+
+    SimSetButtonBounce(SIM_MS(5));
+    SimPressButton(SIM_MS(500), 1, SIM_MS(1400));
+    SimPressButton(SIM_MS(3000), 1, PRESS);
+    SimPressButton(SIM_MS(3010), 2, PRESS);
+    SimRun(MetronomeMain, SIM_MS(3500));
+
+    CHECK(ShowsMenu(LastDisplayFrame(SIM_MS(2500)), SEG7_DIGIT_7, SEG7_DIGIT_8), "holding SW1 does not reach 7:8");
+    CHECK(ShowsMenu(LastDisplayFrame(SimNow()), SEG7_DIGIT_7, SEG7_DIGIT_8), "the chord changed the menu");
+    CHECK(BeatOnsets(0, SimNow(), onsets, 4) == 0, "the chord started the metronome");
+}
+
+static void BeatsAt120Bpm()
+{
+    const SimTrace *onsets[64];
+    int i, n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimRun(MetronomeMain, SIM_MS(10500));
+
+    // 20 beats in 10 seconds, half a second apart, with the accent on every fourth beat
+    n = BeatOnsets(SIM_MS(500), SimNow(), onsets, 64);
+    CHECK(n == 20, "%d beats in 10 s at 120 BPM, expected 20", n);
+    CheckBeatPeriod(onsets, n, SIM_MS(500));
+    for (i = 0; i < n; i++)
+        CHECK((onsets[i]->arg[1] == 27) == (i % 4 == 0), "beat %d has volume %d", i, onsets[i]->arg[1]);
+}
+
+// Select the pattern at a menu position, 500 ms after the last SW1
+static uint64_t SelectPattern(int position)
+{
+    int i;
+
+    for (i = 0; i < position; i++)
+        SimPressButton(SIM_MS(500 + 500 * i), 1, PRESS);
+    SimPressButton(SIM_MS(500 + 500 * position), 2, PRESS);
+    return SIM_MS(500 + 500 * position);
+}
+
+// 7/8 grouped 2+2+3: the bar starts on an accent, and the other groups on a medium accent
+static void PatternGroupsAccents()
+{
+    static const int volume[7] = {27, 25, 26, 25, 26, 25, 25};
+    const SimTrace *onsets[64];
+    uint64_t start;
+    int i, n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    start = SelectPattern(PATTERN_7_8);
+    SimRun(MetronomeMain, start + SIM_MS(7000));
+
+    n = BeatOnsets(start, SimNow(), onsets, 64);
+    CHECK(n == 14, "%d beats in two bars of 7/8, expected 14", n);
+    CheckBeatPeriod(onsets, n, SIM_MS(500));
+    for (i = 0; i < n; i++)
+        CHECK(onsets[i]->arg[1] == volume[i % 7], "beat %d has volume %d, expected %d", i, onsets[i]->arg[1],
+              volume[i % 7]);
+}
+
+// Three against two: over a bar of two beats, the main voice plays on 0 and 1/2, the second on
+// 1/3 and 2/3; where both fall together, the main voice plays
+static void PolyrhythmInterleaves()
+{
+    static const uint64_t offset[4] = {0, SIM_MS(1000) / 3, SIM_MS(500), SIM_MS(2000) / 3};
+    const SimTrace *onsets[64];
+    uint64_t start;
+    int i, n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    start = SelectPattern(PATTERN_3_2);
+    SimRun(MetronomeMain, start + SIM_MS(3000) - 1);
+
+    n = BeatOnsets(start, SimNow(), onsets, 64);
+    CHECK(n == 12, "%d clicks in three bars of three against two, expected 12", n);
+    for (i = 0; i < n; i++)
+    {
+        uint64_t ideal = onsets[0]->time + SIM_MS(1000) * (i / 4) + offset[i % 4];
+        uint64_t error = onsets[i]->time > ideal ? onsets[i]->time - ideal : ideal - onsets[i]->time;
+        CHECK(error <= ONSET_TOLERANCE + 1, "click %d came %lld cycles off", i,
+              (long long) (onsets[i]->time - ideal));
+    }
+}
+
+// The pattern, pitch and tempo survive a power cycle. The changes come less than the write delay
+// apart, so the EEPROM is written once, after the knob has settled.
+static void SettingsSurvivePowerCycle()
+{
+    uint32_t image[SIM_EEPROM_WORDS];
+    int fds[2], status, i;
+    ssize_t length = 0;
+    pid_t pid;
+
+    if (pipe(fds) != 0)
+        return;
+    pid = fork();
+    if (pid == 0)
+    {
+        uint64_t start;
+
+        SimSetKnob(0, KNOB_120_BPM);
+        start = SelectPattern(PATTERN_7_8);
+        SimPressButton(start + SIM_MS(1000), 1, PRESS);
+        // One sweep down to 60 BPM and back up to 120, so every beat finds a new tempo
+        for (i = 0; i < 8; i++)
+            SimSetKnob(start + SIM_MS(2000 + 500 * i),
+                       KNOB_120_BPM + (KNOB_60_BPM - KNOB_120_BPM) * (i < 4 ? i + 1 : 7 - i) / 4);
+        SimRun(MetronomeMain, start + SIM_MS(12000));
+
+        CHECK(SettingsWriteCount() == 1, "%u settings records written", SettingsWriteCount());
+        CHECK(SimEepromWrites() == 4 * SettingsWriteCount(), "%u EEPROM words written", SimEepromWrites());
+        printf("    %u EEPROM words written for a selection, a pitch change and 8 knob turns\n",
+               SimEepromWrites());
+        fflush(stdout);
+        if (write(fds[1], SimEepromImage(), sizeof(image)) != sizeof(image))
+            failures++;
+        _exit(failures ? 1 : 0);
+    }
+
+    close(fds[1]);
+    while (length < (ssize_t) sizeof(image))
+    {
+        ssize_t n = read(fds[0], (char *) image + length, sizeof(image) - length);
+        if (n <= 0)
+            break;
+        length += n;
+    }
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0 && length == sizeof(image), "the first power-up failed");
+
+    SimEepromLoad(image);
+    SimRun(MetronomeMain, SIM_MS(100));
+
+    CHECK(ShowsMenu(LastDisplayFrame(SimNow()), SEG7_DIGIT_7, SEG7_DIGIT_8), "the menu does not start on 7:8");
+    CHECK(pitch_index == 2 && BPM == 120, "pitch %u and %u BPM restored", pitch_index, BPM);
+    CHECK(SettingsInitReads() <= 12, "%u EEPROM words read to restore the settings", SettingsInitReads());
+    printf("    restored with %u EEPROM word reads\n", SettingsInitReads());
+}
+
+// With a noisy knob near a BPM boundary, the filter and hysteresis keep the tempo steady
+static void NoisyKnobKeepsTempo()
+{
+    const SimTrace *onsets[64];
+    int n;
+
+    SimSetKnobNoise(40);
+    SimSetKnob(0, KNOB_NEAR_119);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimRun(MetronomeMain, SIM_MS(20500));
+
+    // Whichever of 120 and 119 BPM the first reading gave, every beat keeps it
+    n = BeatOnsets(SIM_MS(500), SimNow(), onsets, 64);
+    CHECK(n >= 39, "%d beats in 20 s", n);
+    if (n >= 2)
+        CheckBeatPeriod(onsets, n, onsets[1]->time - onsets[0]->time);
+}
+
+static void TempoFollowsKnob()
+{
+    const SimTrace *onsets[64];
+    int n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimSetKnob(SIM_MS(5000), KNOB_60_BPM);
+    SimRun(MetronomeMain, SIM_MS(20000));
+
+    // The new reading is picked up within two beats, after which beats are one second apart
+    n = BeatOnsets(SIM_MS(7000), SimNow(), onsets, 64);
+    CHECK(n >= 12, "%d beats after the tempo change", n);
+    CheckBeatPeriod(onsets, n, SIM_MS(1000));
+}
+
+static void StopReturnsToMenu()
+{
+    const SimTrace *onsets[64];
+    const SimTrace *last = NULL;
+    int i;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimPressButton(SIM_MS(3250), 2, PRESS); // between two beats
+    SimRun(MetronomeMain, SIM_MS(6000));
+
+    for (i = 0; i < SimTraceCount(); i++)
+        if (SimTraceGet(i)->type == SIM_TRACE_BUZZER)
+            last = SimTraceGet(i);
+
+    CHECK(BeatOnsets(SIM_MS(3250), SimNow(), onsets, 64) == 0, "beats after stop");
+    CHECK(last != NULL && last->arg[1] == 0, "buzzer left on after stop");
+    CHECK(ShowsMenu(LastDisplayFrame(SimNow()), SEG7_DIGIT_4, SEG7_DIGIT_4), "menu not shown after stop");
+}
+
+// SW1 pressed on the beats changes the pitch; the beats run first and stay on time
+static void BeatsAheadOfButtons()
+{
+    const SimTrace *onsets[64];
+    int i, n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    for (i = 1; i <= 5; i++)
+        SimPressButton(SIM_MS(500 + 1000 * i), 1, PRESS);
+    SimRun(MetronomeMain, SIM_MS(6500));
+
+    n = BeatOnsets(SIM_MS(500), SimNow(), onsets, 64);
+    CHECK(n == 12, "%d beats in 6 s at 120 BPM, expected 12", n);
+    CheckBeatPeriod(onsets, n, SIM_MS(500));
+    CHECK(beat_profile.missed == 0, "%u beats missed their deadline", beat_profile.missed);
+    CHECK(beat_profile.lateness.max <= BEAT_TOLERANCE, "a beat ran %u ticks late", beat_profile.lateness.max);
+    CHECK(button_profile.runs == 12, "%u push button dispatches profiled, one per press and release",
+          button_profile.runs);
+
+    printf("    beats at most %.1f us late, push buttons %.1f us\n", (double) beat_profile.lateness.max / SIM_US(1),
+           (double) button_profile.lateness.max / SIM_US(1));
+}
+
+// A press whose interrupt lands after the scheduler last took in the posts, just before the main
+// loop sleeps, registers on time, rather than at some later interrupt
+static void PressBeforeSleepHandled()
+{
+    const SimTrace *press = NULL, *frame = NULL;
+    int i;
+
+    SimPressButtonBeforeSleep(SIM_MS(500), 1, PRESS);
+    SimRun(MetronomeMain, SIM_MS(1000));
+
+    for (i = 0; i < SimTraceCount() && frame == NULL; i++)
+    {
+        const SimTrace *record = SimTraceGet(i);
+        if (record->type == SIM_TRACE_PRESS_BEFORE_SLEEP)
+            press = record;
+        else if (press != NULL && record->type == SIM_TRACE_DISPLAY &&
+                 ShowsMenu(record, SEG7_DIGIT_3, SEG7_DIGIT_4))
+            frame = record;
+    }
+
+    CHECK(press != NULL, "the press did not land");
+    CHECK(frame != NULL, "SW1 does not show 3:4");
+    if (frame != NULL)
+    {
+        double delay = (double) (frame->time - press->time) / SIM_MS(1);
+
+        CHECK(frame->time <= press->time + PRESS_REGISTERS + SIM_MS(2), "3:4 shows %.1f ms after the press", delay);
+        printf("    3:4 shows %.1f ms after the press, which landed at %.1f ms\n", delay,
+               (double) press->time / SIM_MS(1));
+    }
+}
+
+// The display receives every update that changes it, and shows the last one, while the metronome
+// plays; only the changed digits go over the bus
+static void DisplayFollowsUpdates()
+{
+    const SimTrace *update, *frame, *previous = NULL;
+    int i, changes = 0, frames = 0;
+    double bytes_per_update;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimRun(MetronomeMain, SIM_MS(10500));
+
+    for (i = 0; i < SimTraceCount(); i++)
+    {
+        const SimTrace *record = SimTraceGet(i);
+        if (record->type == SIM_TRACE_SEG7)
+        {
+            changes += previous == NULL || memcmp(record->arg, previous->arg, sizeof(record->arg)) != 0;
+            previous = record;
+        }
+        frames += record->type == SIM_TRACE_DISPLAY;
+    }
+
+    update = LastRecord(SIM_TRACE_SEG7, SimNow());
+    frame = LastDisplayFrame(SimNow());
+    CHECK(frames >= changes, "%d frames on the bus for %d changes", frames, changes);
+    CHECK(update != NULL && frame != NULL && memcmp(update->arg, frame->arg, sizeof(frame->arg)) == 0,
+          "the display does not show the last update");
+    CHECK(frame == NULL || frame->time - update->time < SIM_US(1000), "the last update took %llu us",
+          (unsigned long long) ((frame->time - update->time) / SIM_US(1)));
+
+    // The first beat shows its count with the menu digits and the colon cleared
+    frame = LastDisplayFrame(SIM_MS(501) + PRESS);
+    CHECK(frame != NULL && frame->arg[3] == SEG7_DIGIT_1 && frame->arg[2] == 0 && frame->arg[1] == 0 &&
+              frame->arg[0] == 0, "first beat does not show a lone 1");
+
+    // A beat changes one digit: an address and a data byte, against seven bytes for a full update
+    bytes_per_update = (double) SimDisplayBusBytes() / changes;
+    CHECK(bytes_per_update < 3, "%.1f bus bytes per update", bytes_per_update);
+
+    // The driver counts its busy-waits and the exception entry and exit of its interrupts; the
+    // simulator charges the same to the step timer ISR, but neither sees the instructions of the
+    // handler itself, which the simulation runs in no time
+#if SEG7_ASYNC
+    printf("    %d updates, %.1f bus bytes and %.1f step interrupts per update; %u cycles of interrupt entry,\n"
+           "    exit and waits per update as the driver counts them, %.0f as the simulator charges them\n",
+           changes, bytes_per_update, (double) SimInterruptCount(INT_TIMER1A) / changes, Seg7RawCyclesPerUpdate(),
+           (double) SimInterruptCycles(INT_TIMER1A) / changes);
+#else
+    printf("    %d updates, %.1f bus bytes and %u busy-wait cycles per update\n", changes, bytes_per_update,
+           Seg7RawCyclesPerUpdate());
+#endif
+}
+
+// Find text in the UART output, which may also hold binary trace records
+static const char *UartFind(const char *text)
+{
+    const char *output = SimUartOutput();
+    int i, length = SimUartOutputLength(), n = strlen(text);
+
+    for (i = 0; i + n <= length; i++)
+        if (memcmp(output + i, text, n) == 0)
+            return output + i;
+    return NULL;
+}
+
+#if BUZZER_CLICKS
+// Every beat is a click that the uDMA plays out to silence, with no buzzer interrupt and no
+// buzzer-off event
+static void ClicksNeedNoCpu()
+{
+    const SimTrace *onsets[64];
+    int i, n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimRun(MetronomeMain, SIM_MS(4600));
+
+    n = BeatOnsets(SIM_MS(500), SimNow(), onsets, 64);
+    CHECK(n == 9, "%d clicks in 4 s at 120 BPM, expected 9", n);
+    for (i = 0; i < n; i++)
+    {
+        const SimTrace *click = onsets[i];
+        CHECK(click->type == SIM_TRACE_CLICK && click->arg[3] == -1, "beat %d is not a click ending in silence", i);
+        CHECK(i % 4 == 0 ? click->arg[2] > onsets[1]->arg[2] : click->arg[2] == onsets[1]->arg[2],
+              "click %d lasts %d PWM periods", i, click->arg[2]);
+    }
+    CHECK(!uDMAChannelIsEnabled(11), "the last click is still playing");
+    CHECK(SimInterruptCount(INT_WTIMER0B) == 0, "the buzzer timer interrupted the CPU");
+    CHECK(beat_profile.runs == 9, "%u beat events ran for 9 beats", beat_profile.runs);
+
+    if (n > 0)
+        printf("    clicks of %d and %d PWM periods of %d cycles\n", onsets[0]->arg[2], onsets[n > 1]->arg[2],
+               onsets[0]->arg[0]);
+}
+#endif
+
+#if BEAT_TIMER
+// The beat timer's clicks start on their ideal times to the cycle, through a tempo change and
+// with SW1 keeping the event loop busy, and the capture on WTIMER0A measures every onset
+static void BeatTimerOnsetsOnTime()
+{
+    const SimTrace *onsets[64];
+    int i, n;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    for (i = 1; i <= 4; i++)
+        SimPressButton(SIM_MS(500 + 1000 * i), 1, PRESS);
+    SimSetKnob(SIM_MS(5000), KNOB_60_BPM);
+    SimRun(MetronomeMain, SIM_MS(12600));
+
+    n = BeatOnsets(SIM_MS(500), SimNow(), onsets, 64);
+    CHECK(n >= 16, "%d beats in 12 s", n);
+    CHECK(BeatTimerOnsetCount() == (uint32_t) n, "%u onsets captured for %d beats", BeatTimerOnsetCount(), n);
+    CHECK(BeatTimerJitterMax() == 0, "an onset came %u cycles off its ideal time", BeatTimerJitterMax());
+    CHECK(SimInterruptCount(INT_WTIMER2A) == (uint32_t) n - 1, "%u beat timer interrupts for %d beats",
+          SimInterruptCount(INT_WTIMER2A), n);
+    CHECK(beat_profile.runs == (uint32_t) n, "%u beat events ran for %d beats", beat_profile.runs, n);
+
+    printf("    %u onsets at most %u cycles off their ideal times; beat events up to %.1f us late\n",
+           BeatTimerOnsetCount(), BeatTimerJitterMax(), (double) beat_profile.lateness.max / SIM_US(1));
+}
+#endif
+
+// Report the wakeup rate and CPU cost of a playing metronome
+static void CpuCost()
+{
+    uint64_t busy, idle, isr;
+    double seconds, wakeups_per_second, busy_per_beat, adc_per_second;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimUartReceive(SIM_MS(60000), 'p');
+    SimRun(MetronomeMain, SIM_MS(60500));
+
+    busy = SimBusyCycles();
+    idle = SimIdleCycles();
+    isr = SimIsrCycles();
+    seconds = (double) SimNow() / SIM_CLOCK_RATE;
+    wakeups_per_second = EventGetWakeupCount() / seconds;
+    busy_per_beat = (double) busy / 120 / SIM_US(1);
+    adc_per_second = SimInterruptCount(INT_ADC0SS1) / seconds;
+
+    // Scheduler wakeups count the time base interrupts; CPU wakeups also count the other ISRs
+    printf("    %.1f scheduler wakeups/s, %.1f CPU wakeups/s, %.3f%% busy-waiting, %.1f us busy per beat\n",
+           wakeups_per_second, SimWakeupCount() / seconds, 100.0 * busy / (busy + idle), busy_per_beat);
+
+    printf("    %.1f rotary angle sensor interrupts/s; %.1f us per beat in interrupt entry, exit and waits\n",
+           adc_per_second, (double) isr / 120 / SIM_US(1));
+
+#if RAS_UDMA
+    CHECK(adc_per_second < 40, "%.1f ADC interrupts/s with uDMA blocks", adc_per_second);
+#endif
+#if SEG7_ASYNC
+    CHECK(busy_per_beat < 10, "%.1f us busy-waiting per beat with the interrupt-driven display", busy_per_beat);
+#endif
+
+    // The 'p' command sends the event profiles, and the CPU time as the simulator counts it,
+    // in busy-waits and ISRs
+    const char *cpu = UartFind("CPU busy ");
+    unsigned busy_whole, busy_hundredths;
+    CHECK(UartFind("beat     ") != NULL && UartFind("button   ") != NULL && UartFind("display  ") != NULL,
+          "the profile dump lacks an event");
+    CHECK(cpu != NULL && sscanf(cpu, "CPU busy %u.%u%%", &busy_whole, &busy_hundredths) == 2 &&
+              abs((int) (busy_whole * 100 + busy_hundredths) - (int) (10000 * (busy + isr) / SimNow())) <= 1,
+          "the profile dump does not report the busy time");
+    if (cpu != NULL)
+        printf("    %.*s\n", (int) strcspn(cpu, "\n\r"), cpu);
+
+#if EVENT_TICKLESS
+    CHECK(wakeups_per_second < 20, "%.1f wakeups/s with the tickless scheduler", wakeups_per_second);
+#else
+    CHECK(wakeups_per_second > 900, "%.1f wakeups/s with the SysTick scheduler", wakeups_per_second);
+#endif
+}
+
+// Log lines of the UART scenario: 40 characters, starting with their phase letter
+#define LOG_LINE_SIZE   40
+#define LOG_LINES       20
+
+static void LogLines(char phase, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        uprintf("%c%02d %-34s\n\r", phase, i, "of the UART logging test");
+}
+
+static struct
+{
+    uint64_t burst_busy;    // busy-wait cycles of the first burst
+    uint64_t burst_time;    // virtual time the first burst took
+    uint32_t dropped;       // bytes dropped by the second burst
+} uart_log;
+
+// Log a burst that fits in the transmit buffer, then two that overflow it: one under the drop
+// policy and one under the block policy
+static void UartLogger()
+{
+    uint64_t start;
+
+    LaunchPadInit();
+
+    start = SimNow();
+    LogLines('A', LOG_LINES / 2);
+    uart_log.burst_busy = SimBusyCycles();
+    uart_log.burst_time = SimNow() - start;
+
+    LogLines('B', LOG_LINES);
+    uart_log.dropped = UartTxDroppedCount();
+
+    UartSetTxPolicy(UART_TX_BLOCK);
+    LogLines('C', LOG_LINES);
+
+    while (true)
+        CPUwfi();
+}
+
+// Logging costs the caller no waiting; output that does not fit is dropped in whole lines or
+// waited for, by policy
+static void UartLogging()
+{
+    const char *output;
+    int i, length, lines[3] = {0, 0, 0};
+
+    SimRun(UartLogger, SIM_MS(300));
+    output = SimUartOutput();
+    length = strlen(output);
+
+    CHECK(uart_log.burst_busy == 0 && uart_log.burst_time == 0,
+          "logging 400 bytes took %llu cycles, %llu of them busy-waiting",
+          (unsigned long long) uart_log.burst_time, (unsigned long long) uart_log.burst_busy);
+    CHECK(uart_log.dropped > 0 && uart_log.dropped % LOG_LINE_SIZE == 0, "%u bytes dropped",
+          uart_log.dropped);
+    CHECK(UartTxDroppedCount() == uart_log.dropped, "the block policy dropped bytes");
+    CHECK(UartTxHighWater() > 0 && UartTxHighWater() <= 512, "high-water mark of %u bytes",
+          UartTxHighWater());
+    CHECK(SimBusyCycles() == 0, "%llu cycles busy-waiting for the UART",
+          (unsigned long long) SimBusyCycles());
+
+    // Every line went out whole and in order
+    CHECK(length % LOG_LINE_SIZE == 0, "%d bytes of output", length);
+    for (i = 0; i + LOG_LINE_SIZE <= length; i += LOG_LINE_SIZE)
+    {
+        const char *line = output + i;
+        int phase = line[0] - 'A';
+        bool whole = phase >= 0 && phase < 3 && line[LOG_LINE_SIZE - 2] == '\n' &&
+                     line[LOG_LINE_SIZE - 1] == '\r' && (i == 0 || line[0] >= line[-LOG_LINE_SIZE]);
+        CHECK(whole, "broken log line at byte %d", i);
+        if (whole)
+            lines[phase]++;
+    }
+    CHECK(lines[0] == LOG_LINES / 2 && lines[2] == LOG_LINES, "%d and %d lines of the bursts that fit",
+          lines[0], lines[2]);
+    CHECK(lines[1] * LOG_LINE_SIZE + uart_log.dropped == LOG_LINES * LOG_LINE_SIZE,
+          "%d lines sent and %u bytes dropped of the overflowing burst", lines[1], uart_log.dropped);
+
+    printf("    %d bytes sent, %u dropped, %u bytes high-water, %u UART interrupts\n", length,
+           uart_log.dropped, UartTxHighWater(), SimInterruptCount(INT_UART0));
+}
+
+#if TRACE_ENABLED
+// Read a little-endian word of a trace record
+static uint32_t RecordWord(const uint8_t *bytes)
+{
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+// Every event dispatch goes out on UART0 as a binary trace record, between the lines of text
+static void TraceRecordsDispatches()
+{
+    const uint8_t *output;
+    int i, length, records = 0, dispatches = 0;
+    uint32_t bpm = 0;
+
+    SimSetKnob(0, KNOB_120_BPM);
+    SimPressButton(SIM_MS(500), 2, PRESS);
+    SimSetKnob(SIM_MS(3000), KNOB_60_BPM);
+    SimRun(MetronomeMain, SIM_MS(6000));
+
+    output = (const uint8_t *) SimUartOutput();
+    length = SimUartOutputLength();
+    for (i = 0; i < length;)
+    {
+        const uint8_t *record = output + i;
+        int count = record[0] & 0x03;
+
+        if (record[0] < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        // Header with the count, format ID and sequence number, then timestamp and arguments
+        if (i + 8 + 4 * count > length)
+        {
+            CHECK(false, "truncated trace record at byte %d", i);
+            break;
+        }
+        CHECK((record[2] | record[3] << 8) == records, "trace record %d has sequence number %d", records,
+              record[2] | record[3] << 8);
+        if (record[1] == TRACE_EVENT_DISPATCH)
+        {
+            CHECK(RecordWord(record + 12) <= BEAT_TOLERANCE, "an event was dispatched %u ticks late",
+                  RecordWord(record + 12));
+            dispatches++;
+        }
+        if (record[1] == TRACE_TEMPO_CHANGE)
+            bpm = RecordWord(record + 8);
+
+        records++;
+        i += 8 + 4 * count;
+    }
+
+    CHECK(strstr(SimUartOutput(), "Metronome") != NULL, "no greeting before the trace");
+    CHECK(dispatches >= 20, "%d event dispatches traced", dispatches);
+    CHECK(bpm == 60, "last traced tempo change is to %u BPM", bpm);
+    CHECK(TraceDroppedCount() == 0, "%u trace records dropped", TraceDroppedCount());
+
+#ifdef TRACE_CAPTURE
+    // Keep the capture for the decoder test in the Makefile
+    FILE *capture = fopen(TRACE_CAPTURE, "wb");
+    if (capture != NULL)
+    {
+        fwrite(output, 1, length, capture);
+        fclose(capture);
+    }
+#endif
+
+    printf("    %d trace records, %d dispatches in %d bytes\n", records, dispatches, length);
+}
+#endif
+
+typedef struct
+{
+    const char *name;
+    void (*run)();
+} Scenario;
+
+static const Scenario scenarios[] = {
+    {"boot shows menu", BootShowsMenu},
+    {"SW1 rotates the menu", MenuRotates},
+    {"fast bouncing taps all register", FastTapsRegister},
+    {"holding SW1 repeats, a chord is ignored", HoldRepeatsChordIgnored},
+    {"beats at 120 BPM", BeatsAt120Bpm},
+    {"tempo follows the knob", TempoFollowsKnob},
+    {"a noisy knob keeps the tempo", NoisyKnobKeepsTempo},
+    {"SW2 stops and returns to the menu", StopReturnsToMenu},
+    {"7/8 accents its 2+2+3 groups", PatternGroupsAccents},
+    {"three against two interleaves", PolyrhythmInterleaves},
+    {"settings survive a power cycle", SettingsSurvivePowerCycle},
+    {"beats run ahead of the push buttons", BeatsAheadOfButtons},
+    {"a press just before sleep is not delayed", PressBeforeSleepHandled},
+    {"display follows the updates", DisplayFollowsUpdates},
+#if BUZZER_CLICKS
+    {"clicks play out without the CPU", ClicksNeedNoCpu},
+#endif
+#if BEAT_TIMER
+    {"the beat timer keeps the onsets on time", BeatTimerOnsetsOnTime},
+#endif
+    {"CPU cost of one minute at 120 BPM", CpuCost},
+    {"UART logging does not wait", UartLogging},
+#if TRACE_ENABLED
+    {"event dispatches are traced", TraceRecordsDispatches},
+#endif
+};
+
+int main(int argc, char *argv[])
+{
+    int i, failed = 0;
+    int count = sizeof(scenarios) / sizeof(scenarios[0]);
+
+    printf("%s (%s scheduler, %s display, %s UART, %s)\n", argv[0], EVENT_TICKLESS ? "tickless" : "SysTick",
+           SEG7_ASYNC ? "interrupt-driven" : "bit-banged", UART_TX_UDMA ? "uDMA" : "interrupt-driven",
+           BUZZER_CLICKS ? (BEAT_TIMER ? "timer-driven uDMA clicks" : "uDMA clicks") : "square wave");
+
+    for (i = 0; i < count; i++)
+    {
+        int status;
+        pid_t pid;
+
+        fflush(stdout);
+        pid = fork();
+        if (pid == 0)
+        {
+            scenarios[i].run();
+            fflush(stdout);
+            _exit(failures ? 1 : 0);
+        }
+
+        waitpid(pid, &status, 0);
+        bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (WIFSIGNALED(status))
+            printf("    killed by signal %d\n", WTERMSIG(status));
+        printf("  %-40s %s\n", scenarios[i].name, passed ? "ok" : "FAILED");
+        if (!passed)
+            failed++;
+    }
+
+    printf("%d of %d scenarios passed\n", count - failed, count);
+    return failed ? 1 : 0;
+}
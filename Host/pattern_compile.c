@@ -0,0 +1,231 @@
+/*
+ * pattern_compile.c: compiler of the beat patterns in Program/patterns.txt
+ *
+ * ----------------------------
+ *  Created on: Dec 13, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Reads the pattern descriptions named on the command line and writes Program/pattern_table.c
+ * to standard output; see patterns.txt for the format and pattern_table.h for the tables.
+ *
+ * A polyrhythm is laid out on the least common multiple of the step counts of its voices. The
+ * main voice plays where both voices fall on one step, since the buzzer plays one click at a
+ * time.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "pattern_table.h"
+
+#define MAX_PATTERNS    64
+#define MAX_STEPS       63      // per bar, as Pattern.steps holds them
+#define MAX_TOTAL       1024    // in all patterns, as Pattern.first indexes them
+#define MAX_SUBDIVISION 15
+#define MAX_BEATS       9       // the display shows the count in one digit
+#define MAX_LINE        256
+
+typedef struct
+{
+    char line[MAX_LINE];        // the description, for the comments
+    Pattern pattern;
+} Compiled;
+
+static Compiled compiled[MAX_PATTERNS];
+static uint8_t steps[MAX_TOTAL];
+static int pattern_count, step_count;
+
+static const char *file_name;
+static int line_number;
+
+static void Fail(const char *message)
+{
+    fprintf(stderr, "%s:%d: %s\n", file_name, line_number, message);
+    exit(1);
+}
+
+static int Gcd(int a, int b)
+{
+    while (b != 0)
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Read the steps of a voice, up to a '|' or the end of the text, as click levels; return their
+// number, and leave the text after them
+static int ParseVoice(const char **text, uint8_t levels[])
+{
+    int n = 0;
+
+    for (; **text != '\0' && **text != '|'; (*text)++)
+    {
+        int level;
+
+        switch (**text)
+        {
+        case 'A': level = PATTERN_ACCENT; break;
+        case 'a': level = PATTERN_MEDIUM; break;
+        case 'x': level = PATTERN_NORMAL; break;
+        case '.': level = PATTERN_REST; break;
+        default:
+            if (isspace((unsigned char) **text))
+                continue;
+            Fail("a step is one of A, a, x and .");
+        }
+
+        if (n == MAX_STEPS)
+            Fail("too many steps in one bar");
+        levels[n++] = level;
+    }
+
+    return n;
+}
+
+// Compile one description: "top:bottom[/subdivision] main [| second]"
+static void Compile(const char *line)
+{
+    Compiled *entry = &compiled[pattern_count];
+    uint8_t main_voice[MAX_STEPS], second_voice[MAX_STEPS];
+    int top, bottom, subdivision = 1, main_steps, second_steps, total, stretch, i, length = 0;
+    const char *text;
+
+    if (pattern_count == MAX_PATTERNS)
+        Fail("too many patterns");
+    if (sscanf(line, " %1d:%1d%n/%d%n", &top, &bottom, &length, &subdivision, &length) < 2 || length == 0)
+        Fail("a pattern starts with its name, top:bottom with one digit each");
+    if (top == 0 || bottom == 0)
+        Fail("a name has no 0 digit");
+    if (subdivision < 1 || subdivision > MAX_SUBDIVISION)
+        Fail("1 to 15 steps per beat");
+
+    text = line + length;
+    main_steps = ParseVoice(&text, main_voice);
+    second_steps = main_steps;
+    if (*text == '|')
+    {
+        text++;
+        second_steps = ParseVoice(&text, second_voice);
+        if (*text == '|')
+            Fail("at most two voices");
+    }
+    if (main_steps == 0 || second_steps == 0)
+        Fail("a voice without steps");
+    if (main_steps % subdivision != 0)
+        Fail("the steps are not whole beats");
+    if (main_steps / subdivision > MAX_BEATS)
+        Fail("more beats than the display can count");
+
+    // Both voices on the least common multiple of their steps
+    total = main_steps / Gcd(main_steps, second_steps) * second_steps;
+    stretch = total / main_steps;
+    if (total > MAX_STEPS)
+        Fail("the voices need too many steps together");
+    if (subdivision * stretch > MAX_SUBDIVISION)
+        Fail("the voices need too many steps per beat together");
+    if (step_count + total > MAX_TOTAL)
+        Fail("too many steps in all patterns");
+
+    entry->pattern.first = step_count;
+    entry->pattern.steps = total;
+    entry->pattern.subdivision = subdivision * stretch;
+    entry->pattern.top = top;
+    entry->pattern.bottom = bottom;
+    strncpy(entry->line, line, MAX_LINE - 1);
+    entry->line[strcspn(entry->line, "#\n")] = '\0';
+    while (length = strlen(entry->line), length > 0 && isspace((unsigned char) entry->line[length - 1]))
+        entry->line[length - 1] = '\0';
+
+    for (i = 0; i < total; i++)
+    {
+        int beat_step = i % entry->pattern.subdivision == 0;
+        int level = 0, voice = 0, count = beat_step ? i / entry->pattern.subdivision + 1 : 0;
+
+        if (i % stretch == 0)
+            level = main_voice[i / stretch];
+        if (level == PATTERN_REST && second_steps != main_steps && i % (total / second_steps) == 0)
+        {
+            level = second_voice[i / (total / second_steps)];
+            voice = level != PATTERN_REST;
+        }
+
+        steps[step_count++] = count | level << 4 | voice << 6;
+    }
+
+    pattern_count++;
+}
+
+int main(int argc, char *argv[])
+{
+    char line[MAX_LINE];
+    FILE *file;
+    int i, j;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s patterns.txt\n", argv[0]);
+        return 2;
+    }
+    file_name = argv[1];
+    file = fopen(file_name, "r");
+    if (file == NULL)
+    {
+        perror(file_name);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        line[strcspn(line, "#")] = '\0';
+        if (strspn(line, " \t\r\n") == strlen(line))
+            continue;
+        Compile(line);
+    }
+    fclose(file);
+    if (pattern_count == 0)
+        Fail("no patterns");
+
+    printf("/*\n");
+    printf(" * pattern_table.c: compiled beat patterns of the metronome\n");
+    printf(" *\n");
+    printf(" * Generated by Host/pattern_compile.c from Program/patterns.txt; do not edit. See pattern_table.h.\n");
+    printf(" */\n\n");
+    printf("#include <stdint.h>\n");
+    printf("#include \"pattern_table.h\"\n\n");
+    printf("const uint32_t PATTERN_COUNT = %d;\n\n", pattern_count);
+
+    printf("// {first, steps, subdivision, top, bottom}\n");
+    printf("const Pattern PATTERNS[%d] = {\n", pattern_count);
+    for (i = 0; i < pattern_count; i++)
+    {
+        const Pattern *pattern = &compiled[i].pattern;
+        printf("    {%u, %u, %u, %u, %u}, // %s\n", pattern->first, pattern->steps, pattern->subdivision,
+               pattern->top, pattern->bottom, compiled[i].line);
+    }
+    printf("};\n\n");
+
+    printf("// Steps: count | level << 4 | voice << 6\n");
+    printf("const uint8_t PATTERN_STEPS[%d] = {\n", step_count);
+    for (i = 0; i < pattern_count; i++)
+    {
+        const Pattern *pattern = &compiled[i].pattern;
+        for (j = 0; j < (int) pattern->steps; j++)
+            printf("%s0x%02X,", j % 12 ? " " : (j ? "\n    " : "    "), steps[pattern->first + j]);
+        printf(" // %u:%u\n", pattern->top, pattern->bottom);
+    }
+    printf("};\n");
+
+    return 0;
+}
@@ -0,0 +1,317 @@
+/*
+ * printf_bench.c: host-side conformance test and benchmark of TivaWare's printf functions
+ *
+ * ----------------------------
+ *  Created on: Dec 18, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Runs utils/ustdlib.c and utils/uartstdio.c, unbuffered, over stubs of the UART that capture
+ * what UARTprintf() sends. Each case of a table of formats and arguments is checked through
+ * usnprintf() into buffers of every size from 1 byte up (the text must be cut, and the count
+ * returned, exactly as for the full buffer), through usnprintfc() and UARTprintfc() with the
+ * format parsed by UFormatCompile(), and through UARTprintf(), which sends \r\n for \n. The
+ * expected strings are those of TivaWare's own implementation: %X in lower case, %s padded on
+ * the right, ERROR for an unknown conversion.
+ *
+ * Then it times the functions on the metronome's kinds of log lines, in MB of formatted text
+ * per second, with the C library's snprintf() for reference. usnprintfc() runs the shared
+ * engine in both builds. UARTprintf() spends most of its time in the stub of UARTCharPut(), as
+ * it waits on the UART on the target.
+ *
+ * The Makefile builds it three times: printf_bench_core, printf_bench_inline with the engine's
+ * conversion inline in its callers (UFORMAT_INLINE=1), and printf_bench_classic with the original
+ * formatting loops (UFORMAT_CORE=0). All are run by "make test" there. The classic build
+ * skips the cases the original loops get wrong: they take every number as an unsigned long,
+ * which is 64 bits here and 32 on the target, so negative numbers and the arguments passed on
+ * the stack come out wrong on this host only; and on the target too, they lose count of the
+ * buffer after padding a %s, read past a % at the end of the format, and UARTprintf() drops
+ * field widths of 16 or more.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/uart.h>
+#include <utils/ustdlib.h>
+#include <utils/uartstdio.h>
+#include "bench.h"
+
+#define BENCH_LINES         (512 * 1024)        // formatted per measurement
+#define BENCH_RUNS          5                   // measurements, of which the best counts
+#define UART_CAPTURE        256
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Stub UART: capture what is sent, or only count it while timing
+ */
+static char uart_text[UART_CAPTURE];
+static uint32_t uart_length;
+static bool uart_capture;
+
+void UARTCharPut(uint32_t base, unsigned char data)
+{
+    if (uart_capture && uart_length < UART_CAPTURE - 1)
+        uart_text[uart_length] = data;
+    uart_length++;
+}
+
+int32_t UARTCharGet(uint32_t base)
+{
+    return '\r';
+}
+
+bool SysCtlPeripheralPresent(uint32_t peripheral)
+{
+    return true;
+}
+
+void SysCtlPeripheralEnable(uint32_t peripheral)
+{
+}
+
+void UARTConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t baud, uint32_t config)
+{
+}
+
+void UARTEnable(uint32_t base)
+{
+}
+
+/*
+ * Check one case: the format, what it gives, and whether the classic build gives it too
+ */
+static void Check(bool classic, const char *expected, const char *format, ...)
+{
+    char text[128], crlf[UART_CAPTURE];
+    tUFormat compiled;
+    va_list args;
+    uint32_t length = strlen(expected), i, n;
+    int count;
+
+    if (!classic && !UFORMAT_CORE)
+        return;
+
+    for (n = 1; n <= length + 1; n++)
+    {
+        memset(text, '#', sizeof(text));
+        va_start(args, format);
+        count = uvsnprintf(text, n, format, args);
+        va_end(args);
+        CHECK(count == (int) length, "\"%s\" counted %d characters, not %u, in %u bytes", format, count, length, n);
+        CHECK(strncmp(text, expected, n - 1) == 0 && text[n - 1] == '\0' && text[n] == '#',
+              "\"%s\" gave \"%.*s\" in %u bytes, not \"%.*s\"", format, (int) n - 1, text, n, (int) n - 1, expected);
+    }
+
+    // UARTprintf() sends \r\n for \n
+    for (i = n = 0; expected[i] != '\0'; i++)
+    {
+        if (expected[i] == '\n')
+            crlf[n++] = '\r';
+        crlf[n++] = expected[i];
+    }
+    crlf[n] = '\0';
+    uart_capture = true;
+    uart_length = 0;
+    va_start(args, format);
+    UARTvprintf(format, args);
+    va_end(args);
+    uart_text[uart_length] = '\0';
+    CHECK(strcmp(uart_text, crlf) == 0, "UARTprintf(\"%s\") sent \"%s\"", format, uart_text);
+
+    if (!UFormatCompile(&compiled, format))
+    {
+        CHECK(strstr(expected, "ERROR") != NULL, "\"%s\" did not compile", format);
+        return;
+    }
+    va_start(args, format);
+    count = uvsnprintfc(text, sizeof(text), &compiled, args);
+    va_end(args);
+    CHECK(count == (int) length && strcmp(text, expected) == 0, "compiled \"%s\" gave \"%s\"", format, text);
+
+    uart_length = 0;
+    va_start(args, format);
+    UARTvprintfc(&compiled, args);
+    va_end(args);
+    uart_text[uart_length] = '\0';
+    CHECK(strcmp(uart_text, crlf) == 0, "UARTprintfc(\"%s\") sent \"%s\"", format, uart_text);
+}
+
+static void Conformance(void)
+{
+    const char *unknown = "%q then %";
+    tUFormat compiled;
+    uint32_t i;
+
+    Check(true, "", "");
+    Check(true, "plain text, no conversions\n", "plain text, no conversions\n");
+    Check(true, "100% sure", "100%% sure");
+    Check(true, "c=x, s=abc, u=42", "c=%c, s=%s, u=%u", 'x', "abc", 42u);
+    Check(false, "0 7 10 99 100 4294967295", "%u %u %u %u %u %u", 0u, 7u, 10u, 99u, 100u, 4294967295u);
+    Check(true, "1000000000 123456789 65536", "%d %i %d", 1000000000, 123456789, 65536);
+    Check(false, "-1 -42 -2147483648", "%d %i %d", -1, -42, (int32_t) 0x80000000);
+    Check(true, "0 ff deadbeef", "%x %X %x", 0u, 255u, 0xDEADBEEFu);
+    Check(true, "2000abcd", "%p", (void *) 0x2000abcd);
+    Check(true, "[    5] [00005] [5]", "[%5u] [%05u] [%1u]", 5u, 5u, 5u);
+    Check(false, "[  -42] [-0042]", "[%5d] [%05d]", -42, -42);
+    Check(true, "[000000ff] [      ff]", "[%08x] [%8x]", 255u, 255u);
+    Check(false, "[                        1]", "[%25u]", 1u);
+    Check(false, "[ab    ]", "[%6s]", "ab");
+    Check(false, "[ab    ] then more", "[%6s] then more", "ab");
+    Check(true, "[abcdef]", "[%3s]", "abcdef");
+    Check(false, "ERROR then ERROR", unknown);
+
+    // Every 32-bit value at a stride, and the powers of ten either side
+    for (i = 0; i < 4000000000u; i += 1234567)
+    {
+        char expected[16];
+
+        snprintf(expected, sizeof(expected), "%u", i);
+        Check(true, expected, "%u", i);
+    }
+    for (i = 1; i < 1000000000u; i *= 10)
+    {
+        char expected[32];
+
+        snprintf(expected, sizeof(expected), "%u %u %08x", i - 1, i, i);
+        Check(true, expected, "%u %u %08x", i - 1, i, i);
+    }
+
+    CHECK(!UFormatCompile(&compiled, "%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u"),
+          "a format with %u conversions compiled", UFORMAT_MAX_STEPS);
+    CHECK(UFormatCompile(&compiled, "%u%u%u%u%u%u%u%u%u%u%u%u%u%u%u"),
+          "a format with %u conversions did not compile", UFORMAT_MAX_STEPS - 1);
+}
+
+/*
+ * The metronome's kinds of log lines
+ */
+#define LOG_TEMPO           "%u.%03u s: tempo %u bpm, beat %u of %u\n"
+#define LOG_SAMPLES         "ras %4u %4u %4u %4u, button %x\n"
+#define LOG_RECORD          "settings %08x, seq %u, %s\n"
+
+static const char * const log_names[] = {"tempo", "samples", "record"};
+
+enum { BENCH_SNPRINTF, BENCH_USNPRINTF, BENCH_USNPRINTFC, BENCH_UARTPRINTF, BENCH_WAYS };
+
+/*
+ * Format BENCH_LINES of one kind one way; return the MB of text formatted per second
+ */
+static double Throughput(int kind, int way, const tUFormat *compiled)
+{
+    char text[96];
+    uint32_t line, bytes = 0;
+    double start;
+
+    uart_capture = false;
+    uart_length = 0;
+    start = BenchSeconds();
+    for (line = 0; line < BENCH_LINES; line++)
+    {
+        uint32_t a = line * 2654435761u, b = line & 0xFFF;
+
+        switch (way * 3 + kind)
+        {
+        case BENCH_SNPRINTF * 3 + 0:
+            bytes += snprintf(text, sizeof(text), LOG_TEMPO, line / 1000, line % 1000, 40 + b % 200, b % 4 + 1, 4);
+            break;
+        case BENCH_SNPRINTF * 3 + 1:
+            bytes += snprintf(text, sizeof(text), LOG_SAMPLES, b, a >> 20, b ^ 0x5A5, a >> 22, line & 15);
+            break;
+        case BENCH_SNPRINTF * 3 + 2:
+            bytes += snprintf(text, sizeof(text), LOG_RECORD, a, line, line & 1 ? "written" : "erased");
+            break;
+        case BENCH_USNPRINTF * 3 + 0:
+            bytes += usnprintf(text, sizeof(text), LOG_TEMPO, line / 1000, line % 1000, 40 + b % 200, b % 4 + 1, 4);
+            break;
+        case BENCH_USNPRINTF * 3 + 1:
+            bytes += usnprintf(text, sizeof(text), LOG_SAMPLES, b, a >> 20, b ^ 0x5A5, a >> 22, line & 15);
+            break;
+        case BENCH_USNPRINTF * 3 + 2:
+            bytes += usnprintf(text, sizeof(text), LOG_RECORD, a, line, line & 1 ? "written" : "erased");
+            break;
+        case BENCH_USNPRINTFC * 3 + 0:
+            bytes += usnprintfc(text, sizeof(text), compiled, line / 1000, line % 1000, 40 + b % 200, b % 4 + 1, 4);
+            break;
+        case BENCH_USNPRINTFC * 3 + 1:
+            bytes += usnprintfc(text, sizeof(text), compiled, b, a >> 20, b ^ 0x5A5, a >> 22, line & 15);
+            break;
+        case BENCH_USNPRINTFC * 3 + 2:
+            bytes += usnprintfc(text, sizeof(text), compiled, a, line, line & 1 ? "written" : "erased");
+            break;
+        case BENCH_UARTPRINTF * 3 + 0:
+            UARTprintf(LOG_TEMPO, line / 1000, line % 1000, 40 + b % 200, b % 4 + 1, 4);
+            break;
+        case BENCH_UARTPRINTF * 3 + 1:
+            UARTprintf(LOG_SAMPLES, b, a >> 20, b ^ 0x5A5, a >> 22, line & 15);
+            break;
+        case BENCH_UARTPRINTF * 3 + 2:
+            UARTprintf(LOG_RECORD, a, line, line & 1 ? "written" : "erased");
+            break;
+        }
+    }
+    if (way == BENCH_UARTPRINTF)
+        bytes = uart_length;
+
+    return bytes / (BenchSeconds() - start) / 1e6;
+}
+
+int main(void)
+{
+    static const char * const formats[] = {LOG_TEMPO, LOG_SAMPLES, LOG_RECORD};
+    int kind;
+
+    printf("%s\n", !UFORMAT_CORE ? "printf functions, original formatting loops:" :
+           UFORMAT_INLINE ? "printf functions, shared formatting engine, inline:" :
+           "printf functions, shared formatting engine:");
+
+    UARTStdioConfig(0, 115200, 16000000);
+    Conformance();
+
+    for (kind = 0; kind < 3; kind++)
+    {
+        tUFormat compiled;
+        double ways[BENCH_WAYS];
+        int way;
+
+        CHECK(UFormatCompile(&compiled, formats[kind]), "the %s line did not compile", log_names[kind]);
+        for (way = 0; way < BENCH_WAYS; way++)
+        {
+            int run;
+
+            for (ways[way] = run = 0; run < BENCH_RUNS; run++)
+            {
+                double rate = Throughput(kind, way, &compiled);
+
+                if (rate > ways[way])
+                    ways[way] = rate;
+            }
+        }
+
+        printf("  %-7s lines: usnprintf %6.1f MB/s, pre-parsed %6.1f, UARTprintf %6.1f; snprintf %6.1f\n",
+               log_names[kind], ways[BENCH_USNPRINTF], ways[BENCH_USNPRINTFC], ways[BENCH_UARTPRINTF],
+               ways[BENCH_SNPRINTF]);
+    }
+
+    return failures ? 1 : 0;
+}
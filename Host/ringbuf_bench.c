@@ -0,0 +1,376 @@
+/*
+ * ringbuf_bench.c: host-side stress test and benchmark of TivaWare's utils/ringbuf.c
+ *
+ * ----------------------------
+ *  Created on: Dec 15, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Times writing and reading through a 512-byte ring buffer, one byte at a time and in chunks of
+ * 16 and 64 bytes, and counts the sections that the ring buffer runs with interrupts disabled,
+ * through stubs of IntMasterDisable() and IntMasterEnable(). On the target each of those holds
+ * off every interrupt of the system for its length.
+ *
+ * With the single-producer, single-consumer implementation (RINGBUF_SPSC), it first runs a
+ * producer and a consumer thread against each other for 16 MB, through a small buffer whose
+ * indices start just short of their wrap. Both use every way in and out of the buffer, at
+ * random: one byte, a run, and in place with RingBufContigFree()/RingBufContigUsed() and the
+ * advance functions. The consumer checks every byte.
+ *
+ * Then it sends lines and trace records through the UART driver, Util/uart.c, on stubs of
+ * driverlib with a UART that takes every byte at once, and counts the sections it runs with
+ * all interrupts disabled, by itself or in the ring buffer, and those that hold off only the
+ * UART interrupt (IntDisable()).
+ *
+ * The Makefile builds it twice: ringbuf_bench_spsc with RINGBUF_SPSC=1, and ringbuf_bench_masked
+ * with TivaWare's default, the original implementation. Both are run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <inc/hw_ints.h>
+#include <driverlib/cpu.h>
+#include <driverlib/gpio.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/uart.h>
+#include <utils/ringbuf.h>
+#include "bench.h"
+
+// The UART driver's functions from launchpad.h, whose time_t clashes with that of pthread.h
+void UartInit();
+int UartPutString(char *buffer);
+uint32_t UartTxDroppedCount();
+void TraceLog(uint32_t header, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+uint32_t TraceDroppedCount();
+
+#define TRACE_HEADER3       (0x80 | 3)          // a trace record with three arguments
+
+#define BENCH_BUFFER        512
+#define BENCH_BYTES         (16 * 1024 * 1024)  // through the buffer per measurement
+#define STRESS_BUFFER       64
+#define STRESS_BYTES        (16 * 1024 * 1024)
+#define STRESS_START        0xFFFFF000          // first index, so the indices wrap
+#define UART_LINES          (1024 * 1024)
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Stub interrupt masking: count the masked sections
+ */
+static uint32_t masked_sections;
+
+bool IntMasterDisable(void)
+{
+    masked_sections++;
+    return false;
+}
+
+bool IntMasterEnable(void)
+{
+    return false;
+}
+
+/*
+ * Stubs of the rest of what the UART driver uses: the UART takes every byte at once, and
+ * runs in thread context. The sections that hold off the UART interrupt alone are counted.
+ */
+static uint32_t uart_sections, uart_bytes;
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+    uart_sections += ui32Interrupt == INT_UART0;
+}
+
+void IntEnable(uint32_t ui32Interrupt) {}
+void IntPendSet(uint32_t ui32Interrupt) {}
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority) {}
+void CPUwfi(void) {}
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral) {}
+void SysCtlPeripheralSleepEnable(uint32_t ui32Peripheral) {}
+uint32_t SysCtlClockGet(void) { return 50000000; }
+void GPIOPinConfigure(uint32_t ui32PinConfig) {}
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins) {}
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t ui32Baud, uint32_t ui32Config) {}
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel) {}
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void)) {}
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked) { return 0; }
+bool UARTCharsAvail(uint32_t ui32Base) { return false; }
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base) { return -1; }
+int32_t UARTCharGet(uint32_t ui32Base) { return 0; }
+bool UARTSpaceAvail(uint32_t ui32Base) { return true; }
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    uart_bytes++;
+    return true;
+}
+
+void EventPost(void *event, uint64_t time) {}
+uint64_t EventGetCurrentTime() { return 0; }
+
+// HWREG() reads zero: no ISR is active, and the cycle counter stands still
+volatile uint32_t *SimRegister(uint32_t addr)
+{
+    static volatile uint32_t value;
+
+    value = 0;
+    return &value;
+}
+
+// The byte at a position of the stream
+static inline uint8_t StreamByte(uint32_t position)
+{
+    return (uint8_t) (position ^ (position >> 8) ^ (position >> 16));
+}
+
+#if RINGBUF_SPSC
+static tRingBufObject stress_ring;
+static uint8_t stress_buffer[STRESS_BUFFER];
+
+static void *StressProducer(void *arg)
+{
+    uint32_t seed = 0x9E3779B9, position = 0;
+    uint8_t chunk[STRESS_BUFFER];
+
+    while (position < STRESS_BYTES)
+    {
+        uint32_t r = BenchRandom(&seed), n = RingBufFree(&stress_ring), i;
+
+        if (n == 0)
+        {
+            sched_yield(); // the other thread may share the CPU
+            continue;
+        }
+        if (n > 1 + (r >> 8) % STRESS_BUFFER)
+            n = 1 + (r >> 8) % STRESS_BUFFER;
+        if (n > STRESS_BYTES - position)
+            n = STRESS_BYTES - position;
+
+        switch (r % 3)
+        {
+        case 0:
+            RingBufWriteOne(&stress_ring, StreamByte(position++));
+            break;
+        case 1:
+            for (i = 0; i < n; i++)
+                chunk[i] = StreamByte(position + i);
+            RingBufWrite(&stress_ring, chunk, n);
+            position += n;
+            break;
+        case 2:
+        {
+            uint32_t offset = stress_ring.ui32WriteIndex % STRESS_BUFFER;
+            if (n > RingBufContigFree(&stress_ring))
+                n = RingBufContigFree(&stress_ring);
+            for (i = 0; i < n; i++)
+                stress_buffer[offset + i] = StreamByte(position + i);
+            RingBufAdvanceWrite(&stress_ring, n);
+            position += n;
+            break;
+        }
+        }
+    }
+
+    return NULL;
+}
+
+static void *StressConsumer(void *arg)
+{
+    uint32_t seed = 0x2545F491, position = 0, *errors = arg;
+    uint8_t chunk[STRESS_BUFFER];
+
+    while (position < STRESS_BYTES)
+    {
+        uint32_t r = BenchRandom(&seed), n = RingBufUsed(&stress_ring), i;
+
+        if (n == 0)
+        {
+            sched_yield(); // the other thread may share the CPU
+            continue;
+        }
+        if (n > 1 + (r >> 8) % STRESS_BUFFER)
+            n = 1 + (r >> 8) % STRESS_BUFFER;
+        if (n > STRESS_BYTES - position)
+            n = STRESS_BYTES - position;
+
+        switch (r % 3)
+        {
+        case 0:
+            *errors += RingBufReadOne(&stress_ring) != StreamByte(position++);
+            break;
+        case 1:
+            RingBufRead(&stress_ring, chunk, n);
+            for (i = 0; i < n; i++)
+                *errors += chunk[i] != StreamByte(position + i);
+            position += n;
+            break;
+        case 2:
+        {
+            uint32_t offset = stress_ring.ui32ReadIndex % STRESS_BUFFER;
+            if (n > RingBufContigUsed(&stress_ring))
+                n = RingBufContigUsed(&stress_ring);
+            for (i = 0; i < n; i++)
+                *errors += stress_buffer[offset + i] != StreamByte(position + i);
+            RingBufAdvanceRead(&stress_ring, n);
+            position += n;
+            break;
+        }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * A producer and a consumer thread, against each other
+ */
+static void Stress()
+{
+    pthread_t producer, consumer;
+    uint32_t errors = 0;
+    double start;
+
+    RingBufInit(&stress_ring, stress_buffer, STRESS_BUFFER);
+    stress_ring.ui32WriteIndex = stress_ring.ui32ReadIndex = STRESS_START;
+
+    CHECK(RingBufEmpty(&stress_ring) && RingBufFree(&stress_ring) == STRESS_BUFFER, "a new buffer is not empty");
+
+    start = BenchSeconds();
+    pthread_create(&producer, NULL, StressProducer, NULL);
+    pthread_create(&consumer, NULL, StressConsumer, &errors);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    CHECK(errors == 0, "%u bytes read wrong", errors);
+    CHECK(RingBufEmpty(&stress_ring), "%u bytes left over", RingBufUsed(&stress_ring));
+    CHECK(stress_ring.ui32ReadIndex == STRESS_START + STRESS_BYTES, "the indices did not wrap as expected");
+    printf("  stress: %u MB between two threads in %.2f s, %u bytes wrong\n", STRESS_BYTES >> 20,
+           BenchSeconds() - start, errors);
+}
+#endif
+
+/*
+ * Write and read BENCH_BYTES in chunks of the given size; return the time per byte, in ns, and
+ * the masked sections per chunk written and read
+ */
+static double Throughput(uint32_t chunk, double *sections)
+{
+    static uint8_t buffer[BENCH_BUFFER];
+    static uint8_t data[64];
+    tRingBufObject ring;
+    uint32_t done, i, errors = 0;
+    double start, ns;
+
+    RingBufInit(&ring, buffer, BENCH_BUFFER);
+    for (i = 0; i < chunk; i++)
+        data[i] = (uint8_t) i;
+    masked_sections = 0;
+
+    start = BenchSeconds();
+    for (done = 0; done < BENCH_BYTES; done += chunk)
+    {
+        if (chunk == 1)
+        {
+            RingBufWriteOne(&ring, data[0]);
+            errors += RingBufReadOne(&ring) != data[0];
+        }
+        else
+        {
+            uint8_t out[64];
+
+            RingBufWrite(&ring, data, chunk);
+            RingBufRead(&ring, out, chunk);
+            errors += out[chunk - 1] != data[chunk - 1];
+        }
+    }
+    ns = (BenchSeconds() - start) * 1e9 / BENCH_BYTES;
+
+    CHECK(errors == 0, "%u chunks of %u bytes read wrong", errors, chunk);
+    *sections = (double) masked_sections / (BENCH_BYTES / chunk);
+    return ns;
+}
+
+/*
+ * Send UART_LINES lines, each after a trace record with three arguments; return the time per
+ * line, in ns, and the sections per line with all interrupts and with the UART's held off
+ */
+static double UartDriver(double *masked, double *uart_masked)
+{
+    static char line[] = "beat 3 of 4 at 120 BPM\r\n";
+    uint32_t i, sent = 0;
+    double start, ns;
+
+    UartInit();
+    masked_sections = uart_sections = uart_bytes = 0;
+
+    start = BenchSeconds();
+    for (i = 0; i < UART_LINES; i++)
+    {
+        TraceLog(TRACE_HEADER3, i, i, i);
+        sent += UartPutString(line);
+    }
+    ns = (BenchSeconds() - start) * 1e9 / UART_LINES;
+
+    CHECK(sent == UART_LINES * (sizeof(line) - 1) && UartTxDroppedCount() == 0 && TraceDroppedCount() == 0,
+          "the UART driver dropped output");
+    CHECK(uart_bytes == UART_LINES * (sizeof(line) - 1 + 20), "%u bytes reached the UART", uart_bytes);
+    *masked = (double) masked_sections / UART_LINES;
+    *uart_masked = (double) uart_sections / UART_LINES;
+    return ns;
+}
+
+int main(void)
+{
+    static const uint32_t chunks[] = {1, 16, 64};
+    int i;
+
+    printf("%s\n", RINGBUF_SPSC ? "Ring buffer, single producer and consumer:" :
+           "Ring buffer, interrupts masked:");
+
+#if RINGBUF_SPSC
+    Stress();
+#endif
+
+    for (i = 0; i < (int) (sizeof(chunks) / sizeof(chunks[0])); i++)
+    {
+        double sections, ns = Throughput(chunks[i], &sections);
+
+        printf("  %2u-byte writes and reads: %6.2f ns per byte, %5.1f masked sections per write and read\n",
+               chunks[i], ns, sections);
+    }
+
+    {
+        double masked, uart_masked, ns = UartDriver(&masked, &uart_masked);
+
+#if RINGBUF_SPSC
+        CHECK(masked == 0, "the UART driver disabled all interrupts %.1f times per line", masked);
+#endif
+
+        printf("  UART driver, a line and a trace record: %6.2f ns, %4.1f sections with all interrupts\n"
+               "    masked, %4.1f with the UART interrupt masked\n", ns, masked, uart_masked);
+    }
+
+    return failures ? 1 : 0;
+}
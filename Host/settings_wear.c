@@ -0,0 +1,201 @@
+/*
+ * settings_wear.c: host-side wear and power-loss simulation of the settings store
+ *
+ * ----------------------------
+ *  Created on: Dec 14, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Runs Program/settings.c against a stub EEPROM that counts the writes of every word, and
+ * Util/event.c against a stub event timer. It stores 100,000 changes of the settings, each
+ * after the write delay, and reports how the writes spread over the EEPROM, against a single
+ * record rewritten in place. One write in 97, at random, is cut short after a random number of
+ * words, as by a power loss, and every write is followed by a power-up: the settings restored must be
+ * those of the last complete write, found in a bounded number of reads.
+ *
+ * Built by Host/Makefile, and run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "launchpad.h"
+#include "settings.h"
+#include "bench.h"
+
+#define CHANGES             100000
+#define TORN_ODDS           97          // one write in this many is cut short
+#define WEAR_SPREAD         1.05        // most writes of a word, against the average
+#define EEPROM_WORDS        512
+#define ENDURANCE           500000      // writes per word assumed for the lifetime estimate
+#define MAX_INIT_READS      16          // a slot, a binary search of seven, two records
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Stub event timer: the simulation sets the time; the rest does nothing
+ */
+static time_t wear_now = 0;
+
+uint32_t SysCtlClockGet(void) { return EVENT_TICK_RATE; }
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral) {}
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config) {}
+void TimerLoadSet64(uint32_t ui32Base, uint64_t ui64Value) {}
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer, void (*pfnHandler)(void)) {}
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer) {}
+void TimerMatchSet64(uint32_t ui32Base, uint64_t ui64Value) {}
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+void IntPendSet(uint32_t ui32Interrupt) {}
+uint32_t CPUcpsid(void) { return 0; }
+uint32_t CPUcpsie(void) { return 0; }
+void CPUwfi(void) {}
+uint64_t TimerValueGet64(uint32_t ui32Base) { return wear_now; }
+void SysCtlPeripheralSleepEnable(uint32_t ui32Peripheral) {}
+void CPUUsageInit(uint32_t ui32ClockRate, uint32_t ui32Rate, uint32_t ui32Timer) {}
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer) { return 0; }
+int uprintf(char *fmt, ...) { return 0; }
+int32_t IntPriorityGet(uint32_t ui32Interrupt) { return 0x20; }
+
+volatile uint32_t *SimRegister(uint32_t addr)
+{
+    static volatile uint32_t value;
+    value = 0; // thread context
+    return &value;
+}
+
+/*
+ * Stub EEPROM, erased at the start; a write may be cut short after torn_after words
+ */
+static uint32_t eeprom[EEPROM_WORDS];
+static uint32_t eeprom_writes[EEPROM_WORDS];
+static int torn_after = -1;
+
+uint32_t EEPROMInit(void) { return 0; }
+uint32_t EEPROMSizeGet(void) { return EEPROM_WORDS * 4; }
+
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    memcpy(pui32Data, &eeprom[ui32Address / 4], ui32Count);
+}
+
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t i;
+
+    for (i = 0; i < ui32Count / 4; i++)
+    {
+        if ((int) i == torn_after)
+        {
+            eeprom[ui32Address / 4 + i] ^= 0x5A5A5A5A; // the word being written is garbage
+            eeprom_writes[ui32Address / 4 + i]++;
+            return 0; // the firmware never learns of it: it lost power
+        }
+        eeprom[ui32Address / 4 + i] = pui32Data[i];
+        eeprom_writes[ui32Address / 4 + i]++;
+    }
+    return 0;
+}
+
+/*
+ * Power up: find the stored settings, as the firmware does at boot
+ */
+static bool PowerUp(Settings *settings, uint32_t *reads)
+{
+    uint32_t before = SettingsInitReads();
+    bool found = SettingsInit(settings);
+
+    *reads = SettingsInitReads() - before;
+    return found;
+}
+
+int main(void)
+{
+    static Settings expected;
+    Settings settings, restored;
+    uint32_t seed = 0x2545F491, reads, max_reads = 0, torn = 0, i, min_writes, max_writes, words = 0;
+    uint64_t total_writes = 0;
+    bool found;
+
+    EventSchedulerInit();
+
+    found = PowerUp(&restored, &reads);
+    CHECK(!found, "settings found in an erased EEPROM");
+
+    for (i = 0; i < CHANGES; i++)
+    {
+        uint32_t r = BenchRandom(&seed);
+
+        settings.pattern = r % 9;
+        settings.pitch = 2 * ((r >> 8) % 3);
+        settings.bpm = 50 + (r >> 16) % 101;
+        if (memcmp(&settings, &expected, sizeof(settings)) == 0)
+            settings.bpm ^= 1;
+
+        // A power loss in the middle of this write leaves the previous settings
+        torn_after = BenchRandom(&seed) % TORN_ODDS == 0 ? (int) (r >> 24) % 4 : -1;
+        SettingsUpdate(&settings);
+        wear_now += SETTINGS_WRITE_DELAY;
+        EventExecute();
+        if (torn_after < 0)
+            expected = settings;
+        else
+            torn++;
+        torn_after = -1;
+
+        found = PowerUp(&restored, &reads);
+        CHECK(found && memcmp(&restored, &expected, sizeof(restored)) == 0,
+              "write %u: power-up restored %u/%u/%u, expected %u/%u/%u", i, restored.pattern, restored.pitch,
+              restored.bpm, expected.pattern, expected.pitch, expected.bpm);
+        if (reads > max_reads)
+            max_reads = reads;
+        if (failures > 10)
+            return 1;
+    }
+    CHECK(max_reads <= MAX_INIT_READS, "a power-up read %u words", max_reads);
+
+    min_writes = UINT32_MAX;
+    max_writes = 0;
+    for (i = 0; i < EEPROM_WORDS; i++)
+    {
+        if (eeprom_writes[i] == 0)
+            continue;
+        words++;
+        total_writes += eeprom_writes[i];
+        if (eeprom_writes[i] < min_writes)
+            min_writes = eeprom_writes[i];
+        if (eeprom_writes[i] > max_writes)
+            max_writes = eeprom_writes[i];
+    }
+    // A write cut short is written again into the same slot, so the first words of a slot
+    // wear a little faster than the rest
+    CHECK(max_writes <= WEAR_SPREAD * total_writes / words, "the writes per word range from %u to %u", min_writes,
+          max_writes);
+
+    printf("Settings: %u writes, %u cut short, each power-up restored the last complete one in at most %u reads\n",
+           CHANGES, torn, max_reads);
+    printf("  wear: %u words written %u to %u times each (%.1f on average); one record in place: %u times\n",
+           words, min_writes, max_writes, (double) total_writes / words, CHANGES);
+    printf("  lifetime at %u writes per word: %.1f million settings writes, against %.1f million\n", ENDURANCE,
+           (double) ENDURANCE * CHANGES / max_writes / 1e6, ENDURANCE / 1e6);
+
+    return failures ? 1 : 0;
+}
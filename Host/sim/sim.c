@@ -0,0 +1,535 @@
+/*
+ * sim.c: Virtual time, interrupts and stimuli of the host-side LaunchPad simulation
+ *
+ * ----------------------------
+ *  Created on: Dec 4, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_gpio.h>
+#include <driverlib/gpio.h>
+#include "sim.h"
+
+#define MAX_STIMULI     256
+#define MAX_TRACE       65536
+#define MAX_UART        65536
+#define REGISTER_SLOTS  1024
+
+/*
+ * Virtual time
+ */
+static uint64_t now = 0;            // current virtual time in cycles
+static uint64_t end_time = 0;       // SimRun() returns when this time is reached
+static uint64_t busy_cycles = 0;
+static uint64_t idle_cycles = 0;
+static uint64_t isr_cycles = 0;     // exception entry and exit, and busy-waits in ISRs
+static uint32_t wakeup_count = 0;
+static jmp_buf run_exit;
+
+/*
+ * Interrupts. There is no priority model: pending interrupts run in the order of their
+ * number, and an ISR is never interrupted by another one. Like the firmware code, an ISR takes
+ * no time by itself, but every one is charged the exception entry and exit of the Cortex-M4
+ * (12 cycles each, without floating-point state) on top of the time it busy-waits. The charge
+ * does not move the virtual time, so that the interrupts keep their exact times.
+ */
+#define ISR_ENTRY_EXIT  24
+
+static void (*handlers[NUM_INTERRUPTS])(void);
+static bool pending[NUM_INTERRUPTS];
+static uint32_t delivered_count[NUM_INTERRUPTS];
+static uint64_t interrupt_cycles[NUM_INTERRUPTS];
+static bool in_isr = false;
+static uint32_t active;             // the running ISR's number, while in_isr
+static bool masked = false;         // PRIMASK: CPUcpsid() holds every interrupt pending
+
+/*
+ * Stimuli, sorted by time
+ */
+typedef enum
+{
+    STIMULUS_BUTTON_DOWN,
+    STIMULUS_BUTTON_UP,
+    STIMULUS_KNOB,
+    STIMULUS_UART_RX,
+} StimulusType;
+
+typedef struct
+{
+    uint64_t time;
+    StimulusType type;
+    uint32_t value;
+} Stimulus;
+
+static Stimulus stimuli[MAX_STIMULI];
+static int stimulus_count = 0;
+static int next_stimulus = 0;
+
+// Stimuli that land just before the CPU goes to sleep, by time; see SimPressButtonBeforeSleep()
+static Stimulus late_stimuli[MAX_STIMULI];
+static int late_count = 0;
+static int next_late = 0;
+static uint64_t button_bounce = 0;  // contact bounce of the push buttons, in cycles
+
+/*
+ * Trace and UART output
+ */
+static SimTrace trace[MAX_TRACE];
+static int trace_count = 0;
+static char uart_output[MAX_UART + 1];
+static int uart_count = 0;
+
+/*
+ * Sparse register file behind HWREG(); see sim/inc/hw_types.h
+ */
+static struct
+{
+    uint32_t addr;
+    bool used;
+    volatile uint32_t value;
+} registers[REGISTER_SLOTS];
+
+// The DWT cycle counter (see launchpad.h) reads as the virtual time; writes to it are ignored
+#define DWT_CYCCNT      0xE0001004
+
+// The NVIC interrupt control register, whose VECTACTIVE field holds the running ISR's number
+#define NVIC_INT_CTRL   0xE000ED04
+
+/*
+ * The GPIO data registers (GPIO_O_DATA, where address bits 9:2 mask the pins) read as the pin
+ * levels. The value written to one reaches the pins through GPIOPinWrite() at the next register
+ * access, driverlib GPIO call, time advance or ISR return, whichever comes first.
+ */
+static volatile uint32_t gpio_data;
+static uint32_t gpio_data_addr;     // the data register last accessed, 0 once flushed
+
+static bool GpioData(uint32_t addr)
+{
+    static const uint32_t bases[] = {GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+                                     GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE};
+    int i;
+
+    for (i = 0; i < sizeof(bases) / sizeof(bases[0]); i++)
+        if (addr >= bases[i] + GPIO_O_DATA && addr <= bases[i] + GPIO_O_DATA + 0x3FC)
+            return true;
+    return false;
+}
+
+void SimRegisterFlush()
+{
+    uint32_t addr = gpio_data_addr;
+
+    if (addr != 0)
+    {
+        gpio_data_addr = 0;
+        GPIOPinWrite(addr & ~0xFFF, (addr >> 2) & 0xFF, gpio_data);
+    }
+}
+
+volatile uint32_t *SimRegister(uint32_t addr)
+{
+    static volatile uint32_t cycle_count;
+    uint32_t i = (addr >> 2) % REGISTER_SLOTS;
+
+    SimRegisterFlush();
+
+    if (addr == DWT_CYCCNT)
+    {
+        cycle_count = (uint32_t) now;
+        return &cycle_count;
+    }
+
+    if (GpioData(addr))
+    {
+        gpio_data = GPIOPinRead(addr & ~0xFFF, (addr >> 2) & 0xFF);
+        gpio_data_addr = addr;
+        return &gpio_data;
+    }
+
+    while (registers[i].used && registers[i].addr != addr)
+        i = (i + 1) % REGISTER_SLOTS;
+
+    if (!registers[i].used)
+    {
+        registers[i].used = true;
+        registers[i].addr = addr;
+        registers[i].value = 0;
+    }
+
+    return &registers[i].value;
+}
+
+/*
+ * Interrupt handling
+ */
+void SimIntRegister(uint32_t interrupt, void (*handler)(void))
+{
+    handlers[interrupt] = handler;
+}
+
+void SimIntPend(uint32_t interrupt)
+{
+    if (handlers[interrupt] != NULL)
+        pending[interrupt] = true;
+}
+
+void SimIntUnpend(uint32_t interrupt)
+{
+    pending[interrupt] = false;
+}
+
+// Run the pending ISRs; return true if any ran
+static bool DeliverInterrupts()
+{
+    bool delivered = false;
+    uint32_t i;
+
+    if (in_isr || masked)
+        return false;
+
+    in_isr = true;
+    for (i = 0; i < NUM_INTERRUPTS; i++)
+    {
+        if (pending[i])
+        {
+            pending[i] = false;
+            delivered_count[i]++;
+            active = i;
+            *SimRegister(NVIC_INT_CTRL) = i;
+            handlers[i]();
+            *SimRegister(NVIC_INT_CTRL) = 0;
+            SimRegisterFlush();
+            isr_cycles += ISR_ENTRY_EXIT;
+            interrupt_cycles[i] += ISR_ENTRY_EXIT;
+            delivered = true;
+            i = (uint32_t) -1; // an ISR may pend a lower-numbered interrupt
+        }
+    }
+    in_isr = false;
+
+    return delivered;
+}
+
+static bool AnyPending()
+{
+    uint32_t i;
+    for (i = 0; i < NUM_INTERRUPTS; i++)
+        if (pending[i])
+            return true;
+    return false;
+}
+
+/*
+ * Stimuli
+ */
+static void InsertStimulus(Stimulus list[], int *count, uint64_t time, StimulusType type, uint32_t value)
+{
+    int i;
+
+    if (*count == MAX_STIMULI)
+    {
+        fprintf(stderr, "sim: too many stimuli\n");
+        exit(2);
+    }
+
+    // Insertion sort, stable for equal times
+    for (i = *count; i > 0 && list[i - 1].time > time; i--)
+        list[i] = list[i - 1];
+    list[i].time = time;
+    list[i].type = type;
+    list[i].value = value;
+    (*count)++;
+}
+
+static void AddStimulus(uint64_t time, StimulusType type, uint32_t value)
+{
+    InsertStimulus(stimuli, &stimulus_count, time, type, value);
+}
+
+// With bounce, the contact makes, breaks and makes again before it stays, and the same on release
+void SimPressButton(uint64_t time, int button, uint64_t duration)
+{
+    AddStimulus(time, STIMULUS_BUTTON_DOWN, button);
+    AddStimulus(time + duration, STIMULUS_BUTTON_UP, button);
+    if (button_bounce > 0)
+    {
+        AddStimulus(time + button_bounce / 3, STIMULUS_BUTTON_UP, button);
+        AddStimulus(time + button_bounce, STIMULUS_BUTTON_DOWN, button);
+        AddStimulus(time + duration + button_bounce / 3, STIMULUS_BUTTON_DOWN, button);
+        AddStimulus(time + duration + button_bounce, STIMULUS_BUTTON_UP, button);
+    }
+}
+
+void SimPressButtonBeforeSleep(uint64_t time, int button, uint64_t duration)
+{
+    InsertStimulus(late_stimuli, &late_count, time, STIMULUS_BUTTON_DOWN, button);
+    AddStimulus(time + duration, STIMULUS_BUTTON_UP, button);
+}
+
+void SimSetButtonBounce(uint64_t duration)
+{
+    button_bounce = duration;
+}
+
+void SimSetKnob(uint64_t time, uint32_t adc_value)
+{
+    AddStimulus(time, STIMULUS_KNOB, adc_value);
+}
+
+void SimUartReceive(uint64_t time, char ch)
+{
+    AddStimulus(time, STIMULUS_UART_RX, (unsigned char) ch);
+}
+
+// SW1 is on PF4 and SW2 on PF0; both are active low
+static void ApplyStimulus(const Stimulus *stimulus)
+{
+    uint8_t pin = (stimulus->value == 1) ? GPIO_PIN_4 : GPIO_PIN_0;
+
+    switch (stimulus->type)
+    {
+    case STIMULUS_BUTTON_DOWN:
+        SimGpioSetInput(GPIO_PORTF_BASE, pin, false);
+        break;
+    case STIMULUS_BUTTON_UP:
+        SimGpioSetInput(GPIO_PORTF_BASE, pin, true);
+        break;
+    case STIMULUS_KNOB:
+        SimAdcSetInput(stimulus->value);
+        break;
+    case STIMULUS_UART_RX:
+        SimUartReceiveChar((char) stimulus->value);
+        break;
+    }
+}
+
+/*
+ * Time advance
+ */
+
+// The earliest future time something happens by itself
+static uint64_t NextOccurrence()
+{
+    uint64_t next = SimPeripheralNextTime();
+
+    if (next_stimulus < stimulus_count && stimuli[next_stimulus].time < next)
+        next = stimuli[next_stimulus].time;
+
+    return next;
+}
+
+// Move the virtual time forward to the given time, raising the interrupts on the way
+static void AdvanceTo(uint64_t time, bool busy)
+{
+    if (time > end_time)
+        time = end_time;
+    if (time < now)
+        time = now;
+
+    SimRegisterFlush();
+
+    if (in_isr)
+    {
+        isr_cycles += time - now;
+        interrupt_cycles[active] += time - now;
+    }
+    else if (busy)
+        busy_cycles += time - now;
+    else
+        idle_cycles += time - now;
+    now = time;
+
+    while (next_stimulus < stimulus_count && stimuli[next_stimulus].time <= now)
+        ApplyStimulus(&stimuli[next_stimulus++]);
+    SimPeripheralUpdate();
+
+    if (now >= end_time)
+        longjmp(run_exit, 1);
+}
+
+void SimBusyWait(uint64_t cycles)
+{
+    uint64_t target = now + cycles;
+
+    // Stop at every occurrence on the way, so that ISRs run at the right time
+    while (true)
+    {
+        uint64_t next = NextOccurrence();
+        if (next > target)
+            break;
+        AdvanceTo(next, true);
+        DeliverInterrupts();
+    }
+
+    AdvanceTo(target, true);
+    DeliverInterrupts();
+}
+
+// The late stimuli that are due arrive now, at the last instruction before the CPU masks the
+// interrupts or sleeps, and their ISRs run unless the interrupts are masked already
+static void BeforeSleep()
+{
+    while (next_late < late_count && late_stimuli[next_late].time <= now)
+    {
+        if (late_stimuli[next_late].type == STIMULUS_BUTTON_DOWN)
+            SimTraceAdd(SIM_TRACE_PRESS_BEFORE_SLEEP, late_stimuli[next_late].value, 0, 0, 0);
+        ApplyStimulus(&late_stimuli[next_late++]);
+    }
+    DeliverInterrupts();
+}
+
+void SimSleep()
+{
+    BeforeSleep();
+
+    // A pending interrupt wakes up the CPU right away, even with the interrupts masked; it
+    // then runs once they are unmasked
+    while (!AnyPending())
+    {
+        uint64_t next = NextOccurrence();
+        AdvanceTo(next, false);
+    }
+
+    wakeup_count++;
+    DeliverInterrupts();
+}
+
+bool SimMask(bool mask)
+{
+    bool was_masked = masked;
+
+    if (mask && !was_masked && !in_isr)
+        BeforeSleep();
+    masked = mask;
+    if (!mask)
+        DeliverInterrupts();
+    return was_masked;
+}
+
+/*
+ * Running the firmware
+ */
+void SimRun(void (*entry)(void), uint64_t until)
+{
+    end_time = until;
+
+    // Stimuli at time zero are in place before the firmware starts
+    while (next_stimulus < stimulus_count && stimuli[next_stimulus].time == 0)
+        ApplyStimulus(&stimuli[next_stimulus++]);
+
+    if (setjmp(run_exit) == 0)
+        entry();
+
+    in_isr = false;
+}
+
+uint64_t SimNow()
+{
+    return now;
+}
+
+uint64_t SimBusyCycles()
+{
+    return busy_cycles;
+}
+
+uint64_t SimIdleCycles()
+{
+    return idle_cycles;
+}
+
+uint64_t SimIsrCycles()
+{
+    return isr_cycles;
+}
+
+uint32_t SimWakeupCount()
+{
+    return wakeup_count;
+}
+
+uint32_t SimInterruptCount(uint32_t interrupt)
+{
+    return delivered_count[interrupt];
+}
+
+uint64_t SimInterruptCycles(uint32_t interrupt)
+{
+    return interrupt_cycles[interrupt];
+}
+
+/*
+ * Trace
+ */
+void SimTraceAdd(SimTraceType type, int arg0, int arg1, int arg2, int arg3)
+{
+    if (trace_count == MAX_TRACE)
+        return;
+
+    SimTrace *record = &trace[trace_count++];
+    record->time = now;
+    record->type = type;
+    record->arg[0] = arg0;
+    record->arg[1] = arg1;
+    record->arg[2] = arg2;
+    record->arg[3] = arg3;
+}
+
+int SimTraceCount()
+{
+    return trace_count;
+}
+
+const SimTrace *SimTraceGet(int index)
+{
+    return &trace[index];
+}
+
+void SimUartPutChar(char ch)
+{
+    if (uart_count < MAX_UART)
+        uart_output[uart_count++] = ch;
+}
+
+const char *SimUartOutput()
+{
+    uart_output[uart_count] = '\0';
+    return uart_output;
+}
+
+int SimUartOutputLength()
+{
+    return uart_count;
+}
+
+/*
+ * Recorded firmware calls. The linker redirects the calls between object files to these
+ * wrappers (-Wl,--wrap), which record the call and then run the real function.
+ */
+void __real_BuzzerSet(int pitch_index, int volume);
+void __real_Seg7RawUpdate(uint8_t code[]);
+
+void __wrap_BuzzerSet(int pitch_index, int volume)
+{
+    SimTraceAdd(SIM_TRACE_BUZZER, pitch_index, volume, 0, 0);
+    __real_BuzzerSet(pitch_index, volume);
+}
+
+void __wrap_Seg7RawUpdate(uint8_t code[])
+{
+    SimTraceAdd(SIM_TRACE_SEG7, code[0], code[1], code[2], code[3]);
+    __real_Seg7RawUpdate(code);
+}
@@ -0,0 +1,151 @@
+/*
+ * sim.h: Host-side simulation of the LaunchPad for the metronome firmware
+ *
+ * ----------------------------
+ *  Created on: Dec 4, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * The firmware in Program/ and Util/ is compiled unchanged for the host and linked against the
+ * simulated driverlib functions in sim_driverlib.c. Time is virtual: it only advances while the
+ * firmware busy-waits (SysCtlDelay) or sleeps (CPUwfi), and a sleep jumps straight to the next
+ * interrupt, so a simulated minute runs in milliseconds.
+ *
+ * Interrupts are delivered at those two points only, never in the middle of firmware code, and
+ * held pending while CPUcpsid() masks them.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Simulated system clock; one cycle is also one event tick
+#define SIM_CLOCK_RATE      50000000ULL
+#define SIM_MS(ms)          ((uint64_t)(ms) * (SIM_CLOCK_RATE / 1000))
+#define SIM_US(us)          ((uint64_t)(us) * (SIM_CLOCK_RATE / 1000000))
+
+// Recorded calls of interest to the tests
+typedef enum
+{
+    SIM_TRACE_BUZZER,       // BuzzerSet(arg[0] = pitch_index, arg[1] = volume)
+    SIM_TRACE_SEG7,         // Seg7RawUpdate(arg[0..3] = code[0..3])
+    SIM_TRACE_DISPLAY,      // TM1637 received a frame (arg[0..3] = digits, in code[] order)
+    SIM_TRACE_CLICK,        // the uDMA started feeding the buzzer's PWM (arg[0] = PWM period in
+                            // cycles, arg[1] = peak pulse width in percent, arg[2] = PWM periods,
+                            // arg[3] = the last pulse width written)
+    SIM_TRACE_PRESS_BEFORE_SLEEP, // a press of SimPressButtonBeforeSleep() landed (arg[0] = button)
+} SimTraceType;
+
+typedef struct
+{
+    uint64_t time;          // virtual time of the call, in cycles
+    SimTraceType type;
+    int arg[4];
+} SimTrace;
+
+/*
+ * Running the firmware
+ */
+
+// Run the firmware entry point until the given virtual time. Returns when the time is reached.
+void SimRun(void (*entry)(void), uint64_t until);
+
+// Current virtual time, in cycles
+uint64_t SimNow();
+
+// Cycles spent busy-waiting outside ISRs and sleeping, cycles charged to ISRs (exception entry
+// and exit, and their busy-waits), and the number of wakeups from CPUwfi()
+uint64_t SimBusyCycles();
+uint64_t SimIdleCycles();
+uint64_t SimIsrCycles();
+uint32_t SimWakeupCount();
+
+// Number of times the handler of an interrupt ran, and the cycles charged to it
+uint32_t SimInterruptCount(uint32_t interrupt);
+uint64_t SimInterruptCycles(uint32_t interrupt);
+
+// Bytes clocked into the TM1637 display, ACKed or not
+uint32_t SimDisplayBusBytes();
+
+/*
+ * Stimuli, applied at a given virtual time. Call them before SimRun().
+ */
+
+// Press a push button (1 = SW1, 2 = SW2) for the given duration
+void SimPressButton(uint64_t time, int button, uint64_t duration);
+
+// Press a push button at the first point at or after the given time where the firmware, awake,
+// masks the interrupts or goes to sleep: the press lands after the firmware last looked for
+// work. A sleep that lasts past the time delays it until the firmware is about to sleep again.
+void SimPressButtonBeforeSleep(uint64_t time, int button, uint64_t duration);
+
+// Make the contacts of the later presses bounce for the given time after each edge
+void SimSetButtonBounce(uint64_t duration);
+
+// Turn the rotary angle sensor; adc_value is the ADC reading in [0, 4095]
+void SimSetKnob(uint64_t time, uint32_t adc_value);
+
+// Add uniform noise of the given amplitude, in ADC counts, to every conversion of the knob
+void SimSetKnobNoise(uint32_t amplitude);
+
+// Send a character to UART0
+void SimUartReceive(uint64_t time, char ch);
+
+// EEPROM contents. Copy them out after a run, and load them before the next one to power up
+// with them; the EEPROM is erased otherwise.
+#define SIM_EEPROM_WORDS    512
+const uint32_t *SimEepromImage();
+void SimEepromLoad(const uint32_t *image);
+
+// Words programmed into the EEPROM
+uint32_t SimEepromWrites();
+
+/*
+ * Trace of recorded calls and UART output
+ */
+int SimTraceCount();
+const SimTrace *SimTraceGet(int index);
+void SimTraceAdd(SimTraceType type, int arg0, int arg1, int arg2, int arg3);
+const char *SimUartOutput();
+int SimUartOutputLength();          // the output may hold binary trace records
+
+/*
+ * Interface between the simulator core (sim.c) and the simulated peripherals (sim_driverlib.c)
+ */
+
+// Interrupt handlers and pending interrupts, by interrupt number
+void SimIntRegister(uint32_t interrupt, void (*handler)(void));
+void SimIntPend(uint32_t interrupt);
+void SimIntUnpend(uint32_t interrupt);
+
+// Pass a write to a GPIO data register through HWREG() on to the pins; see SimRegister()
+void SimRegisterFlush();
+
+// Spend the given number of cycles busy-waiting
+void SimBusyWait(uint64_t cycles);
+
+// Sleep until the next interrupt
+void SimSleep();
+
+// Set or clear PRIMASK, as CPUcpsid() and CPUcpsie() do; returns whether it was set. The
+// interrupts that pend while it is set run once it is cleared.
+bool SimMask(bool mask);
+
+// Peripheral hooks: the earliest future time a peripheral raises an interrupt by itself
+// (UINT64_MAX for none), and the update that raises the interrupts due at the current time
+uint64_t SimPeripheralNextTime();
+void SimPeripheralUpdate();
+
+// Apply a stimulus to the simulated pins
+void SimGpioSetInput(uint32_t port_base, uint8_t pins, bool high);
+void SimAdcSetInput(uint32_t value);
+void SimUartPutChar(char ch);
+void SimUartReceiveChar(char ch);
+
+#endif /* SIM_H_ */
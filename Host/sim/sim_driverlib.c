@@ -0,0 +1,1462 @@
+/*
+ * sim_driverlib.c: Simulated driverlib functions for the host build of the metronome
+ *
+ * ----------------------------
+ *  Created on: Dec 4, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Only the functions and peripherals used by the firmware are simulated: SysCtl, SysTick, the
+ * NVIC, GPIO, ADC0, the uDMA, the general-purpose timers, UART0 and the EEPROM, plus the TM1637 display on
+ * the GPIO bus. Configuration calls that have no visible effect in the simulation are accepted and ignored.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_types.h>
+#include <inc/hw_timer.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/systick.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/cpu.h>
+#include <driverlib/gpio.h>
+#include <driverlib/adc.h>
+#include <driverlib/timer.h>
+#include <driverlib/uart.h>
+#include <driverlib/udma.h>
+#include <driverlib/eeprom.h>
+#include "sim.h"
+
+#define NUM_PORTS   6
+#define NUM_TIMERS  12
+#define NUM_DMA_CHANNELS 32
+
+/*
+ * SysCtl
+ */
+void SysCtlClockSet(uint32_t ui32Config)
+{
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    return SIM_CLOCK_RATE;
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+/*
+ * Clock gating in sleep mode is only modelled for the timers: with gating on, a timer
+ * that is not enabled in sleep mode counts the busy cycles only (see TimerClock()).
+ */
+static bool clock_gating = false;
+static void TimerSleepClock(uint32_t peripheral, bool enabled);
+
+void SysCtlPeripheralClockGating(bool bEnable)
+{
+    clock_gating = bEnable;
+}
+
+void SysCtlPeripheralSleepEnable(uint32_t ui32Peripheral)
+{
+    TimerSleepClock(ui32Peripheral, true);
+}
+
+void SysCtlPeripheralSleepDisable(uint32_t ui32Peripheral)
+{
+    TimerSleepClock(ui32Peripheral, false);
+}
+
+// SysCtlDelay() loops three cycles per count
+void SysCtlDelay(uint32_t ui32Count)
+{
+    SimBusyWait((uint64_t) ui32Count * 3);
+}
+
+/*
+ * CPU and NVIC
+ */
+void CPUwfi(void)
+{
+    SimSleep();
+}
+
+uint32_t CPUcpsid(void)
+{
+    return SimMask(true);
+}
+
+uint32_t CPUcpsie(void)
+{
+    return SimMask(false);
+}
+
+void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    SimIntRegister(ui32Interrupt, pfnHandler);
+}
+
+void IntPendSet(uint32_t ui32Interrupt)
+{
+    SimIntPend(ui32Interrupt);
+}
+
+void IntPendClear(uint32_t ui32Interrupt)
+{
+    SimIntUnpend(ui32Interrupt);
+}
+
+// Priorities are only kept for IntPriorityGet(); delivery ignores them (see sim.c)
+static uint8_t priorities[NUM_INTERRUPTS];
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    priorities[ui32Interrupt] = ui8Priority;
+}
+
+int32_t IntPriorityGet(uint32_t ui32Interrupt)
+{
+    return priorities[ui32Interrupt];
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+}
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+}
+
+// Firmware code is never interrupted, so interrupts always read as enabled
+bool IntMasterEnable(void)
+{
+    return false;
+}
+
+bool IntMasterDisable(void)
+{
+    return false;
+}
+
+/*
+ * SysTick: a periodic interrupt every (period + 1) cycles once enabled
+ */
+static struct
+{
+    uint32_t period;
+    bool enabled;
+    bool int_enabled;
+    uint64_t next;
+} systick;
+
+void SysTickPeriodSet(uint32_t ui32Period)
+{
+    systick.period = ui32Period;
+}
+
+void SysTickIntRegister(void (*pfnHandler)(void))
+{
+    SimIntRegister(FAULT_SYSTICK, pfnHandler);
+}
+
+void SysTickIntEnable(void)
+{
+    systick.int_enabled = true;
+}
+
+void SysTickEnable(void)
+{
+    systick.enabled = true;
+    systick.next = SimNow() + systick.period + 1;
+}
+
+/*
+ * GPIO: input levels come from the stimuli, output levels are only stored. The data register
+ * is also reachable through HWREG(), see SimRegister().
+ */
+typedef struct
+{
+    uint32_t base;
+    uint32_t interrupt;
+    uint8_t level;          // current pin levels
+    uint8_t dir_in;         // pins configured as inputs by GPIODirModeSet()
+    uint8_t int_type_rising;
+    uint8_t int_type_falling;
+    uint8_t int_mask;
+    uint8_t int_status;
+} SimPort;
+
+static SimPort ports[NUM_PORTS] = {
+    {GPIO_PORTA_BASE, INT_GPIOA, 0xFF},
+    {GPIO_PORTB_BASE, INT_GPIOB, 0xFF},
+    {GPIO_PORTC_BASE, INT_GPIOC, 0xFF},
+    {GPIO_PORTD_BASE, INT_GPIOD, 0xFF},
+    {GPIO_PORTE_BASE, INT_GPIOE, 0xFF},
+    {GPIO_PORTF_BASE, INT_GPIOF, 0xFF},
+};
+
+static SimPort *Port(uint32_t base)
+{
+    int i;
+    for (i = 0; i < NUM_PORTS; i++)
+        if (ports[i].base == base)
+            return &ports[i];
+    return &ports[0];
+}
+
+void SimGpioSetInput(uint32_t port_base, uint8_t pins, bool high)
+{
+    SimPort *port = Port(port_base);
+    uint8_t old_level = port->level;
+    uint8_t new_level = high ? (old_level | pins) : (old_level & ~pins);
+    uint8_t rising = ~old_level & new_level;
+    uint8_t falling = old_level & ~new_level;
+
+    port->level = new_level;
+    port->int_status |= (rising & port->int_type_rising) | (falling & port->int_type_falling);
+    if (port->int_status & port->int_mask)
+        SimIntPend(port->interrupt);
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength, uint32_t ui32PadType)
+{
+}
+
+/*
+ * TM1637 on PA6 (CLK) and PA7 (DIO). The decoder follows the bus like the chip does: START and
+ * STOP are DIO edges while CLK is high, data bits are sampled LSB first on the rising CLK edges,
+ * and the ninth clock of a byte is the ACK. A released DIO reads as high (pull-up).
+ */
+#define TM_CLK      GPIO_PIN_6
+#define TM_DIO      GPIO_PIN_7
+
+static struct
+{
+    bool clk, dio;
+    bool in_frame;
+    int bit;                // bit number within the current byte, 8 for the ACK
+    int byte;               // byte number within the current frame
+    uint8_t shift;
+    bool auto_increment;
+    uint8_t address;
+    bool changed;           // the current frame wrote to the grid
+    uint8_t grid[6];
+    uint32_t bus_bytes;
+} tm1637 = {true, true};
+
+static void Tm1637Byte(uint8_t value)
+{
+    tm1637.bus_bytes++;
+
+    if (tm1637.byte++ == 0)
+    {
+        if ((value & 0xC0) == 0x40)
+            tm1637.auto_increment = !(value & 0x04);
+        else if ((value & 0xC0) == 0xC0)
+            tm1637.address = value & 0x07;
+        return;
+    }
+
+    // Data byte after an address command
+    if (tm1637.address < 6)
+        tm1637.grid[tm1637.address] = value;
+    if (tm1637.auto_increment)
+        tm1637.address++;
+    tm1637.changed = true;
+}
+
+static void Tm1637Pins(SimPort *port)
+{
+    bool clk = (port->level & TM_CLK) || (port->dir_in & TM_CLK);
+    bool dio = (port->level & TM_DIO) || (port->dir_in & TM_DIO);
+
+    if (clk && tm1637.clk && dio != tm1637.dio)
+    {
+        if (!dio)
+        {
+            // START
+            tm1637.in_frame = true;
+            tm1637.bit = 0;
+            tm1637.byte = 0;
+            tm1637.changed = false;
+        }
+        else if (tm1637.in_frame)
+        {
+            // STOP; grid 0 is the leftmost digit, which is code[3] for Seg7RawUpdate()
+            tm1637.in_frame = false;
+            if (tm1637.changed)
+                SimTraceAdd(SIM_TRACE_DISPLAY, tm1637.grid[3], tm1637.grid[2], tm1637.grid[1],
+                            tm1637.grid[0]);
+        }
+    }
+    else if (clk && !tm1637.clk && tm1637.in_frame)
+    {
+        if (tm1637.bit < 8)
+        {
+            tm1637.shift = (tm1637.shift >> 1) | (dio ? 0x80 : 0);
+            tm1637.bit++;
+        }
+        else
+        {
+            Tm1637Byte(tm1637.shift);
+            tm1637.bit = 0;
+        }
+    }
+
+    tm1637.clk = clk;
+    tm1637.dio = dio;
+}
+
+uint32_t SimDisplayBusBytes()
+{
+    return tm1637.bus_bytes;
+}
+
+void GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO)
+{
+    SimPort *port = Port(ui32Port);
+
+    SimRegisterFlush();
+    if (ui32PinIO == GPIO_DIR_MODE_IN)
+        port->dir_in |= ui8Pins;
+    else
+        port->dir_in &= ~ui8Pins;
+
+    if (ui32Port == GPIO_PORTA_BASE)
+        Tm1637Pins(port);
+}
+
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeTimer(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    SimRegisterFlush();
+    return Port(ui32Port)->level & ui8Pins;
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    SimPort *port = Port(ui32Port);
+
+    SimRegisterFlush();
+    port->level = (port->level & ~ui8Pins) | (ui8Val & ui8Pins);
+
+    if (ui32Port == GPIO_PORTA_BASE)
+        Tm1637Pins(port);
+}
+
+void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void))
+{
+    SimIntRegister(Port(ui32Port)->interrupt, pfnIntHandler);
+}
+
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+    SimPort *port = Port(ui32Port);
+
+    port->int_type_rising &= ~ui8Pins;
+    port->int_type_falling &= ~ui8Pins;
+    if (ui32IntType == GPIO_RISING_EDGE || ui32IntType == GPIO_BOTH_EDGES)
+        port->int_type_rising |= ui8Pins;
+    if (ui32IntType == GPIO_FALLING_EDGE || ui32IntType == GPIO_BOTH_EDGES)
+        port->int_type_falling |= ui8Pins;
+}
+
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    SimPort *port = Port(ui32Port);
+
+    // An edge latched while the interrupt was off interrupts at once
+    port->int_mask |= ui32IntFlags;
+    if (port->int_status & port->int_mask)
+        SimIntPend(port->interrupt);
+}
+
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    Port(ui32Port)->int_mask &= ~ui32IntFlags;
+}
+
+uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked)
+{
+    SimPort *port = Port(ui32Port);
+    return bMasked ? (port->int_status & port->int_mask) : port->int_status;
+}
+
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    Port(ui32Port)->int_status &= ~ui32IntFlags;
+}
+
+/*
+ * uDMA: channels with a primary and an alternate control structure, in basic, auto and
+ * ping-pong modes. A peripheral moves one item at a time with DmaPeripheralWrite() or
+ * DmaPeripheralRead(); the control table in the firmware's memory is not used.
+ */
+typedef struct
+{
+    uint32_t control;       // size and increments, from uDMAChannelControlSet()
+    uint32_t mode;          // UDMA_MODE_STOP once the transfer is complete
+    uint8_t *src;
+    uint8_t *dst;
+    uint32_t size;          // items in the transfer
+    uint32_t remaining;     // items left in the transfer
+} SimDmaStructure;
+
+static struct
+{
+    bool enabled;
+    struct
+    {
+        bool enabled;
+        uint32_t assignment; // peripheral encoding of the channel, from uDMAChannelAssign()
+        int active;         // 0 for the primary structure, 1 for the alternate
+        SimDmaStructure structure[2];
+    } channel[NUM_DMA_CHANNELS];
+} dma;
+
+static SimDmaStructure *DmaStructure(uint32_t index)
+{
+    return &dma.channel[index & 0x1F].structure[(index & UDMA_ALT_SELECT) ? 1 : 0];
+}
+
+// Results of DmaPeripheralWrite() and DmaPeripheralRead()
+#define DMA_NOT_TAKEN   -1  // the channel is off; the item stays with the peripheral
+#define DMA_TAKEN       0
+#define DMA_DONE        1   // the item completed a transfer; the peripheral raises its interrupt
+
+// Whether the given channel has a transfer to run
+static bool DmaChannelReady(uint32_t channel_number)
+{
+    typeof(dma.channel[0]) *channel = &dma.channel[channel_number];
+
+    return dma.enabled && channel->enabled &&
+           channel->structure[channel->active].mode != UDMA_MODE_STOP;
+}
+
+// Item size of a control word, in bytes
+static uint32_t DmaItemSize(uint32_t control)
+{
+    return 1 << ((control & 0x03000000) >> 24);
+}
+
+// Count a moved item, and complete the transfer after its last one
+static int DmaItemMoved(uint32_t channel_number)
+{
+    typeof(dma.channel[0]) *channel = &dma.channel[channel_number];
+    SimDmaStructure *structure = &channel->structure[channel->active];
+
+    if (--structure->remaining > 0)
+        return DMA_TAKEN;
+
+    // Ping-pong continues with the other structure, unless that one is complete too
+    if (structure->mode == UDMA_MODE_PINGPONG)
+    {
+        channel->active ^= 1;
+        if (channel->structure[channel->active].mode == UDMA_MODE_STOP)
+            channel->enabled = false;
+    }
+    else
+    {
+        channel->enabled = false;
+    }
+    structure->mode = UDMA_MODE_STOP;
+
+    return DMA_DONE;
+}
+
+// Move an item from a peripheral to memory over the given channel
+static int DmaPeripheralWrite(uint32_t channel_number, uint32_t value)
+{
+    typeof(dma.channel[0]) *channel = &dma.channel[channel_number];
+    SimDmaStructure *structure = &channel->structure[channel->active];
+    uint32_t size = DmaItemSize(structure->control);
+
+    if (!DmaChannelReady(channel_number))
+        return DMA_NOT_TAKEN;
+
+    if (size == 1)
+        *structure->dst = value;
+    else if (size == 2)
+        *(uint16_t *) structure->dst = value;
+    else
+        *(uint32_t *) structure->dst = value;
+    if ((structure->control & 0xC0000000) != UDMA_DST_INC_NONE)
+        structure->dst += size;
+
+    return DmaItemMoved(channel_number);
+}
+
+// Move an item from memory to a peripheral over the given channel
+static int DmaPeripheralRead(uint32_t channel_number, uint32_t *value)
+{
+    typeof(dma.channel[0]) *channel = &dma.channel[channel_number];
+    SimDmaStructure *structure = &channel->structure[channel->active];
+    uint32_t size = DmaItemSize(structure->control);
+
+    if (!DmaChannelReady(channel_number))
+        return DMA_NOT_TAKEN;
+
+    if (size == 1)
+        *value = *structure->src;
+    else if (size == 2)
+        *value = *(uint16_t *) structure->src;
+    else
+        *value = *(uint32_t *) structure->src;
+    if ((structure->control & 0x0C000000) != UDMA_SRC_INC_NONE)
+        structure->src += size;
+
+    return DmaItemMoved(channel_number);
+}
+
+void uDMAEnable(void)
+{
+    dma.enabled = true;
+}
+
+void uDMAControlBaseSet(void *pControlTable)
+{
+}
+
+void uDMAIntRegister(uint32_t ui32IntChannel, void (*pfnHandler)(void))
+{
+    SimIntRegister(ui32IntChannel, pfnHandler);
+}
+
+uint32_t uDMAErrorStatusGet(void)
+{
+    return 0;
+}
+
+void uDMAErrorStatusClear(void)
+{
+}
+
+void uDMAChannelAttributeEnable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    if (ui32Attr & UDMA_ATTR_ALTSELECT)
+        dma.channel[ui32ChannelNum].active = 1;
+}
+
+void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    if (ui32Attr & UDMA_ATTR_ALTSELECT)
+        dma.channel[ui32ChannelNum].active = 0;
+}
+
+void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    DmaStructure(ui32ChannelStructIndex)->control = ui32Control;
+}
+
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode, void *pvSrcAddr,
+                            void *pvDstAddr, uint32_t ui32TransferSize)
+{
+    SimDmaStructure *structure = DmaStructure(ui32ChannelStructIndex);
+
+    structure->mode = ui32Mode;
+    structure->src = pvSrcAddr;
+    structure->dst = pvDstAddr;
+    structure->size = structure->remaining = ui32TransferSize;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    return DmaStructure(ui32ChannelStructIndex)->mode;
+}
+
+static void DmaBuzzerStart(uint32_t channel_number);
+
+void uDMAChannelAssign(uint32_t ui32Mapping)
+{
+    dma.channel[ui32Mapping & 0xFF].assignment = ui32Mapping >> 16;
+}
+
+void uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    dma.channel[ui32ChannelNum].enabled = true;
+    DmaBuzzerStart(ui32ChannelNum);
+}
+
+void uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    dma.channel[ui32ChannelNum].enabled = false;
+}
+
+bool uDMAChannelIsEnabled(uint32_t ui32ChannelNum)
+{
+    return dma.channel[ui32ChannelNum].enabled;
+}
+
+/*
+ * ADC0: a trigger completes the conversion of the knob position right away; the interrupt is
+ * delivered at the next point the simulated CPU can take it. The sequencer is started either by
+ * ADCProcessorTrigger() or by a timer time-out, as configured. Every conversion adds uniform noise
+ * of the given amplitude, and hardware oversampling averages that many conversions per sample.
+ * With uDMA enabled for the sequencer, samples go to its uDMA channel, and the interrupt comes
+ * when a transfer is complete.
+ */
+static struct
+{
+    uint32_t input;         // ADC reading of the rotary angle sensor
+    uint32_t noise;         // amplitude of the noise on each conversion
+    uint32_t random;        // state of the noise generator
+    uint32_t trigger;       // ADC_TRIGGER_PROCESSOR or ADC_TRIGGER_TIMER
+    uint32_t oversample;    // conversions averaged per sample
+    uint32_t result;        // converted sample waiting in the FIFO
+    uint32_t sequence;      // the sequencer in use
+    bool int_enabled;
+    bool dma;               // samples go to the uDMA
+} adc = {0, 0, 2463534242u, ADC_TRIGGER_PROCESSOR, 1};
+
+void SimAdcSetInput(uint32_t value)
+{
+    adc.input = value;
+}
+
+void SimSetKnobNoise(uint32_t amplitude)
+{
+    adc.noise = amplitude;
+}
+
+// One conversion of the input, with noise (xorshift32)
+static uint32_t AdcConvert()
+{
+    int32_t value = adc.input;
+
+    if (adc.noise > 0)
+    {
+        adc.random ^= adc.random << 13;
+        adc.random ^= adc.random >> 17;
+        adc.random ^= adc.random << 5;
+        value += (int32_t) (adc.random % (2 * adc.noise + 1)) - (int32_t) adc.noise;
+    }
+
+    return value < 0 ? 0 : value > 4095 ? 4095 : value;
+}
+
+// Take a sample and raise the sequencer interrupt
+static void AdcSample()
+{
+    uint32_t i, sum = 0;
+
+    for (i = 0; i < adc.oversample; i++)
+        sum += AdcConvert();
+    adc.result = sum / adc.oversample;
+
+    // ADC0 sequencers 0-3 are uDMA channels 14-17
+    if (adc.dma && DmaPeripheralWrite(UDMA_CHANNEL_ADC0 + adc.sequence, adc.result) != DMA_DONE)
+        return;
+
+    if (adc.int_enabled)
+        SimIntPend(INT_ADC0SS0 + adc.sequence);
+}
+
+void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Trigger,
+                          uint32_t ui32Priority)
+{
+    adc.sequence = ui32SequenceNum;
+    adc.trigger = ui32Trigger;
+}
+
+void ADCHardwareOversampleConfigure(uint32_t ui32Base, uint32_t ui32Factor)
+{
+    adc.oversample = ui32Factor ? ui32Factor : 1;
+}
+
+void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    adc.dma = true;
+}
+
+void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Step,
+                              uint32_t ui32Config)
+{
+}
+
+void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+}
+
+void ADCIntRegister(uint32_t ui32Base, uint32_t ui32SequenceNum, void (*pfnHandler)(void))
+{
+    SimIntRegister(INT_ADC0SS0 + ui32SequenceNum, pfnHandler);
+}
+
+void ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    adc.int_enabled = true;
+}
+
+void ADCIntClear(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+}
+
+void ADCProcessorTrigger(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    if (adc.trigger == ADC_TRIGGER_PROCESSOR)
+        AdcSample();
+}
+
+int32_t ADCSequenceDataGet(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t *pui32Buffer)
+{
+    *pui32Buffer = adc.result;
+    return 1;
+}
+
+/*
+ * General-purpose timers. Supported modes are periodic and one-shot counting in either
+ * direction, with time-out and match interrupts, PWM (whose settings are only stored), and
+ * edge-time capture. Time-outs and matches are computed from the virtual time the timer was
+ * enabled. With TAILD set, a load written while the timer counts waits for the next time-out.
+ */
+typedef struct
+{
+    uint32_t base;
+    uint32_t interrupt[2];  // timer A and timer B interrupt numbers
+    bool wide;
+    bool enabled[2];
+    uint64_t start[2];      // virtual time when the timer was enabled
+    uint64_t load[2];
+    uint64_t match[2];
+    uint64_t pending_load[2];   // load waiting for the time-out at pending_at (TAILD)
+    uint64_t pending_at[2];     // 0 for none
+    uint64_t capture[2];    // counter value latched by the last capture event
+    uint32_t int_mask;      // GPTMIMR
+    uint32_t int_status;    // GPTMRIS
+    bool adc_trigger[2];    // time-outs trigger the ADC (TimerControlTrigger)
+    uint64_t last_update;   // virtual time of the last SimPeripheralUpdate()
+    bool sleep_clock;       // clocked in sleep mode (SysCtlPeripheralSleepEnable)
+} SimTimer;
+
+static SimTimer timers[NUM_TIMERS] = {
+    {TIMER0_BASE, {INT_TIMER0A, INT_TIMER0B}, false},
+    {TIMER1_BASE, {INT_TIMER1A, INT_TIMER1B}, false},
+    {TIMER2_BASE, {INT_TIMER2A, INT_TIMER2B}, false},
+    {TIMER3_BASE, {INT_TIMER3A, INT_TIMER3B}, false},
+    {TIMER4_BASE, {INT_TIMER4A, INT_TIMER4B}, false},
+    {TIMER5_BASE, {INT_TIMER5A, INT_TIMER5B}, false},
+    {WTIMER0_BASE, {INT_WTIMER0A, INT_WTIMER0B}, true},
+    {WTIMER1_BASE, {INT_WTIMER1A, INT_WTIMER1B}, true},
+    {WTIMER2_BASE, {INT_WTIMER2A, INT_WTIMER2B}, true},
+    {WTIMER3_BASE, {INT_WTIMER3A, INT_WTIMER3B}, true},
+    {WTIMER4_BASE, {INT_WTIMER4A, INT_WTIMER4B}, true},
+    {WTIMER5_BASE, {INT_WTIMER5A, INT_WTIMER5B}, true},
+};
+
+static void TimerSleepClock(uint32_t peripheral, bool enabled)
+{
+    if (peripheral >= SYSCTL_PERIPH_TIMER0 && peripheral <= SYSCTL_PERIPH_TIMER5)
+        timers[peripheral - SYSCTL_PERIPH_TIMER0].sleep_clock = enabled;
+    else if (peripheral >= SYSCTL_PERIPH_WTIMER0 && peripheral <= SYSCTL_PERIPH_WTIMER5)
+        timers[6 + peripheral - SYSCTL_PERIPH_WTIMER0].sleep_clock = enabled;
+}
+
+// Whether a timer stops in sleep mode; such a timer raises no interrupts in the simulation
+static bool TimerGated(SimTimer *timer)
+{
+    return clock_gating && !timer->sleep_clock;
+}
+
+// The time a timer counts: the virtual time, or the busy and ISR cycles for a gated timer
+static uint64_t TimerClock(SimTimer *timer)
+{
+    return TimerGated(timer) ? SimBusyCycles() + SimIsrCycles() : SimNow();
+}
+
+static SimTimer *Timer(uint32_t base)
+{
+    int i;
+    for (i = 0; i < NUM_TIMERS; i++)
+        if (timers[i].base == base)
+            return &timers[i];
+    return &timers[0];
+}
+
+// The mode register of a half; TimerConfigure() writes it, and the firmware may modify it
+static uint32_t TimerMode(SimTimer *timer, int half)
+{
+    return HWREG(timer->base + (half ? TIMER_O_TBMR : TIMER_O_TAMR));
+}
+
+// Interrupt flags of a half: time-out and match
+static uint32_t TimeoutFlag(int half)
+{
+    return half ? TIMER_TIMB_TIMEOUT : TIMER_TIMA_TIMEOUT;
+}
+
+static uint32_t MatchFlag(int half)
+{
+    return half ? TIMER_TIMB_MATCH : TIMER_TIMA_MATCH;
+}
+
+// Whether a half counts on its own, i.e. is enabled in one-shot or periodic mode
+static bool TimerCounting(SimTimer *timer, int half)
+{
+    uint32_t mode = TimerMode(timer, half) & TIMER_TAMR_TAMR_M;
+    bool pwm = TimerMode(timer, half) & TIMER_TAMR_TAAMS;
+    return timer->enabled[half] && !pwm &&
+           (mode == TIMER_TAMR_TAMR_1_SHOT || mode == TIMER_TAMR_TAMR_PERIOD);
+}
+
+// Counter value of a half at the given time
+static uint64_t TimerCount(SimTimer *timer, int half, uint64_t time)
+{
+    uint64_t elapsed = time - timer->start[half];
+    uint64_t span = timer->load[half] + 1;
+    uint64_t count = (span == 0) ? elapsed : elapsed % span; // span is zero for a 64-bit full count
+
+    if (TimerMode(timer, half) & TIMER_TAMR_TACDIR)
+        return count;
+    return timer->load[half] - count;
+}
+
+// The next time strictly after 'after' when the half times out, or hits its match value
+static uint64_t TimerNextTimeout(SimTimer *timer, int half, uint64_t after)
+{
+    uint64_t span = timer->load[half] + 1;
+    uint64_t elapsed = after - timer->start[half];
+
+    if (span == 0)
+        return UINT64_MAX;
+    if ((TimerMode(timer, half) & TIMER_TAMR_TAMR_M) == TIMER_TAMR_TAMR_1_SHOT && elapsed >= span)
+        return UINT64_MAX;
+    return timer->start[half] + (elapsed / span + 1) * span;
+}
+
+static uint64_t TimerNextMatch(SimTimer *timer, int half, uint64_t after)
+{
+    uint64_t span = timer->load[half] + 1;
+    uint64_t offset, first;
+
+    if (TimerMode(timer, half) & TIMER_TAMR_TACDIR)
+        offset = timer->match[half];                        // counting up from zero
+    else
+        offset = timer->load[half] - timer->match[half];    // counting down from the load value
+
+    first = timer->start[half] + offset;
+    if (first > after)
+        return first;
+    if (span == 0 || (TimerMode(timer, half) & TIMER_TAMR_TAMR_M) == TIMER_TAMR_TAMR_1_SHOT)
+        return UINT64_MAX;
+    return first + ((after - first) / span + 1) * span;
+}
+
+// The next interrupt of a timer half after the given time, UINT64_MAX for none
+static uint64_t TimerNextInterrupt(SimTimer *timer, int half, uint64_t after)
+{
+    uint64_t next = UINT64_MAX;
+
+    if (!TimerCounting(timer, half) || TimerGated(timer))
+        return UINT64_MAX;
+
+    if ((timer->int_mask & TimeoutFlag(half)) || timer->adc_trigger[half])
+        next = TimerNextTimeout(timer, half, after);
+
+    if ((timer->int_mask & MatchFlag(half)) && (TimerMode(timer, half) & TIMER_TAMR_TAMIE))
+    {
+        uint64_t match = TimerNextMatch(timer, half, after);
+        if (match < next)
+            next = match;
+    }
+
+    return next;
+}
+
+/*
+ * uDMA requests of the timers. Only wide timer 0 is modelled, on channels 10 (A) and 11 (B)
+ * with encoding 3. A half in PWM mode with its capture event unmasked requests a transfer at
+ * the end of every PWM period, which moves one item into its match register. The buzzer is on
+ * WTIMER0B, so a transfer started there is recorded as a click.
+ */
+#define TIMER_DMA_ASSIGNMENT    3
+
+static int TimerDmaChannel(SimTimer *timer, int half)
+{
+    int channel = 10 + half;
+
+    if (timer->base != WTIMER0_BASE || dma.channel[channel].assignment != TIMER_DMA_ASSIGNMENT)
+        return -1;
+    return channel;
+}
+
+// Whether a half has a uDMA transfer running into its match register
+static bool TimerPwmDma(SimTimer *timer, int half)
+{
+    int channel = TimerDmaChannel(timer, half);
+
+    return channel >= 0 && timer->enabled[half] && (TimerMode(timer, half) & TIMER_TAMR_TAAMS) &&
+           (timer->int_mask & (half ? TIMER_CAPB_EVENT : TIMER_CAPA_EVENT)) && !TimerGated(timer) &&
+           DmaChannelReady(channel);
+}
+
+// Move the items due at the PWM periods that ended in (last_update, now]
+static void TimerPwmDmaUpdate(SimTimer *timer, int half, uint64_t now)
+{
+    uint64_t time = timer->last_update;
+    uint32_t value;
+
+    while (TimerPwmDma(timer, half) && (time = TimerNextTimeout(timer, half, time)) <= now)
+        if (DmaPeripheralRead(TimerDmaChannel(timer, half), &value) != DMA_NOT_TAKEN)
+            timer->match[half] = value;
+}
+
+static void DmaBuzzerStart(uint32_t channel_number)
+{
+    SimTimer *timer = Timer(WTIMER0_BASE);
+    SimDmaStructure *structure;
+    uint32_t i, peak = 0, last = 0, period = timer->load[1] + 1;
+
+    if (TimerDmaChannel(timer, 1) != (int) channel_number || !DmaChannelReady(channel_number))
+        return;
+
+    // The pulse widths as the PWM output has them: match + 1, or 0 for a match past the load
+    structure = &dma.channel[channel_number].structure[dma.channel[channel_number].active];
+    for (i = 0; i < structure->size; i++)
+    {
+        uint32_t match = ((uint32_t *) structure->src)[i];
+        last = match;
+        if (match < period && match + 1 > peak)
+            peak = match + 1;
+    }
+
+    SimTraceAdd(SIM_TRACE_CLICK, period, (200 * peak / period + 1) / 2, structure->size, last);
+}
+
+/*
+ * Edge-time capture. WT0CCP0 (PC4) is taken to be jumpered to the buzzer output WT0CCP1 (PC5).
+ * Only the rising edge that starts a PWM output, at the enable of WTIMER0B with a pulse width,
+ * is modelled: the capture ISR masks the event on the first edge of a click, long before the
+ * next PWM period.
+ */
+static void TimerCaptureEdge(SimTimer *timer, int half)
+{
+    uint32_t mode = TimerMode(timer, half);
+    uint32_t flag = half ? TIMER_CAPB_EVENT : TIMER_CAPA_EVENT;
+
+    if (!timer->enabled[half] || (mode & TIMER_TAMR_TAMR_M) != TIMER_TAMR_TAMR_CAP ||
+        !(mode & TIMER_TAMR_TACMR))
+        return;
+
+    timer->capture[half] = TimerCount(timer, half, TimerClock(timer));
+    timer->int_status |= flag;
+    if (timer->int_mask & flag)
+        SimIntPend(timer->interrupt[half]);
+}
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    timer->enabled[0] = timer->enabled[1] = false;
+    HWREG(ui32Base + TIMER_O_CFG) = ui32Config >> 24;
+    HWREG(ui32Base + TIMER_O_TAMR) = (ui32Config & 0xff) | TIMER_TAMR_TAPWMIE;
+    HWREG(ui32Base + TIMER_O_TBMR) = ((ui32Config >> 8) & 0xff) | TIMER_TBMR_TBPWMIE;
+}
+
+void TimerControlLevel(uint32_t ui32Base, uint32_t ui32Timer, bool bInvert)
+{
+}
+
+void TimerControlEvent(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Event)
+{
+}
+
+void TimerControlTrigger(uint32_t ui32Base, uint32_t ui32Timer, bool bEnable)
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    if (ui32Timer & TIMER_A)
+        timer->adc_trigger[0] = bEnable;
+    if (ui32Timer & TIMER_B)
+        timer->adc_trigger[1] = bEnable;
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimTimer *timer = Timer(ui32Base);
+    int half;
+
+    for (half = 0; half < 2; half++)
+    {
+        if (ui32Timer & (half ? TIMER_B : TIMER_A))
+        {
+            timer->enabled[half] = true;
+            timer->start[half] = TimerClock(timer);
+            timer->pending_at[half] = 0;
+        }
+    }
+    timer->last_update = SimNow();
+
+    // The buzzer's PWM output starts with a pulse
+    if (ui32Base == WTIMER0_BASE && (ui32Timer & TIMER_B) && timer->match[1] <= timer->load[1] &&
+        (TimerMode(timer, 1) & TIMER_TAMR_TAAMS))
+        TimerCaptureEdge(timer, 0);
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    int half;
+
+    for (half = 0; half < 2; half++)
+    {
+        if (ui32Timer & (half ? TIMER_B : TIMER_A))
+        {
+            timer->enabled[half] = false;
+            timer->pending_at[half] = 0;
+        }
+    }
+}
+
+// Write the load of a half: right away, or at the next time-out with TAILD set
+static void TimerLoadWrite(SimTimer *timer, int half, uint64_t value)
+{
+    if (TimerCounting(timer, half) && (TimerMode(timer, half) & TIMER_TAMR_TAILD))
+    {
+        timer->pending_load[half] = value;
+        timer->pending_at[half] = TimerNextTimeout(timer, half, TimerClock(timer));
+    }
+    else
+        timer->load[half] = value;
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    if (ui32Timer & TIMER_A)
+        TimerLoadWrite(timer, 0, ui32Value);
+    if (ui32Timer & TIMER_B)
+        TimerLoadWrite(timer, 1, ui32Value);
+}
+
+void TimerLoadSet64(uint32_t ui32Base, uint64_t ui64Value)
+{
+    TimerLoadWrite(Timer(ui32Base), 0, ui64Value);
+}
+
+void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    if (ui32Timer & TIMER_A)
+        timer->match[0] = ui32Value;
+    if (ui32Timer & TIMER_B)
+        timer->match[1] = ui32Value;
+}
+
+void TimerMatchSet64(uint32_t ui32Base, uint64_t ui64Value)
+{
+    Timer(ui32Base)->match[0] = ui64Value;
+}
+
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimTimer *timer = Timer(ui32Base);
+    int half = (ui32Timer == TIMER_B) ? 1 : 0;
+
+    if (!timer->enabled[half])
+        return 0;
+    if ((TimerMode(timer, half) & TIMER_TAMR_TAMR_M) == TIMER_TAMR_TAMR_CAP)
+        return (uint32_t) timer->capture[half];
+    return (uint32_t) TimerCount(timer, half, TimerClock(timer));
+}
+
+uint64_t TimerValueGet64(uint32_t ui32Base)
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    if (!timer->enabled[0])
+        return 0;
+    return TimerCount(timer, 0, TimerClock(timer));
+}
+
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer, void (*pfnHandler)(void))
+{
+    SimTimer *timer = Timer(ui32Base);
+
+    if (ui32Timer & TIMER_A)
+        SimIntRegister(timer->interrupt[0], pfnHandler);
+    if (ui32Timer & TIMER_B)
+        SimIntRegister(timer->interrupt[1], pfnHandler);
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    Timer(ui32Base)->int_mask |= ui32IntFlags;
+}
+
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    Timer(ui32Base)->int_mask &= ~ui32IntFlags;
+}
+
+uint32_t TimerIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    SimTimer *timer = Timer(ui32Base);
+    return bMasked ? (timer->int_status & timer->int_mask) : timer->int_status;
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    Timer(ui32Base)->int_status &= ~ui32IntFlags;
+}
+
+/*
+ * UART0: transmitted characters are collected by the simulator as they enter the TX FIFO, which
+ * then sends one every 10 bit times. The character in the shift register counts as part of the
+ * FIFO. The TX interrupt comes when the FIFO level drains past the trigger level, and with
+ * UART_DMA_TX the uDMA fills the FIFO whenever it has room. UARTCharPut() on a full FIFO
+ * busy-waits like the real one. A received character raises the receive timeout interrupt
+ * (UART_INT_RT) right away, without waiting for the 32 bit times of the real one.
+ */
+#define UART_FIFO_DEPTH 16
+
+static struct
+{
+    uint64_t char_cycles;       // time to send one character
+    uint64_t busy_until;        // time the last character in the FIFO is sent
+    uint32_t tx_level;          // TX interrupt trigger level, in characters
+    uint64_t tx_trigger;        // time the FIFO level drains to tx_level, 0 for none
+    uint32_t int_mask;
+    uint32_t int_status;
+    bool dma_tx;
+    unsigned char rx_fifo[UART_FIFO_DEPTH];
+    uint32_t rx_head, rx_tail; // characters received and read, counting without wrapping
+} uart = {.char_cycles = SIM_CLOCK_RATE * 10 / 115200, .tx_level = 8};
+
+// Characters in the TX FIFO at the current time
+static uint32_t UartTxLevel()
+{
+    uint64_t now = SimNow();
+
+    if (uart.busy_until <= now)
+        return 0;
+    return (uart.busy_until - now + uart.char_cycles - 1) / uart.char_cycles;
+}
+
+static void UartTxWrite(unsigned char ch)
+{
+    uint64_t now = SimNow();
+    uint64_t trigger;
+
+    SimUartPutChar(ch);
+    uart.busy_until = (uart.busy_until > now ? uart.busy_until : now) + uart.char_cycles;
+
+    // Only a FIFO filled above the trigger level drains past it
+    trigger = uart.busy_until - uart.tx_level * uart.char_cycles;
+    if (trigger > now)
+        uart.tx_trigger = trigger;
+}
+
+// Let the uDMA fill the TX FIFO
+static void UartDmaService()
+{
+    uint32_t value;
+
+    while (uart.dma_tx && UartTxLevel() < UART_FIFO_DEPTH)
+    {
+        int result = DmaPeripheralRead(UDMA_CHANNEL_UART0TX, &value);
+        if (result == DMA_NOT_TAKEN)
+            break;
+        UartTxWrite(value);
+        if (result == DMA_DONE)
+            SimIntPend(INT_UART0);
+    }
+}
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t ui32Baud,
+                         uint32_t ui32Config)
+{
+    uart.char_cycles = (uint64_t) ui32UARTClk * 10 / ui32Baud;
+}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel)
+{
+    static const uint32_t levels[] = {2, 4, 8, 12, 14};
+    uart.tx_level = levels[ui32TxLevel];
+}
+
+void UARTDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    if (ui32DMAFlags & UART_DMA_TX)
+        uart.dma_tx = true;
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base)
+{
+    return UartTxLevel() < UART_FIFO_DEPTH;
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    if (!UARTSpaceAvail(ui32Base))
+        return false;
+    UartTxWrite(ucData);
+    return true;
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    // Wait until the character in the shift register is sent
+    while (!UARTSpaceAvail(ui32Base))
+        SimBusyWait(uart.busy_until - (UART_FIFO_DEPTH - 1) * uart.char_cycles - SimNow());
+    UartTxWrite(ucData);
+}
+
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    SimIntRegister(INT_UART0, pfnHandler);
+}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    uart.int_mask |= ui32IntFlags;
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    uart.int_mask &= ~ui32IntFlags;
+}
+
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    return bMasked ? uart.int_status & uart.int_mask : uart.int_status;
+}
+
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    uart.int_status &= ~ui32IntFlags;
+}
+
+bool UARTCharsAvail(uint32_t ui32Base)
+{
+    return uart.rx_head != uart.rx_tail;
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    if (!UARTCharsAvail(ui32Base))
+        return -1;
+    return uart.rx_fifo[uart.rx_tail++ % UART_FIFO_DEPTH];
+}
+
+int32_t UARTCharGet(uint32_t ui32Base)
+{
+    return UARTCharsAvail(ui32Base) ? UARTCharGetNonBlocking(ui32Base) : 0;
+}
+
+void SimUartReceiveChar(char ch)
+{
+    // A full FIFO drops the character, as an overrun
+    if (uart.rx_head - uart.rx_tail == UART_FIFO_DEPTH)
+        return;
+    uart.rx_fifo[uart.rx_head++ % UART_FIFO_DEPTH] = ch;
+
+    uart.int_status |= UART_INT_RT;
+    if (uart.int_mask & UART_INT_RT)
+        SimIntPend(INT_UART0);
+}
+
+/*
+ * EEPROM: erased at power-up unless a scenario loads an image, and programmed without delay.
+ * The writes of every word are counted.
+ */
+static struct
+{
+    uint32_t word[SIM_EEPROM_WORDS];
+    uint32_t writes[SIM_EEPROM_WORDS];
+} eeprom = {{[0 ... SIM_EEPROM_WORDS - 1] = 0xFFFFFFFF}};
+
+uint32_t EEPROMInit(void)
+{
+    return EEPROM_INIT_OK;
+}
+
+uint32_t EEPROMSizeGet(void)
+{
+    return SIM_EEPROM_WORDS * 4;
+}
+
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t i;
+
+    for (i = 0; i < ui32Count / 4 && ui32Address / 4 + i < SIM_EEPROM_WORDS; i++)
+        pui32Data[i] = eeprom.word[ui32Address / 4 + i];
+}
+
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t i;
+
+    if ((ui32Address + ui32Count) / 4 > SIM_EEPROM_WORDS)
+        return EEPROM_RC_INVPL;
+    for (i = 0; i < ui32Count / 4; i++)
+    {
+        eeprom.word[ui32Address / 4 + i] = pui32Data[i];
+        eeprom.writes[ui32Address / 4 + i]++;
+    }
+    return 0;
+}
+
+const uint32_t *SimEepromImage()
+{
+    return eeprom.word;
+}
+
+void SimEepromLoad(const uint32_t *image)
+{
+    uint32_t i;
+
+    for (i = 0; i < SIM_EEPROM_WORDS; i++)
+        eeprom.word[i] = image[i];
+}
+
+uint32_t SimEepromWrites()
+{
+    uint32_t i, writes = 0;
+
+    for (i = 0; i < SIM_EEPROM_WORDS; i++)
+        writes += eeprom.writes[i];
+    return writes;
+}
+
+/*
+ * Peripheral hooks for the simulator core
+ */
+uint64_t SimPeripheralNextTime()
+{
+    uint64_t now = SimNow();
+    uint64_t next = UINT64_MAX;
+    int i, half;
+
+    if (systick.enabled && systick.int_enabled && systick.next < next)
+        next = systick.next;
+
+    for (i = 0; i < NUM_TIMERS; i++)
+    {
+        for (half = 0; half < 2; half++)
+        {
+            uint64_t time = TimerNextInterrupt(&timers[i], half, now);
+            if (time < next)
+                next = time;
+
+            // The next uDMA request of a PWM period
+            if (TimerPwmDma(&timers[i], half) && (time = TimerNextTimeout(&timers[i], half, now)) < next)
+                next = time;
+        }
+    }
+
+    if (uart.tx_trigger != 0 && (uart.int_mask & UART_INT_TX) && uart.tx_trigger < next)
+        next = uart.tx_trigger;
+
+    // The uDMA moves the next character as soon as the FIFO has room for it
+    if (uart.dma_tx && DmaChannelReady(UDMA_CHANNEL_UART0TX))
+    {
+        uint64_t room = UartTxLevel() < UART_FIFO_DEPTH
+                            ? now : uart.busy_until - (UART_FIFO_DEPTH - 1) * uart.char_cycles;
+        if (room < next)
+            next = room;
+    }
+
+    return next;
+}
+
+void SimPeripheralUpdate()
+{
+    uint64_t now = SimNow();
+    int i, half;
+
+    if (systick.enabled && systick.int_enabled && systick.next <= now)
+    {
+        while (systick.next <= now)
+            systick.next += systick.period + 1;
+        SimIntPend(FAULT_SYSTICK);
+    }
+
+    // Raise the timer interrupts that fell in (last_update, now]
+    for (i = 0; i < NUM_TIMERS; i++)
+    {
+        SimTimer *timer = &timers[i];
+
+        for (half = 0; half < 2; half++)
+        {
+            TimerPwmDmaUpdate(timer, half, now);
+
+            uint64_t from = timer->last_update;
+
+            if (!TimerCounting(timer, half) || from >= now)
+                continue;
+
+            // A load waiting for a time-out starts the new count at it
+            if (timer->pending_at[half] != 0 && timer->pending_at[half] <= now)
+            {
+                timer->int_status |= TimeoutFlag(half);
+                timer->start[half] = from = timer->pending_at[half];
+                timer->load[half] = timer->pending_load[half];
+                timer->pending_at[half] = 0;
+            }
+
+            if (TimerNextTimeout(timer, half, from) <= now)
+            {
+                timer->int_status |= TimeoutFlag(half);
+                if (timer->adc_trigger[half] && adc.trigger == ADC_TRIGGER_TIMER)
+                    AdcSample();
+            }
+            if ((TimerMode(timer, half) & TIMER_TAMR_TAMIE) &&
+                TimerNextMatch(timer, half, from) <= now)
+                timer->int_status |= MatchFlag(half);
+
+            if (timer->int_status & timer->int_mask & (TimeoutFlag(half) | MatchFlag(half)))
+                SimIntPend(timer->interrupt[half]);
+        }
+        timer->last_update = now;
+
+        // A one-shot timer stops after its time-out
+        for (half = 0; half < 2; half++)
+        {
+            if (TimerCounting(timer, half) &&
+                (TimerMode(timer, half) & TIMER_TAMR_TAMR_M) == TIMER_TAMR_TAMR_1_SHOT &&
+                now - timer->start[half] > timer->load[half])
+                timer->enabled[half] = false;
+        }
+    }
+
+    if (uart.tx_trigger != 0 && uart.tx_trigger <= now)
+    {
+        uart.tx_trigger = 0;
+        uart.int_status |= UART_INT_TX;
+        if (uart.int_mask & UART_INT_TX)
+            SimIntPend(INT_UART0);
+    }
+    UartDmaService();
+}
@@ -0,0 +1,235 @@
+/*
+ * sine_bench.c: host-side accuracy test and benchmark of TivaWare's utils/sine.c
+ *
+ * ----------------------------
+ *  Created on: Dec 19, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Measures the error of sine(), SineLinear() and SineQuadratic(), and of their cosines, against
+ * the C library's sin() over a sweep of the circle and random angles, checks that each is odd
+ * to the last bit, and holds the interpolated ones to the bounds their documentation gives.
+ *
+ * SineOscillatorFill() runs here on the C versions of the Cortex-M4 instructions it uses. Its
+ * samples must match, bit for bit, a reference written out in plain arithmetic from the
+ * description of its table, and come within 5/32768 of the amplitude times sin(). Filling a
+ * run of samples in random blocks, into buffers at odd and even halfwords, must give the same
+ * samples as one call.
+ *
+ * Then it times each way of making a tone, in ns per sample of the host: sine(), SineLinear()
+ * and SineQuadratic() called per sample and scaled by the amplitude, and SineOscillatorFill()
+ * in blocks of 64 samples.
+ *
+ * Built by Host/Makefile, and run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <utils/sine.h>
+#include "bench.h"
+
+#define SWEEP_STRIDE        4093                // angles apart in the sweep; odd, so it covers all the low bits
+#define RANDOM_ANGLES       (1 << 20)
+#define OSC_SAMPLES         48000
+#define OSC_BLOCK           64
+#define BENCH_SAMPLES       (16 * 1024 * 1024)  // per measurement
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+// An angle of the circle, in radians
+static inline double Radians(uint32_t angle)
+{
+    return angle * (2 * M_PI / 4294967296.0);
+}
+
+/*
+ * The largest error of a sine or cosine, in units of 1/65536, over a sweep and random angles;
+ * also checks that it is odd or even
+ */
+static double MaxError(const char *name, int32_t (*function)(uint32_t), int cosine, double bound)
+{
+    uint32_t seed = 0x12345678, angle = 0, i, asymmetric = 0;
+    double worst = 0;
+
+    for (i = 0; i < (uint32_t) (4294967296.0 / SWEEP_STRIDE) + RANDOM_ANGLES; i++)
+    {
+        double exact, error;
+        int32_t value;
+
+        angle = i < 4294967296.0 / SWEEP_STRIDE ? i * SWEEP_STRIDE : BenchRandom(&seed);
+        value = function(angle);
+        exact = 65536 * (cosine ? cos(Radians(angle)) : sin(Radians(angle)));
+        error = fabs(value - exact);
+        if (error > worst)
+            worst = error;
+        asymmetric += function(0 - angle) != (cosine ? value : -value);
+    }
+
+    CHECK(asymmetric == 0, "%s is not %s at %u angles", name, cosine ? "even" : "odd", asymmetric);
+    CHECK(worst <= bound, "%s is %.2f/65536 off", name, worst);
+    return worst;
+}
+
+static int32_t Sine(uint32_t angle)
+{
+    return sine(angle);
+}
+
+static int32_t Cosine(uint32_t angle)
+{
+    return cosine(angle);
+}
+
+static int32_t CosineL(uint32_t angle)
+{
+    return CosineLinear(angle);
+}
+
+static int32_t CosineQ(uint32_t angle)
+{
+    return CosineQuadratic(angle);
+}
+
+/*
+ * Reference oscillator: the packed table is the sine at 256 points of the circle, in 1.15
+ * fixed point, and the sample is the linear interpolation between two of them, with the
+ * fraction in 0.14, at the amplitude, rounded
+ */
+static int16_t reference_table[256];
+
+static int16_t ReferenceSample(uint32_t phase, int16_t amplitude)
+{
+    uint32_t index = phase >> 24, fraction = (phase >> 10) & 0x3FFF;
+    int64_t y0 = reference_table[index], y1 = reference_table[(index + 1) & 255];
+    int64_t value = y0 * 16384 + (y1 - y0) * fraction; // 1.15 scaled by 2^14
+
+    return (int16_t) ((value * amplitude * 8 + 0x80000000) >> 32);
+}
+
+static void Oscillator(void)
+{
+    static const int16_t amplitudes[] = {32767, 16384, 1000, -32768};
+    static int16_t block[OSC_SAMPLES + 2], whole[OSC_SAMPLES];
+    uint32_t seed = 0xC0FFEE, i, a, wrong = 0;
+    double worst = 0;
+
+    for (i = 0; i < 256; i++)
+        reference_table[i] = (int16_t) lround(32767 * sin(i * (2 * M_PI / 256)));
+
+    for (a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++)
+    {
+        uint32_t step = SINE_OSCILLATOR_STEP(440 + 1000 * a, 48000) + a, phase = BenchRandom(&seed), done;
+        tSineOscillator oscillator;
+
+        SineOscillatorInit(&oscillator, step, phase, amplitudes[a]);
+        SineOscillatorFill(&oscillator, whole, OSC_SAMPLES);
+        CHECK(oscillator.ui32Phase == phase + OSC_SAMPLES * step, "the phase did not advance by %u samples",
+              OSC_SAMPLES);
+
+        for (i = 0; i < OSC_SAMPLES; i++)
+        {
+            uint32_t angle = phase + i * step;
+            double error = fabs(whole[i] - amplitudes[a] * sin(Radians(angle)));
+
+            wrong += whole[i] != ReferenceSample(angle, amplitudes[a]);
+            if (error > worst)
+                worst = error;
+        }
+
+        // The same samples in random blocks, at odd and even halfwords
+        SineOscillatorInit(&oscillator, step, phase, amplitudes[a]);
+        for (done = 0; done < OSC_SAMPLES;)
+        {
+            uint32_t n = BenchRandom(&seed) % 9, offset = BenchRandom(&seed) & 1;
+
+            if (n > OSC_SAMPLES - done)
+                n = OSC_SAMPLES - done;
+            block[offset + n] = 0x5A5A;
+            SineOscillatorFill(&oscillator, block + offset, n);
+            for (i = 0; i < n; i++)
+                wrong += block[offset + i] != whole[done + i];
+            wrong += block[offset + n] != 0x5A5A;
+            done += n;
+        }
+    }
+
+    CHECK(wrong == 0, "%u oscillator samples differ from the reference", wrong);
+    CHECK(worst <= 5, "the oscillator is %.2f/32768 off", worst);
+    printf("  oscillator: %u samples as the reference, %.2f/32768 off at most\n",
+           OSC_SAMPLES * (uint32_t) (sizeof(amplitudes) / sizeof(amplitudes[0])), worst);
+}
+
+/*
+ * Make BENCH_SAMPLES of a tone one way; return the time per sample, in ns
+ */
+static volatile int32_t sink;
+
+static double PerSample(int32_t (*function)(uint32_t))
+{
+    uint32_t phase = 0, step = SINE_OSCILLATOR_STEP(1000, 48000), i;
+    int32_t sum = 0;
+    double start = BenchSeconds();
+
+    for (i = 0; i < BENCH_SAMPLES; i++, phase += step)
+        sum += (16384 * function(phase)) >> 16;
+    sink = sum;
+    return (BenchSeconds() - start) * 1e9 / BENCH_SAMPLES;
+}
+
+static double PerBlock(void)
+{
+    static int16_t samples[OSC_BLOCK];
+    tSineOscillator oscillator;
+    int32_t sum = 0;
+    uint32_t i;
+    double start = BenchSeconds();
+
+    SineOscillatorInit(&oscillator, SINE_OSCILLATOR_STEP(1000, 48000), 0, 16384);
+    for (i = 0; i < BENCH_SAMPLES; i += OSC_BLOCK)
+    {
+        SineOscillatorFill(&oscillator, samples, OSC_BLOCK);
+        sum += samples[i & (OSC_BLOCK - 1)];
+    }
+    sink = sum;
+    return (BenchSeconds() - start) * 1e9 / BENCH_SAMPLES;
+}
+
+int main(void)
+{
+    double nearest, linear, quadratic;
+
+    printf("Sine functions:\n");
+
+    nearest = MaxError("sine()", Sine, 0, 1e9);
+    MaxError("cosine()", Cosine, 1, 1e9);
+    linear = MaxError("SineLinear()", SineLinear, 0, 3);
+    MaxError("CosineLinear()", CosineL, 1, 3);
+    quadratic = MaxError("SineQuadratic()", SineQuadratic, 0, 2);
+    MaxError("CosineQuadratic()", CosineQ, 1, 2);
+    printf("  error, in 1/65536: sine() %.2f, SineLinear() %.2f, SineQuadratic() %.2f\n", nearest, linear,
+           quadratic);
+
+    Oscillator();
+
+    printf("  ns per sample: sine() %.2f, SineLinear() %.2f, SineQuadratic() %.2f, SineOscillatorFill() %.2f\n",
+           PerSample(Sine), PerSample(SineLinear), PerSample(SineQuadratic), PerBlock());
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * tempo_bench.c: host-side check and benchmark of the tempo table
+ *
+ * ----------------------------
+ *  Created on: Dec 6, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Checks the tables in Program/tempo_table.c against the math they replace: the float BPM
+ * computation of the rotary angle sensor ISR, and the 64-bit divisions of the beat engine. Then
+ * times the old and new code of both on the host. Host nanoseconds only show the relative cost;
+ * on the target, RASIsrCycles() reports the ISR time in CPU cycles from the DWT cycle counter.
+ *
+ * Built by Host/Makefile, and run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "tempo_table.h"
+#include "bench.h"
+
+// Event ticks per minute, as in tempo_table_gen.c. event.h is not included here, since its time_t
+// conflicts with the one of <time.h>.
+#define TICKS_PER_MINUTE    (60 * 50000000ULL)
+#define ROUNDS              2000
+
+static int failures;
+
+// The BPM computation of the ISR before the tempo table
+static uint32_t FloatBpmOfReading(uint32_t raw_data)
+{
+    float ras_BPM_ratio = (raw_data / 4095.0);
+    return 150 - (ras_BPM_ratio * 100);
+}
+
+static void CheckTables()
+{
+    uint32_t reading, bpm;
+
+    // The table is at most 1 BPM off the float result, and never outside the tempo range
+    for (reading = 0; reading < 4096; reading++)
+    {
+        int table = TempoBpmOfReading(reading);
+        int exact = FloatBpmOfReading(reading);
+        if (table - exact > 1 || exact - table > 1 || table < TEMPO_MIN_BPM || table > TEMPO_MAX_BPM)
+        {
+            printf("FAIL reading %u: table %d BPM, float %d BPM\n", reading, table, exact);
+            failures++;
+        }
+    }
+
+    for (bpm = TEMPO_MIN_BPM; bpm <= TEMPO_MAX_BPM; bpm++)
+    {
+        const TempoEntry *tempo = TempoLookup(bpm);
+        if (tempo->period != TICKS_PER_MINUTE / bpm || tempo->remainder != TICKS_PER_MINUTE % bpm ||
+            tempo->buzz_on != tempo->period / 5 || tempo->buzz_on + tempo->buzz_off != tempo->period)
+        {
+            printf("FAIL %u BPM: wrong timing\n", bpm);
+            failures++;
+        }
+    }
+}
+
+int main(void)
+{
+    volatile uint32_t sink = 0;
+    volatile uint64_t divisor = TICKS_PER_MINUTE;
+    double start, old_ns, new_ns;
+    uint32_t round, reading, bpm;
+
+    CheckTables();
+
+    // The ISR: BPM of a reading
+    start = BenchSeconds();
+    for (round = 0; round < ROUNDS; round++)
+        for (reading = 0; reading < 4096; reading++)
+            sink += FloatBpmOfReading(reading);
+    old_ns = (BenchSeconds() - start) * 1e9 / (ROUNDS * 4096.0);
+
+    start = BenchSeconds();
+    for (round = 0; round < ROUNDS; round++)
+        for (reading = 0; reading < 4096; reading++)
+            sink += TempoBpmOfReading(reading);
+    new_ns = (BenchSeconds() - start) * 1e9 / (ROUNDS * 4096.0);
+
+    // The host does the double math of the old ISR in hardware; the firmware does not enable the
+    // FPU, and the M4 has no double precision anyway, so there it is a software division
+    printf("BPM of a reading: float %.2f ns, table %.2f ns (host FPU; software double on target)\n",
+           old_ns, new_ns);
+
+    // A tempo change: beat period, remainder and buzz-on time
+    start = BenchSeconds();
+    for (round = 0; round < ROUNDS * 40; round++)
+        for (bpm = TEMPO_MIN_BPM; bpm <= TEMPO_MAX_BPM; bpm++)
+        {
+            uint32_t period = divisor / bpm;
+            sink += period + divisor % bpm + period / 5;
+        }
+    old_ns = (BenchSeconds() - start) * 1e9 / (ROUNDS * 40.0 * (TEMPO_MAX_BPM - TEMPO_MIN_BPM + 1));
+
+    start = BenchSeconds();
+    for (round = 0; round < ROUNDS * 40; round++)
+        for (bpm = TEMPO_MIN_BPM; bpm <= TEMPO_MAX_BPM; bpm++)
+        {
+            const TempoEntry *tempo = TempoLookup(bpm);
+            sink += tempo->period + tempo->remainder + tempo->buzz_on;
+        }
+    new_ns = (BenchSeconds() - start) * 1e9 / (ROUNDS * 40.0 * (TEMPO_MAX_BPM - TEMPO_MIN_BPM + 1));
+
+    printf("Tempo change: division %.2f ns, table %.2f ns\n", old_ns, new_ns);
+
+    return failures ? 1 : 0;
+}
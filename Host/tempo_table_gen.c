@@ -0,0 +1,72 @@
+/*
+ * tempo_table_gen.c: generator of the tempo tables in Program/tempo_table.c
+ *
+ * ----------------------------
+ *  Created on: Dec 6, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Writes the tables to standard output. After changing the tempo range, the ADC shift or the
+ * event tick rate, regenerate them with "make tempo_table" in Host/; "make test" checks that the
+ * committed file is up to date.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "event.h" // for the event tick rate
+#include "tempo_table.h"
+
+// Ticks in one minute; one beat lasts TICKS_PER_MINUTE / BPM ticks
+#define TICKS_PER_MINUTE    (60 * EVENT_TICK_RATE)
+
+// Full scale of the 12-bit ADC
+#define ADC_MAX             4095
+
+// BPM of a reading, as the original float code computed it: the tempo range scaled by
+// reading / 4095 is subtracted from the top BPM, and the result truncated
+static uint32_t BpmOfReading(uint32_t reading)
+{
+    uint32_t range = TEMPO_MAX_BPM - TEMPO_MIN_BPM;
+    return TEMPO_MAX_BPM - (reading * range + ADC_MAX - 1) / ADC_MAX;
+}
+
+int main(void)
+{
+    uint32_t i, bpm;
+
+    printf("/*\n");
+    printf(" * tempo_table.c: precomputed tempo values for the metronome\n");
+    printf(" *\n");
+    printf(" * Generated by Host/tempo_table_gen.c; do not edit. See tempo_table.h.\n");
+    printf(" */\n\n");
+    printf("#include <stdint.h>\n");
+    printf("#include \"event.h\"\n");
+    printf("#include \"tempo_table.h\"\n\n");
+    printf("#if EVENT_TICK_RATE != %lluULL || TEMPO_ADC_SHIFT != %d || TEMPO_MIN_BPM != %d || TEMPO_MAX_BPM != %d\n",
+           (unsigned long long) EVENT_TICK_RATE, TEMPO_ADC_SHIFT, TEMPO_MIN_BPM, TEMPO_MAX_BPM);
+    printf("#error \"tempo_table.c is out of date; regenerate it with make tempo_table in Host/\"\n");
+    printf("#endif\n\n");
+
+    printf("// BPM by reading >> %d, computed for the lowest reading of each entry\n", TEMPO_ADC_SHIFT);
+    printf("const uint8_t TEMPO_BPM_OF_READING[TEMPO_ADC_ENTRIES] = {");
+    for (i = 0; i < TEMPO_ADC_ENTRIES; i++)
+        printf("%s%u,", i % 16 ? " " : "\n    ", BpmOfReading(i << TEMPO_ADC_SHIFT));
+    printf("\n};\n\n");
+
+    printf("// {period, buzz_on, buzz_off, remainder} of %d to %d BPM\n", TEMPO_MIN_BPM, TEMPO_MAX_BPM);
+    printf("const TempoEntry TEMPO_TABLE[TEMPO_MAX_BPM - TEMPO_MIN_BPM + 1] = {\n");
+    for (bpm = TEMPO_MIN_BPM; bpm <= TEMPO_MAX_BPM; bpm++)
+    {
+        uint32_t period = TICKS_PER_MINUTE / bpm;
+        uint32_t buzz_on = period / 5;
+        printf("    {%uu, %uu, %uu, %uu}, // %u BPM\n", period, buzz_on, period - buzz_on,
+               (uint32_t) (TICKS_PER_MINUTE % bpm), bpm);
+    }
+    printf("};\n");
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * trace_decode.c: decoder of the binary trace log in the UART0 output
+ *
+ * ----------------------------
+ *  Created on: Dec 9, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Reads a capture of UART0 from a file, or standard input, and writes it as text: lines of text
+ * pass through, and every trace record (see TraceLog() in Util/uart.c) becomes a line with its
+ * time since the first record and its message formatted from Util/trace_formats.h. Gaps in the
+ * sequence numbers are reported as dropped records.
+ *
+ *   trace_decode [capture]
+ *
+ * Exits with 1 on an unknown format ID or a truncated record.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Cycle counter rate of the timestamps
+#define CLOCK_RATE      50000000.0
+
+typedef enum
+{
+#define TRACE_FORMAT(id, format) id,
+#include "trace_formats.h"
+#undef TRACE_FORMAT
+    TRACE_FORMAT_COUNT
+} TraceId;
+
+static const char *const FORMATS[TRACE_FORMAT_COUNT] = {
+#define TRACE_FORMAT(id, format) [id] = format,
+#include "trace_formats.h"
+#undef TRACE_FORMAT
+};
+
+// Read a little-endian value of the given number of bytes; return false at the end of the input
+static bool ReadValue(FILE *input, int bytes, uint32_t *word)
+{
+    int i, ch;
+
+    *word = 0;
+    for (i = 0; i < bytes; i++)
+    {
+        if ((ch = fgetc(input)) == EOF)
+            return false;
+        *word |= (uint32_t) ch << (8 * i);
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *input = stdin;
+    bool first = true, in_line = false;
+    uint32_t last_stamp = 0, expected = 0;
+    uint64_t cycles = 0;
+    int ch;
+
+    if (argc > 1 && (input = fopen(argv[1], "rb")) == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while ((ch = fgetc(input)) != EOF)
+    {
+        uint32_t rest, stamp, args[3] = {0, 0, 0};
+        uint32_t id, sequence, count, i;
+
+        // Text is 7-bit ASCII; the UART sends "\n\r" line ends
+        if (ch < 0x80)
+        {
+            if (ch != '\r')
+            {
+                putchar(ch);
+                in_line = (ch != '\n');
+            }
+            continue;
+        }
+
+        // A record: count byte, then format ID and 16-bit sequence number, timestamp, arguments
+        count = ch & 0x03;
+        if (!ReadValue(input, 3, &rest) || !ReadValue(input, 4, &stamp))
+            break;
+        for (i = 0; i < count; i++)
+            if (!ReadValue(input, 4, &args[i]))
+                break;
+        if (i < count)
+            break;
+
+        // The rest of the header word
+        id = rest & 0xFF;
+        sequence = (rest >> 8) & 0xFFFF;
+        if (id >= TRACE_FORMAT_COUNT)
+        {
+            fprintf(stderr, "unknown trace format ID %u\n", id);
+            return 1;
+        }
+
+        // The 32-bit cycle counter wraps every 86 s; records are assumed closer than that
+        if (!first)
+            cycles += (uint32_t) (stamp - last_stamp);
+        last_stamp = stamp;
+
+        if (in_line)
+            putchar('\n');
+        in_line = false;
+        if (!first && sequence != expected)
+            printf("(%u trace records dropped)\n", (sequence - expected) & 0xFFFF);
+        expected = (sequence + 1) & 0xFFFF;
+        first = false;
+
+        printf("[%12.6f] ", cycles / CLOCK_RATE);
+        printf(FORMATS[id], args[0], args[1], args[2]);
+        putchar('\n');
+    }
+
+    if (ch != EOF)
+    {
+        fprintf(stderr, "truncated trace record\n");
+        return 1;
+    }
+
+    return 0;
+}
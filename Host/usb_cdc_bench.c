@@ -0,0 +1,285 @@
+/*
+ * usb_cdc_bench.c: host-side benchmark of TivaWare's USB buffers on a simulated CDC stream
+ *
+ * ----------------------------
+ *  Created on: Dec 16, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Runs usblib/usbbuffer.c, unchanged, between an application and a simulated CDC endpoint
+ * pair. The transmit endpoint takes a packet of up to 64 bytes at a time, as the device
+ * class's packet write function does, and the host side acknowledges it with
+ * USB_EVENT_TX_COMPLETE; the receive endpoint delivers 64-byte packets with
+ * USB_EVENT_RX_AVAILABLE, for the buffer to read through the packet read function. Every byte
+ * is checked at the other end.
+ *
+ * The application sends and receives the stream in chunks of 1, 16 and 64 bytes, two ways: by
+ * copy, through its own array and USBBufferWrite()/USBBufferRead(), and in place, in the
+ * spans of USBBufferWriteReserve()/USBBufferReadPeek() followed by USBBufferDataWritten()/
+ * USBBufferDataRemoved().
+ *
+ * The Makefile builds it twice: usb_cdc_bench_spsc with RINGBUF_SPSC=1, and usb_cdc_bench_masked
+ * with TivaWare's default, the original ring buffer. Both are run by "make test" there.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <usblib/usblib.h>
+#include "bench.h"
+
+#define CDC_BUFFER          256                 // as in TivaWare's CDC examples
+#define CDC_PACKET          64                  // full-speed bulk packet
+#define BENCH_BYTES         (4 * 1024 * 1024)   // through each buffer per measurement
+
+static int failures;
+
+#define CHECK(cond, ...)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);                 \
+            printf(__VA_ARGS__);                                        \
+            printf("\n");                                               \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*
+ * Stub interrupt masking: count the masked sections
+ */
+static uint32_t masked_sections;
+
+bool IntMasterDisable(void)
+{
+    masked_sections++;
+    return false;
+}
+
+bool IntMasterEnable(void)
+{
+    return false;
+}
+
+// The byte at a position of the stream
+static inline uint8_t StreamByte(uint32_t position)
+{
+    return (uint8_t) (position ^ (position >> 8) ^ (position >> 16));
+}
+
+/*
+ * Simulated endpoints; each has one packet in flight at most
+ */
+static struct
+{
+    uint8_t packet[CDC_PACKET];
+    uint32_t length;        // bytes in the packet
+    bool busy;              // sent, not yet acknowledged
+    uint32_t position;      // of the stream checked (IN) or sent (OUT) by the host
+    uint32_t read;          // bytes of the OUT packet read by the buffer
+    uint32_t errors;
+} in_ep, out_ep;
+
+// Transmit: room for a packet once the last one is acknowledged
+static uint32_t InAvailable(void *handle)
+{
+    return in_ep.busy ? 0 : CDC_PACKET;
+}
+
+// Transmit: put bytes into the packet, and send it with the last of them
+static uint32_t InTransfer(void *handle, uint8_t *data, uint32_t length, bool last)
+{
+    if (in_ep.busy || in_ep.length + length > CDC_PACKET)
+    {
+        in_ep.errors++;
+        return 0;
+    }
+    memcpy(in_ep.packet + in_ep.length, data, length);
+    in_ep.length += length;
+    in_ep.busy = last;
+    return length;
+}
+
+// Receive: the size of the packet waiting
+static uint32_t OutAvailable(void *handle)
+{
+    return CDC_PACKET - out_ep.read;
+}
+
+// Receive: read bytes of the packet waiting
+static uint32_t OutTransfer(void *handle, uint8_t *data, uint32_t length, bool ack)
+{
+    if (length > CDC_PACKET - out_ep.read)
+        length = CDC_PACKET - out_ep.read;
+    memcpy(data, out_ep.packet + out_ep.read, length);
+    out_ep.read += length;
+    return length;
+}
+
+// The application takes no data in its callback; it reads in its main loop
+static uint32_t AppCallback(void *cb_data, uint32_t event, uint32_t value, void *data)
+{
+    return 0;
+}
+
+static uint8_t tx_memory[CDC_BUFFER], rx_memory[CDC_BUFFER];
+
+static tUSBBuffer tx_buffer = {true, AppCallback, NULL, InTransfer, InAvailable, NULL, tx_memory, CDC_BUFFER};
+static tUSBBuffer rx_buffer = {false, AppCallback, NULL, OutTransfer, OutAvailable, NULL, rx_memory, CDC_BUFFER};
+
+// The host acknowledges the packet in flight, after checking it; false if there is none
+static bool HostReceive(void)
+{
+    uint32_t i, length = in_ep.length;
+
+    if (!in_ep.busy)
+        return false;
+    for (i = 0; i < length; i++)
+        in_ep.errors += in_ep.packet[i] != StreamByte(in_ep.position + i);
+    in_ep.position += length;
+    in_ep.length = 0;
+    in_ep.busy = false;
+    USBBufferEventCallback(&tx_buffer, USB_EVENT_TX_COMPLETE, length, NULL);
+    return true;
+}
+
+// The host sends the next packet, if the buffer has room for it
+static void HostSend(void)
+{
+    uint32_t i;
+
+    if (USBBufferSpaceAvailable(&rx_buffer) < CDC_PACKET)
+        return;
+    for (i = 0; i < CDC_PACKET; i++)
+        out_ep.packet[i] = StreamByte(out_ep.position + i);
+    out_ep.position += CDC_PACKET;
+    out_ep.read = 0;
+    USBBufferEventCallback(&rx_buffer, USB_EVENT_RX_AVAILABLE, CDC_PACKET, NULL);
+    if (out_ep.read != CDC_PACKET)
+        out_ep.errors++;
+}
+
+/*
+ * Send BENCH_BYTES to the host in chunks of the given size; return the time per byte, in ns
+ */
+static double Transmit(uint32_t chunk, bool in_place)
+{
+    uint8_t data[CDC_PACKET];
+    uint32_t position = 0, i;
+    double start;
+
+    USBBufferInit(&tx_buffer);
+    memset(&in_ep, 0, sizeof(in_ep));
+
+    start = BenchSeconds();
+    while (in_ep.position < BENCH_BYTES)
+    {
+        uint32_t n = BENCH_BYTES - position < chunk ? BENCH_BYTES - position : chunk;
+
+        if (n > 0 && USBBufferSpaceAvailable(&tx_buffer) >= n)
+        {
+            if (in_place)
+            {
+                tUSBRingBufSpan span[2];
+                uint32_t j;
+
+                USBBufferWriteReserve(&tx_buffer, n, span);
+                for (j = 0; j < 2; j++)
+                    for (i = 0; i < span[j].ui32Length; i++)
+                        span[j].pui8Data[i] = StreamByte(position++);
+                USBBufferDataWritten(&tx_buffer, n);
+            }
+            else
+            {
+                for (i = 0; i < n; i++)
+                    data[i] = StreamByte(position + i);
+                position += USBBufferWrite(&tx_buffer, data, n);
+            }
+        }
+        else if (!HostReceive())
+        {
+            CHECK(false, "the stream stopped after %u bytes, in chunks of %u", in_ep.position, chunk);
+            break;
+        }
+    }
+
+    CHECK(in_ep.errors == 0, "%u bytes sent wrong, in chunks of %u", in_ep.errors, chunk);
+    return (BenchSeconds() - start) * 1e9 / BENCH_BYTES;
+}
+
+/*
+ * Receive BENCH_BYTES from the host in chunks of the given size; return the time per byte, in ns
+ */
+static double Receive(uint32_t chunk, bool in_place)
+{
+    uint8_t data[CDC_PACKET];
+    uint32_t position = 0, errors = 0, i;
+    double start;
+
+    USBBufferInit(&rx_buffer);
+    memset(&out_ep, 0, sizeof(out_ep));
+
+    start = BenchSeconds();
+    while (position < BENCH_BYTES)
+    {
+        if (USBBufferDataAvailable(&rx_buffer) >= chunk)
+        {
+            if (in_place)
+            {
+                tUSBRingBufSpan span[2];
+                uint32_t j;
+
+                USBBufferReadPeek(&rx_buffer, chunk, span);
+                for (j = 0; j < 2; j++)
+                    for (i = 0; i < span[j].ui32Length; i++)
+                        errors += span[j].pui8Data[i] != StreamByte(position++);
+                USBBufferDataRemoved(&rx_buffer, chunk);
+            }
+            else
+            {
+                USBBufferRead(&rx_buffer, data, chunk);
+                for (i = 0; i < chunk; i++)
+                    errors += data[i] != StreamByte(position++);
+            }
+        }
+        else
+            HostSend();
+    }
+
+    CHECK(errors == 0 && out_ep.errors == 0, "%u bytes received wrong, in chunks of %u", errors, chunk);
+    return (BenchSeconds() - start) * 1e9 / BENCH_BYTES;
+}
+
+int main(void)
+{
+    static const uint32_t chunks[] = {1, 16, 64};
+    int i;
+
+    printf("%s\n", RINGBUF_SPSC ? "USB CDC stream, single producer and consumer ring buffer:" :
+           "USB CDC stream, interrupt-masking ring buffer:");
+
+    for (i = 0; i < (int) (sizeof(chunks) / sizeof(chunks[0])); i++)
+    {
+        double tx_copy, tx_place, rx_copy, rx_place;
+        uint32_t sections;
+
+        masked_sections = 0;
+        tx_copy = Transmit(chunks[i], false);
+        tx_place = Transmit(chunks[i], true);
+        rx_copy = Receive(chunks[i], false);
+        rx_place = Receive(chunks[i], true);
+        sections = masked_sections;
+
+        printf("  %2u-byte chunks: send %6.2f ns per byte by copy, %6.2f in place; receive %6.2f by copy, %6.2f "
+               "in place; %.1f masked sections per byte\n", chunks[i], tx_copy, tx_place, rx_copy, rx_place,
+               sections / (4.0 * BENCH_BYTES));
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * beat_timer.c: hardware-timed beats on a general-purpose timer
+ *
+ * ----------------------------
+ *  Created on: Dec 12, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * WTIMER2A counts down one beat period at a time in periodic mode, with TAILD set, so a new
+ * load value waits for the next time-out. The ISR of a time-out therefore writes the period
+ * after the one the timer just started: the beats never depend on when the ISR runs, only the
+ * click onsets do, by the ISR's fixed latency. The ideal beat times come from an EventPeriod
+ * accumulator, as for the periodic events, so a fractional period does not drift either.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_timer.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/timer.h>
+#include <driverlib/interrupt.h>
+#include "beat_timer.h"
+#include "buzzer.h"
+
+#if BEAT_TIMER
+
+#if !BUZZER_CLICKS
+#error "BEAT_TIMER needs BUZZER_CLICKS: the beat ISR cannot wait for a square wave to end"
+#endif
+
+// The beat timer. Its interrupt has the highest priority, so nothing delays the onsets.
+#define BEAT_TIMER_PERIPH   SYSCTL_PERIPH_WTIMER2
+#define BEAT_TIMER_BASE     WTIMER2_BASE
+#define BEAT_TIMER_INT      INT_WTIMER2A
+#define BEAT_PRIORITY       0x00
+
+// The onset capture, on the other half of the buzzer's timer, configured by BuzzerInit()
+#define CAPTURE_BASE        WTIMER0_BASE
+#define CAPTURE_INT         INT_WTIMER0A
+#define CAPTURE_PRIORITY    0x20
+
+// Beat timer state shared with the ISRs
+static struct
+{
+    EventPeriod period;         // ideal beat times in ticks since beat 0; time is the end of
+                                // the period written last, which the timer takes next
+    time_t next_beat;           // ideal time of the beat the timer counts down to
+    time_t onset_beat;          // ideal time of the beat whose onset is to be captured
+    BeatHandler handler;
+    bool running;
+
+    // Onset capture
+    uint32_t last_capture;      // capture of the previous onset
+    time_t onset_time;          // time of the last onset since that of beat 0, from the captures
+    uint32_t onsets;
+    uint32_t jitter_max;
+} beat_timer;
+
+/*
+ * Write the load of the period after the one the timer counts now. Call with the beat timer's
+ * interrupt unable to run.
+ */
+static void BeatTimerLoadNext()
+{
+    time_t end = beat_timer.period.time;
+
+    EventPeriodAdvance(&beat_timer.period);
+    TimerLoadSet(BEAT_TIMER_BASE, TIMER_A, (uint32_t) (beat_timer.period.time - end) - 1);
+}
+
+/*
+ * Start a click, and arm the capture of its first edge
+ */
+static void BeatTimerBeat(time_t ideal)
+{
+    beat_timer.onset_beat = ideal;
+    TimerIntClear(CAPTURE_BASE, TIMER_CAPA_EVENT);
+    TimerIntEnable(CAPTURE_BASE, TIMER_CAPA_EVENT);
+
+    beat_timer.handler();
+}
+
+/*
+ * Beat timer ISR: the timer has just taken the period that the last call wrote
+ */
+static void BeatTimerISR()
+{
+    time_t beat = beat_timer.next_beat;
+
+    TimerIntClear(BEAT_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+    beat_timer.next_beat = beat_timer.period.time;
+    BeatTimerLoadNext();
+    BeatTimerBeat(beat);
+}
+
+/*
+ * Capture ISR: the first edge of a click. The onset times add up the 32-bit capture
+ * differences, which wrap only after 85 s.
+ */
+static void BeatTimerCaptureISR()
+{
+    uint32_t capture = TimerValueGet(CAPTURE_BASE, TIMER_A);
+    int64_t error;
+
+    TimerIntClear(CAPTURE_BASE, TIMER_CAPA_EVENT);
+    TimerIntDisable(CAPTURE_BASE, TIMER_CAPA_EVENT);
+
+    if (beat_timer.onsets > 0)
+        beat_timer.onset_time += (uint32_t) (capture - beat_timer.last_capture);
+    beat_timer.last_capture = capture;
+    beat_timer.onsets++;
+
+    error = (int64_t) (beat_timer.onset_time - beat_timer.onset_beat);
+    if (error < 0)
+        error = -error;
+    if (error > beat_timer.jitter_max)
+        beat_timer.jitter_max = (uint32_t) error;
+}
+
+/*
+ * Set up the beat timer, and the capture of the onsets on PC4 (WT0CCP0)
+ */
+void BeatTimerInit(BeatHandler handler)
+{
+    beat_timer.handler = handler;
+
+    SysCtlPeripheralEnable(BEAT_TIMER_PERIPH);
+    SysCtlPeripheralSleepEnable(BEAT_TIMER_PERIPH);
+    TimerConfigure(BEAT_TIMER_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PERIODIC);
+    HWREG(BEAT_TIMER_BASE + TIMER_O_TAMR) |= TIMER_TAMR_TAILD;
+    TimerIntRegister(BEAT_TIMER_BASE, TIMER_A, BeatTimerISR);
+    TimerIntEnable(BEAT_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    IntPrioritySet(BEAT_TIMER_INT, BEAT_PRIORITY);
+
+    // The capture half runs freely, counting up over the whole 32 bits
+    GPIOPinTypeTimer(GPIO_PORTC_BASE, GPIO_PIN_4);
+    GPIOPinConfigure(GPIO_PC4_WT0CCP0);
+    TimerControlEvent(CAPTURE_BASE, TIMER_A, TIMER_EVENT_POS_EDGE);
+    TimerLoadSet(CAPTURE_BASE, TIMER_A, 0xFFFFFFFF);
+    TimerIntRegister(CAPTURE_BASE, TIMER_A, BeatTimerCaptureISR);
+    IntPrioritySet(CAPTURE_INT, CAPTURE_PRIORITY);
+    TimerEnable(CAPTURE_BASE, TIMER_A);
+}
+
+/*
+ * Set the beat period; the beat timer's ISR takes it up at the next beat
+ */
+void BeatTimerSetPeriod(uint32_t ticks, uint32_t remainder, uint32_t divisor)
+{
+    // Only the beat timer's interrupt reads the period, so only it is held off
+    IntDisable(BEAT_TIMER_INT);
+
+    beat_timer.period.ticks = ticks;
+    beat_timer.period.remainder = remainder;
+    beat_timer.period.divisor = divisor;
+    beat_timer.period.phase = 0;
+
+    IntEnable(BEAT_TIMER_INT);
+}
+
+/*
+ * Start the beats: play beat 0 now, load the period up to beat 1, and have the timer take the
+ * one up to beat 2 at its first time-out
+ */
+void BeatTimerStart()
+{
+    // Hold off the two ISRs that share the state, and no other
+    IntDisable(BEAT_TIMER_INT);
+    IntDisable(CAPTURE_INT);
+
+    beat_timer.period.time = 0;
+    beat_timer.period.phase = 0;
+    beat_timer.onsets = 0;
+    beat_timer.onset_time = 0;
+    beat_timer.jitter_max = 0;
+
+    // Without TAILD in effect, the first load goes to the counter right away
+    TimerDisable(BEAT_TIMER_BASE, TIMER_A);
+    TimerIntClear(BEAT_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    BeatTimerLoadNext();
+    TimerEnable(BEAT_TIMER_BASE, TIMER_A);
+    beat_timer.next_beat = beat_timer.period.time;
+    BeatTimerLoadNext();
+    beat_timer.running = true;
+
+    BeatTimerBeat(0);
+
+    IntEnable(CAPTURE_INT);
+    IntEnable(BEAT_TIMER_INT);
+}
+
+/*
+ * Stop the beats; a click playing plays out
+ */
+void BeatTimerStop()
+{
+    TimerDisable(BEAT_TIMER_BASE, TIMER_A);
+    TimerIntClear(BEAT_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    beat_timer.running = false;
+}
+
+/*
+ * Return the number of onsets captured since the beats started
+ */
+uint32_t BeatTimerOnsetCount()
+{
+    return beat_timer.onsets;
+}
+
+/*
+ * Return the largest distance so far between an onset and its ideal time, in ticks
+ */
+uint32_t BeatTimerJitterMax()
+{
+    return beat_timer.jitter_max;
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * beat_timer.h: hardware-timed beats on a general-purpose timer
+ *
+ * ----------------------------
+ *  Created on: Dec 12, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ */
+
+#ifndef BEAT_TIMER_H_
+#define BEAT_TIMER_H_
+
+#include <stdint.h>
+#include "launchpad.h"
+
+// Beat timing. With BEAT_TIMER, WTIMER2A times the beats: it reloads itself with the next beat
+// period at every time-out, and its interrupt, at the highest priority, starts the beat's click.
+// A beat then lands a fixed few cycles after its ideal time, whatever the event loop is doing,
+// and the event loop only updates the display and follows the tempo. Define to 0 for the beats
+// as a periodic event. Needs BUZZER_CLICKS.
+#ifndef BEAT_TIMER
+#define BEAT_TIMER 0
+#endif
+
+// Function run by the timer ISR at every beat; it must be short
+typedef void (*BeatHandler)(void);
+
+// Set up the beat timer and the onset capture, with the function to run at every beat
+void BeatTimerInit(BeatHandler handler);
+
+// Set the beat period: ticks + remainder / divisor ticks, with remainder below divisor. While the
+// beats run, the timer already holds the period up to the next beat and the one after it, so
+// the new period counts from the beat after next.
+void BeatTimerSetPeriod(uint32_t ticks, uint32_t remainder, uint32_t divisor);
+
+// Start the beats, with beat 0 right away, and stop them
+void BeatTimerStart();
+void BeatTimerStop();
+
+// Onset jitter: WTIMER0A, on PC4 jumpered to the buzzer output on PC5, time-stamps the first
+// edge of every click. Return the number of onsets captured, and the largest distance so far,
+// in ticks, between an onset and its ideal time, both counted from the first beat.
+uint32_t BeatTimerOnsetCount();
+uint32_t BeatTimerJitterMax();
+
+#endif /* BEAT_TIMER_H_ */
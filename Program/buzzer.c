@@ -13,6 +13,7 @@
 
 // including headers to access pins on launchpad, timer functionality, and GPIO functionality through driverlib, and buzzer.h with prototypes
 #include "buzzer.h"
+#include "beat_timer.h"
 #include "launchpad.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -22,22 +23,90 @@
 #include <driverlib/gpio.h>
 #include <driverlib/pin_map.h>
 #include <driverlib/timer.h>
+#include <driverlib/udma.h>
+#include <utils/ringbuf.h>
+#include <utils/sine.h>
 
 // array of floats to store frequencies.
 // inner menu, case 1, rotates through these frequencies.
 float freq[6] =
     {
         // frequency values for each note, in Hz
-        {4186.01}, // C8
-        {4300.01}, // C8 + 200 Hz
+        4186.01, // C8
+        4300.01, // C8 + 200 Hz
 
-        {4698.64}, // D8
-        {4898.64}, // D8 + 200 Hz
+        4698.64, // D8
+        4898.64, // D8 + 200 Hz
 
-        {5587.65}, // F8
-        {5787.65}, // F8 + 200 Hz
+        5587.65, // F8
+        5787.65, // F8 + 200 Hz
 };
 
+#if BUZZER_CLICKS
+// Clicks: uDMA channel 11, assigned to WTIMER0B, moves one 32-bit pulse width into the match
+// register at every rising edge of the PWM output. A click rises to its peak along a quarter
+// sine over CLICK_ATTACK PWM periods, and falls back to silence along a raised cosine.
+#define CLICK_DMA_CHANNEL   (UDMA_CH11_WTIMER0B & 0xFF)
+#define CLICK_ATTACK        4           // PWM periods from the onset to the peak
+#define CLICK_MAX_PERIODS   64          // PWM periods of the longest click
+#define CLICK_SILENT        0xFFFFFFFF  // match value of a silent buzzer, as BuzzerSet() writes it
+
+// Envelope of a click, in match register values, for one pitch
+typedef struct
+{
+    uint32_t periods;                           // PWM periods of the click, before the silence
+    uint32_t volume;                            // pulse width at the peak, in percent of the period
+    uint32_t load;                              // PWM period - 1, in cycles
+    uint32_t match[CLICK_MAX_PERIODS + 1];      // the last entry is CLICK_SILENT
+} ClickEnvelope;
+
+// Lengths and volumes of the normal, medium and accent clicks
+static const ClickEnvelope CLICK_LEVELS[3] = {
+    {40, 25},   // about 9 ms at the lowest pitch
+    {52, 26},   // about 12 ms
+    {64, 27},   // about 15 ms
+};
+
+// The three clicks of each pitch, once prepared. A pitch keeps its own envelopes, which never
+// change once ready, so the beat interrupt never reads one being computed, even when the pitch
+// setting moves to another while the current one plays.
+static ClickEnvelope click_envelope[6][3];
+static volatile bool click_ready[6];
+
+/*
+ * Compute the envelope of a click for a pitch, from BuzzerPrepare(), in thread code. The raised
+ * cosine of the decay comes from the block oscillator of sine.c in one call, a half turn over
+ * the decay periods.
+ */
+static void ClickEnvelopeBuild(ClickEnvelope *click, int pitch_index)
+{
+    uint32_t period = 50000000 / freq[pitch_index];
+    uint32_t peak = (period * click->volume) / 100; // pulse width at the peak
+    uint32_t i, decay = click->periods - CLICK_ATTACK;
+    int16_t fall[CLICK_MAX_PERIODS];                // cosine of the decay, in 1.15 fixed point
+    tSineOscillator oscillator;
+
+    SineOscillatorInit(&oscillator, 0x80000000 / decay, 0x40000000 + 0x80000000 / decay, 32767);
+    SineOscillatorFill(&oscillator, fall, decay);
+
+    for (i = 0; i < click->periods; i++)
+    {
+        int32_t level; // 16.16 fixed point, from 0 to 1
+
+        if (i < CLICK_ATTACK)
+            level = SineQuadratic((i + 1) * (0x40000000 / CLICK_ATTACK));
+        else
+            level = 32768 + fall[i - CLICK_ATTACK];
+
+        uint32_t width = (peak * level) >> 16;
+        click->match[i] = (width > 0) ? width - 1 : CLICK_SILENT;
+    }
+    click->match[click->periods] = CLICK_SILENT;
+
+    click->load = period - 1;
+}
+#endif
+
 /*
  * Initialize the timer PWM functions connected to the Buzzer.
  * Buzzer is on jumper J17, so it has Pin 36 on the Grove Base BoosterPack,
@@ -51,20 +120,38 @@ void BuzzerInit()
 {
     // Enable Wide Timer 0 and GPIO Port C
     SysCtlPeripheralEnable(SYSCTL_PERIPH_WTIMER0);
+    SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_WTIMER0);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
+    SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_GPIOC);
 
     // Connect pins to those timers
     GPIOPinTypeTimer(GPIO_PORTC_BASE, GPIO_PIN_5);
     GPIOPinConfigure(GPIO_PC5_WT0CCP1);
 
     // Select PWM for Wide Timer 0 sub-Timer B, using WTIMER0_BASE since we use PC5 of J17
+#if BEAT_TIMER
+    // sub-Timer A time-stamps the click onsets for the beat timer, see beat_timer.c
+    TimerConfigure(WTIMER0_BASE, (TIMER_CFG_SPLIT_PAIR | TIMER_CFG_B_PWM | TIMER_CFG_A_CAP_TIME_UP));
+#else
     TimerConfigure(WTIMER0_BASE, (TIMER_CFG_SPLIT_PAIR | TIMER_CFG_B_PWM));
+#endif
 
     // Invert the PWM waveform, so that the Match register value is the pulse width.
     // Otherwise, the pulse width will be (Load value) - (Match value).
     // The inversion is done by enabling output inversion on the PWM pins.
     TimerControlLevel(WTIMER0_BASE, TIMER_B, true /* output inversion */);
 
+#if BUZZER_CLICKS
+    // The PWM event of every period requests a uDMA transfer; the NVIC keeps the timer's
+    // interrupt off, so the CPU never sees it. The uDMA controller is set up by LaunchPadInit().
+    TimerControlEvent(WTIMER0_BASE, TIMER_B, TIMER_EVENT_POS_EDGE);
+    TimerIntEnable(WTIMER0_BASE, TIMER_CAPB_EVENT);
+    uDMAChannelAssign(UDMA_CH11_WTIMER0B);
+    uDMAChannelAttributeDisable(CLICK_DMA_CHANNEL, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(CLICK_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_SIZE_32 | UDMA_SRC_INC_32 |
+                          UDMA_DST_INC_NONE | UDMA_ARB_1);
+#endif
+
     // Enable Wide Timer 0's TimerB
     TimerEnable(WTIMER0_BASE, TIMER_B);
 }
@@ -82,7 +169,63 @@ void BuzzerSet(int pitch_index, int volume)
     // duty cycle is volume/100 -- we multiply that fraction by the period to get the pulse's width
     int freq_pulse_width = (freq_pulse_period * volume) / 100;
 
+#if BUZZER_CLICKS
+    // a click still playing would overwrite the new pulse width
+    uDMAChannelDisable(CLICK_DMA_CHANNEL);
+#endif
+
     // set the PWM parameters for the buzzer
     TimerLoadSet(WTIMER0_BASE, TIMER_B, freq_pulse_period - 1);
     TimerMatchSet(WTIMER0_BASE, TIMER_B, freq_pulse_width - 1);
 }
+
+#if BUZZER_CLICKS
+/*
+ * Compute the clicks of a pitch, unless they are ready. A float divide, the sine calls and the
+ * oscillator fill run here, so call it from thread code before the pitch is first played. The
+ * envelopes are complete in memory before the pitch is marked ready for BuzzerClick().
+ */
+void BuzzerPrepare(int pitch_index)
+{
+    uint32_t level;
+
+    if (click_ready[pitch_index])
+        return;
+
+    for (level = 0; level < 3; level++)
+    {
+        ClickEnvelope *click = &click_envelope[pitch_index][level];
+
+        click->periods = CLICK_LEVELS[level].periods;
+        click->volume = CLICK_LEVELS[level].volume;
+        ClickEnvelopeBuild(click, pitch_index);
+    }
+    RingBufBarrier();
+    click_ready[pitch_index] = true;
+}
+
+/*
+ * Play a click: restart the PWM period with the first pulse width of the envelope, and have
+ * the uDMA write the rest, one per period. A click still playing is cut short. This may run
+ * in the beat interrupt, so it only looks the envelope up; a pitch that BuzzerPrepare() has
+ * not computed stays silent.
+ */
+void BuzzerClick(int pitch_index, int level)
+{
+    ClickEnvelope *click = &click_envelope[pitch_index][level - 1];
+
+    if (!click_ready[pitch_index])
+        return;
+
+    uDMAChannelDisable(CLICK_DMA_CHANNEL);
+    TimerDisable(WTIMER0_BASE, TIMER_B);
+
+    TimerLoadSet(WTIMER0_BASE, TIMER_B, click->load);
+    TimerMatchSet(WTIMER0_BASE, TIMER_B, click->match[0]);
+    uDMAChannelTransferSet(CLICK_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_MODE_BASIC, &click->match[1],
+                           (void *) (WTIMER0_BASE + TIMER_O_TBMATCHR), click->periods);
+    uDMAChannelEnable(CLICK_DMA_CHANNEL);
+
+    TimerEnable(WTIMER0_BASE, TIMER_B);
+}
+#endif
@@ -14,10 +14,30 @@
 #ifndef BUZZER_H_
 #define BUZZER_H_
 
+#include <stdbool.h>
+
+// Click synthesis. With BUZZER_CLICKS, a beat is a click: a precomputed envelope of pulse widths
+// that the uDMA writes into the PWM match register, one per PWM period, ending in silence, so the
+// click needs no CPU work once started. Define to 0 for the square wave that BuzzerSet() turns on
+// and off.
+#ifndef BUZZER_CLICKS
+#define BUZZER_CLICKS 1
+#endif
+
 // Initializes the buzzer for PWM (pulse width modulation)
 void BuzzerInit();
 
 // Sets the period and pulse width based on the pitch and volume
 void BuzzerSet(int pitch_index, int volume);
 
+#if BUZZER_CLICKS
+// Computes the clicks of a pitch ahead of BuzzerClick(), once; call it from thread code before
+// the pitch's first click. A prepared pitch's envelopes never change.
+void BuzzerPrepare(int pitch_index);
+
+// Plays one click at the given pitch and level, 1 to 3; a higher level is louder and rings longer.
+// Only starts the uDMA, so it may run in an interrupt; a pitch not prepared stays silent.
+void BuzzerClick(int pitch_index, int level);
+#endif
+
 #endif /* BUZZER_H_ */
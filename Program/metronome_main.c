@@ -14,94 +14,165 @@
 
 #include "launchpad.h"
 #include "seg7.h"
+#include "tempo_table.h"
+#include "pattern_table.h"
 #include "metronome.h"
 #include "buzzer.h"
 #include "rotary_angle_sensor.h"
+#include "beat_timer.h"
+#include "settings.h"
 
 /*
  * Global data structures and variables
  */
 
 // 7 segment display object:
-// 0xFF = 255, which leaves the digit on the 7-segment blank initially
-Seg7Display seg7 = {{0xFF, 0xFF, 0xFF, 0xFF}, false};
+// SEG7_BLANK leaves the digit on the 7-segment blank initially
+Seg7Display seg7 = {{SEG7_BLANK, SEG7_BLANK, SEG7_BLANK, SEG7_BLANK}, false};
 
 // Event objects:
 Event push_button_event;
-Event metronome_event;
+Event metronome_event;   // periodic, one run per beat; with the beat timer, posted by its ISR
+Event buzzer_off_event;  // with the square wave, one run per beat, once the buzz is over
 Event ras_data_event;
 
+// Period of the metronome event, the beat period of the current BPM
+EventPeriod beat_period;
+
+// Profiles of the beat and push button events, sent on UART0 by the 'p' command
+EventProfile beat_profile;
+EventProfile button_profile;
+
 /*
- * Pushbutton callback function for Switch ISR (implements metronome menu)
+ * Set the step period and buzz time of the current BPM and pattern. The period counts from the
+ * current step, and the tempo table gives its fractional ticks in units of 1/BPM tick; a step
+ * is the beat divided by the subdivision of the pattern, in units of 1/(BPM * subdivision) tick.
+ * A step that cannot be played on time is skipped rather than played late.
  */
-void PushButtonMenu(Event *event)
+static void MetronomeSetTempo()
+{
+    const TempoEntry *tempo = TempoLookup(BPM);
+    uint32_t subdivision = PATTERNS[time_signature_selection].subdivision;
+    uint32_t ticks = tempo->period / subdivision;
+    uint32_t remainder = (tempo->period % subdivision) * BPM + tempo->remainder;
+
+#if BEAT_TIMER
+    BeatTimerSetPeriod(ticks, remainder, BPM * subdivision);
+#else
+    EventSetPeriod(&metronome_event, &beat_period, ticks, remainder, BPM * subdivision, EVENT_OVERRUN_SKIP);
+#endif
+    buzz_on_time = tempo->buzz_on / subdivision; // gets total time of buzz (20% of step time is a buzz)
+}
+
+#if BUZZER_CLICKS
+/*
+ * Have the buzzer compute the clicks of every pitch a pattern can play from a pitch setting:
+ * the pair it starts, and the next pair up, for the second voice of a polyrhythm (see
+ * MetronomeClick()). The beats only start them, so this runs before the setting takes effect.
+ */
+static void MetronomePrepareClicks(int pitch)
+{
+    uint32_t voice;
+
+    for (voice = 0; voice < 2; voice++)
+    {
+        BuzzerPrepare((pitch + 2 * voice) % 6);
+        BuzzerPrepare((pitch + 2 * voice) % 6 + 1);
+    }
+}
+#endif
+
+/*
+ * Have the current pattern, pitch and BPM stored in the EEPROM, once they stop changing
+ */
+static void MetronomeSaveSettings()
 {
-    // Process the pushbutton input
+    Settings settings = {time_signature_selection, pitch_index, BPM};
 
+    SettingsUpdate(&settings);
+}
+
+/*
+ * A button press in the menu or while playing
+ */
+static void MetronomeButton(int button)
+{
     // This block runs if outer menu is true
     // Has rotating options for menu and selection
     if (outer_menu == true)
     {
-        switch (PushButtonRead())
+        switch (button)
         {
         case 1:                      // rotate
-            count = (count + 1) % 5; // % 5 so we wrap/rotate all options
+            count = (count + 1) % PATTERN_COUNT; // so we wrap/rotate all options
 
             // updates to menu screen as user rotates options
             Seg7Clear(&seg7);
-            seg7.digit[2] = (TIME_SIGNATURES[count].display_name[0]) - '0'; // subtract '0' to get char as integer
-            seg7.digit[1] = (TIME_SIGNATURES[count].display_name[2]) - '0';
+            seg7.digit[2] = PATTERNS[count].top;
+            seg7.digit[1] = PATTERNS[count].bottom;
             seg7.colon_on = true;
             Seg7Update(&seg7);
 
             break;
 
         case 2: // select
-            RASTriggerReading();
             BPM = RASDataRead(); // get the starting BPM computed from the RAS's position
 
-            // case 2 means user selected a time signature, we now compute the tempo information in milliseconds
-            // we do this just before the schedule to save on processing power
-            beat_time_ms = (60000 / BPM);                // gets total time of 1 beat (on and off time) -- truncation is accepted here
-            buzz_on_time = beat_time_ms * 0.20;          // gets total time of buzz (25% of beat time is a buzz)
-            buzz_off_time = beat_time_ms - buzz_on_time; // subtract from total time to get time the buzzer will be off in one beat
-
             outer_menu = false;               // sets outer menu to false, buttons in play mode will correspond to inner menu
-            play = true;                      // play will be set to true
             time_signature_selection = count; // set the global selection based on current count
             count = 0;                        // reset count to 0 for use in metronome
 
             Seg7Clear(&seg7);      // reset the digits we used for the menu
             seg7.colon_on = false; // turn off the colon before metronome starts counting
-            Seg7Update(&seg7);
-
-            EventSchedule(&metronome_event, 2500); // schedule metronome
+                                   // beat 0 right below sends it with its count, after the buzzer
+
+            // case 2 means user selected a time signature, we now start the periodic metronome event
+            // beat 0 plays right away, every later beat lands on its exact ideal time
+            MetronomeSetTempo();
+            MetronomeSaveSettings();
+#if BEAT_TIMER
+            BeatTimerStart();
+#else
+            EventSchedulePeriodic(&metronome_event, EventGetCurrentTime()); // schedule metronome
+#endif
 
             break;
         }
     }
     else
     { // outer menu was false, so we check inner menu cases
-        switch (PushButtonRead())
+        switch (button)
         {
         case 1: // change buzzer frequency
 
             // changes the frequency of the buzzer by altering the pitch index
             // pitch index is passed to BuzzerSet() in the metronome sequence
+#if BUZZER_CLICKS
+            MetronomePrepareClicks((pitch_index + 2) % 6);
+#endif
             pitch_index = (pitch_index + 2) % 6;
+            MetronomeSaveSettings();
 
             break;
 
         case 2: // turn off current sequence, enter outer menu
             outer_menu = true;
-            play = false;
             count = 0;
+#if BEAT_TIMER
+            BeatTimerStop(); // stop the beats; a beat already posted finds the outer menu on
+            if (metronome_event.flags.scheduled)
+                EventDeschedule(&metronome_event);
+#else
+            EventDeschedule(&metronome_event); // stop the beats
+#endif
+            if (buzzer_off_event.flags.scheduled)
+                EventDeschedule(&buzzer_off_event);
             BuzzerSet(0, 0); // turn off buzzer
 
             // clear the screen and re-display the menu options
             Seg7Clear(&seg7);
-            seg7.digit[2] = (TIME_SIGNATURES[count].display_name[0]) - '0';
-            seg7.digit[1] = (TIME_SIGNATURES[count].display_name[2]) - '0';
+            seg7.digit[2] = PATTERNS[count].top;
+            seg7.digit[1] = PATTERNS[count].bottom;
             seg7.colon_on = true;
             Seg7Update(&seg7);
 
@@ -110,56 +181,110 @@ void PushButtonMenu(Event *event)
     }
 }
 
-// this function carries out the basic metronome sequencing via polling
-// each call indicates the buzzer firing, or time in between each
-void MetronomeSequence(Event *event)
+/*
+ * Pushbutton callback function, scheduled for every debounced input (implements metronome menu)
+ */
+void PushButtonMenu(Event *event)
 {
-    // if outer menu is false then user selected a time signature in the outer menu.
-    // process will not run if the user is in the outer menu.
-    if (outer_menu == false)
+    PushButtonInput input;
+
+    // Process the pushbutton inputs; holding SW1 down in the menu keeps rotating it
+    while (PushButtonGetInput(&input))
     {
-        // if play is true, we want to buzz and count
-        if (play)
-        {
-            seg7.digit[3] = (TIME_SIGNATURES[time_signature_selection]).pattern[count];
-            Seg7Update(&seg7);
+        if (input.type == PUSH_BUTTON_PRESS
+                || (input.type == PUSH_BUTTON_REPEAT && input.buttons == PUSH_BUTTON_SW1 && outer_menu))
+            MetronomeButton(input.buttons);
+    }
+}
 
-            // buzzer on, conditional check to emphasize first beat of each sequence
-            if (count == 0)
-                BuzzerSet(pitch_index + 1, 27);
-            else
-                BuzzerSet(pitch_index, 25);
+// picks up any change of tempo; the next beat then comes one new beat period after the current one
+static void MetronomeFollowKnob()
+{
+    // check the new BPM computed from the RAS's position; the RAS is sampled and
+    // filtered continuously, with hysteresis, so any change is a real one
+    uint32_t new_BPM = RASDataRead();
 
-            count = (count + 1) % (TIME_SIGNATURES[time_signature_selection].beats_per_bar); // increment count and wrap based on pattern length of selected signature
-            play = false;                                                                    // play set to false, next event call will not buzz and wait the remaining time
+    // only change the BPM if its different from the old one
+    if (new_BPM != BPM)
+    {
+        BPM = new_BPM;
+        MetronomeSetTempo();
+        MetronomeSaveSettings();
+        TRACE1(TRACE_TEMPO_CHANGE, BPM);
+    }
+}
 
-            EventSchedule(event, event->time + buzz_on_time);
-        }
-        // if play is false, we want to turn off buzzer and not count
-        else
-        {
-            // buzzer off
-            BuzzerSet(0, 0);
-
-            // only read for tempo update on the first beat of a new bar
-
-            // trigger the RAS sampling process (causes an interrupt on the RAS)
-            RASTriggerReading();
-            uint32_t new_BPM = RASDataRead(); // check the new BPM computed from the RAS's position
-
-            // only change the BPM if its different from the old one
-            if (new_BPM > BPM + 2 || new_BPM < BPM - 2)
-            {
-                BPM = new_BPM;
-                beat_time_ms = (60000 / BPM);
-                buzz_on_time = beat_time_ms * 0.20;
-                buzz_off_time = beat_time_ms - buzz_on_time;
-            }
-
-            play = true;
-            EventSchedule(event, event->time + buzz_off_time);
-        }
+// starts the sound of a pattern step: nothing for a rest, otherwise the click of its level.
+// accents go up to the higher pitch of the pair, and the second voice of a polyrhythm
+// plays the next pair up.
+static void MetronomeClick(uint32_t step)
+{
+    uint32_t level = PATTERN_STEP_LEVEL(step);
+    int pitch = (pitch_index + 2 * PATTERN_STEP_VOICE(step)) % 6 + (level == PATTERN_ACCENT);
+
+    if (level == PATTERN_REST)
+        return;
+
+#if BUZZER_CLICKS
+    // the click plays out and falls silent by itself, so nothing more happens until the next step
+    BuzzerClick(pitch, level);
+#else
+    BuzzerSet(pitch, 24 + level); // 25% to 27% duty cycle, by level
+#endif
+}
+
+#if BEAT_TIMER
+// the beat timer's ISR calls this on every step: the click starts right away, and the rest of
+// the step is left to the event loop
+static void MetronomeBeat()
+{
+    MetronomeClick(PatternStep(&PATTERNS[time_signature_selection], count));
+    EventPost(&metronome_event, EventGetCurrentTime());
+}
+#endif
+
+// this function carries out the basic metronome sequencing
+// the scheduler calls it on every step of the pattern, at the step's ideal time, and runs it again one step period later
+void MetronomeSequence(Event *event)
+{
+    const Pattern *pattern = &PATTERNS[time_signature_selection];
+    uint32_t step = PatternStep(pattern, count);
+
+#if BEAT_TIMER
+    // a beat posted just before the beats stopped
+    if (outer_menu == true)
+        return;
+#endif
+
+    // the display counts the beats; the subdivisions between them leave it alone
+    if (PATTERN_STEP_COUNT(step) != 0)
+    {
+        seg7.digit[3] = PATTERN_STEP_COUNT(step);
+        Seg7Update(&seg7);
     }
+
+#if !BEAT_TIMER
+    // buzzer on, at the level the pattern gives this step; the beat timer's ISR has done it already
+    MetronomeClick(step);
+#endif
+
+    count = PatternNext(pattern, count); // next step, wrapping at the end of the bar
+
+#if BUZZER_CLICKS
+    MetronomeFollowKnob();
+#else
+    // the buzzer turns off once the buzz time of this step is over
+    EventSchedule(&buzzer_off_event, beat_period.time + buzz_on_time);
+#endif
+}
+
+// turns off the buzzer for the rest of the beat, and picks up any change of tempo
+void BuzzerOff(Event *event)
+{
+    // buzzer off
+    BuzzerSet(0, 0);
+
+    MetronomeFollowKnob();
 }
 
 /*
@@ -172,20 +297,43 @@ void main(void)
     Seg7Init();
     BuzzerInit();
     RASInit();
+#if BEAT_TIMER
+    BeatTimerInit(MetronomeBeat);
+#endif
 
     // initialize pushbutton for ISR and callback function
+    // menu work is the least urgent, and runs after any beat ready at the same time
     EventInit(&push_button_event, PushButtonMenu);
+    EventSetPriority(&push_button_event, EVENT_PRIORITY_LOW, 0);
+    EventSetProfile(&push_button_event, &button_profile, "button");
     PushButtonEventRegister(&push_button_event);
 
     // initialize the metronome polling event with it's callback function
+    // beats and the buzzer run first, and should be no more than 1 ms late
     EventInit(&metronome_event, MetronomeSequence);
+    EventSetPriority(&metronome_event, EVENT_PRIORITY_HIGH, MS_TO_TICKS(1));
+    EventSetProfile(&metronome_event, &beat_profile, "beat");
+    EventInit(&buzzer_off_event, BuzzerOff);
+    EventSetPriority(&buzzer_off_event, EVENT_PRIORITY_HIGH, MS_TO_TICKS(1));
 
     uprintf("%s\n\r", "Lab 9 Project: Metronome");
 
+    // restore the pattern, pitch and BPM of the last power-up; the menu starts on that pattern
+    Settings settings;
+    if (SettingsInit(&settings) && settings.pattern < PATTERN_COUNT && settings.pitch < 6 && settings.pitch % 2 == 0)
+    {
+        time_signature_selection = count = settings.pattern;
+        pitch_index = settings.pitch;
+        BPM = settings.bpm;
+    }
+#if BUZZER_CLICKS
+    MetronomePrepareClicks(pitch_index);
+#endif
+
     // initial update to the menu screen before any action is taken by the user
-    // first option is 4/4, so menu displays 4:4
-    seg7.digit[2] = (TIME_SIGNATURES[0].display_name[0]) - '0';
-    seg7.digit[1] = (TIME_SIGNATURES[0].display_name[2]) - '0';
+    // first option is 4/4, so menu displays 4:4, unless another pattern was restored
+    seg7.digit[2] = PATTERNS[count].top;
+    seg7.digit[1] = PATTERNS[count].bottom;
     seg7.colon_on = true;
     Seg7Update(&seg7);
 
@@ -193,8 +341,8 @@ void main(void)
     while (true)
     {
 
-        // Wait for interrupt
-        asm("   wfi");
+        // Wait for interrupt, unless an ISR posted an event since the last pass
+        EventSleep();
 
         // Execute scheduled callbacks
         EventExecute();
@@ -0,0 +1,36 @@
+/*
+ * pattern_table.c: compiled beat patterns of the metronome
+ *
+ * Generated by Host/pattern_compile.c from Program/patterns.txt; do not edit. See pattern_table.h.
+ */
+
+#include <stdint.h>
+#include "pattern_table.h"
+
+const uint32_t PATTERN_COUNT = 9;
+
+// {first, steps, subdivision, top, bottom}
+const Pattern PATTERNS[9] = {
+    {0, 4, 1, 4, 4}, // 4:4     Axxx
+    {4, 3, 1, 3, 4}, // 3:4     Axx
+    {7, 2, 1, 2, 4}, // 2:4     Ax
+    {9, 5, 1, 5, 4}, // 5:4     Axxxx
+    {14, 7, 1, 7, 4}, // 7:4     Axxxxxx
+    {21, 6, 3, 6, 8}, // 6:8/3   Axx axx
+    {27, 7, 1, 7, 8}, // 7:8     Ax ax axx
+    {34, 9, 1, 9, 8}, // 9:8     Ax ax ax axx
+    {43, 6, 3, 3, 2}, // 3:2     A x | a a a
+};
+
+// Steps: count | level << 4 | voice << 6
+const uint8_t PATTERN_STEPS[49] = {
+    0x31, 0x12, 0x13, 0x14, // 4:4
+    0x31, 0x12, 0x13, // 3:4
+    0x31, 0x12, // 2:4
+    0x31, 0x12, 0x13, 0x14, 0x15, // 5:4
+    0x31, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, // 7:4
+    0x31, 0x10, 0x10, 0x22, 0x10, 0x10, // 6:8
+    0x31, 0x12, 0x23, 0x14, 0x25, 0x16, 0x17, // 7:8
+    0x31, 0x12, 0x23, 0x14, 0x25, 0x16, 0x27, 0x18, 0x19, // 9:8
+    0x31, 0x00, 0x60, 0x12, 0x60, 0x00, // 3:2
+};
@@ -0,0 +1,64 @@
+/*
+ * pattern_table.h: compiled beat patterns of the metronome
+ *
+ * ----------------------------
+ *  Created on: Dec 13, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * A pattern is one bar, cut into equal steps: the beats, their subdivisions, and for a
+ * polyrhythm the common subdivision of both voices. Each step is one byte saying what to play
+ * and what to display, so the beat path only indexes and masks. The patterns are written in
+ * Program/patterns.txt and compiled into Program/pattern_table.c by Host/pattern_compile.c;
+ * do not edit the table by hand.
+ */
+
+#ifndef PATTERN_TABLE_H_
+#define PATTERN_TABLE_H_
+
+#include <stdint.h>
+
+// One pattern, in one word of flash
+typedef struct
+{
+    uint32_t first : 10;        // index of its first step in PATTERN_STEPS
+    uint32_t steps : 6;         // steps per bar, 1 to 63
+    uint32_t subdivision : 4;   // steps per beat, 1 to 15; the tempo counts beats
+    uint32_t top : 4;           // menu name, top:bottom, as two digits
+    uint32_t bottom : 4;
+} Pattern;
+
+// A step: the count to display on it (0 for none, on a subdivision), the level of its click
+// (0 for a rest), and the voice that plays it (1 for the second voice of a polyrhythm)
+#define PATTERN_STEP_COUNT(step)    ((step) & 0x0F)
+#define PATTERN_STEP_LEVEL(step)    (((step) >> 4) & 0x03)
+#define PATTERN_STEP_VOICE(step)    (((step) >> 6) & 0x01)
+
+// Click levels
+#define PATTERN_REST        0
+#define PATTERN_NORMAL      1
+#define PATTERN_MEDIUM      2
+#define PATTERN_ACCENT      3
+
+extern const uint32_t PATTERN_COUNT;
+extern const Pattern PATTERNS[];
+extern const uint8_t PATTERN_STEPS[];
+
+// Step of a pattern, in [0, pattern->steps)
+static inline uint32_t PatternStep(const Pattern *pattern, uint32_t step)
+{
+    return PATTERN_STEPS[pattern->first + step];
+}
+
+// Step after the given one, back to the first after the end of the bar
+static inline uint32_t PatternNext(const Pattern *pattern, uint32_t step)
+{
+    step++;
+    return step < pattern->steps ? step : 0;
+}
+
+#endif /* PATTERN_TABLE_H_ */
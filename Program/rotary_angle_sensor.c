@@ -12,6 +12,7 @@
  */
 
 #include "rotary_angle_sensor.h"
+#include "tempo_table.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -20,29 +21,101 @@
 #include <driverlib/sysctl.h>
 #include <driverlib/interrupt.h>
 #include <driverlib/adc.h>
+#include <driverlib/timer.h>
+#include <driverlib/udma.h>
+
+// Sampling: TIMER2A triggers a conversion every RAS_SAMPLE_PERIOD_MS, and the ADC averages
+// RAS_OVERSAMPLE samples in hardware for each one. With RAS_UDMA, the uDMA moves the samples
+// into two buffers of RAS_BLOCK_SIZE in turn (ping-pong), and the ISR runs once per block.
+#define RAS_TIMER_PERIPH        SYSCTL_PERIPH_TIMER2
+#define RAS_TIMER_BASE          TIMER2_BASE
+#if RAS_UDMA
+#define RAS_SAMPLE_PERIOD_MS    1
+#define RAS_OVERSAMPLE          16
+#define RAS_BLOCK_SIZE          32
+#define RAS_DMA_CHANNEL         UDMA_CHANNEL_ADC1   // ADC0 sequencer 1
+#else
+#define RAS_SAMPLE_PERIOD_MS    10
+#define RAS_OVERSAMPLE          64
+#endif
+
+// Filtering: a first-order IIR low-pass on the readings, kept in fixed point with
+// RAS_FILTER_FRAC fraction bits, with a weight of 1/2^RAS_FILTER_SHIFT for each new input.
+// A block mean already averages 32 ms of samples, so it gets a larger weight.
+#define RAS_FILTER_FRAC         4
+#if RAS_UDMA
+#define RAS_FILTER_SHIFT        1
+#else
+#define RAS_FILTER_SHIFT        3
+#endif
+
+// Hysteresis: the reading the tempo comes from follows the filtered reading only when the
+// two are more than this many ADC counts apart (100 BPM over 4095 counts, so 0.2 BPM)
+#define RAS_HYSTERESIS          8
+
+// BPM before the first sample is in
+#define RAS_DEFAULT_BPM         100
 
 // RAS reading states
 typedef struct
 {
-    uint32_t raw_data; // the raw reading from the ADC connected to the RAS
-    uint32_t new_BPM;  // new BPM computed based on the RAS reading
+    uint32_t raw_data;      // the raw reading (or block mean) from the ADC connected to the RAS
+    int32_t filtered;       // IIR-filtered reading, with RAS_FILTER_FRAC fraction bits
+    uint32_t reading;       // the reading the tempo is computed from, after hysteresis
+    bool primed;            // the filter has its first sample
+    uint32_t isr_cycles;    // most CPU cycles spent in the ISR so far
+#if RAS_UDMA
+    uint32_t blocks;        // number of blocks filtered
+    uint32_t overruns;      // blocks lost because both buffers were full
+#endif
 } TempSensorState;
 
 TempSensorState rotary_angle_sensor; // struct object for runtime processes
 
+#if RAS_UDMA
+// Ping-pong buffers, filled by the uDMA from the sequencer FIFO
+static uint16_t ras_buffer[2][RAS_BLOCK_SIZE];
+#endif
+
+// Latest-value slot for the BPM. The ISR is the only writer, and an aligned 32-bit store is
+// atomic, so readers just load it: no lock, no interrupt masking.
+static volatile uint32_t ras_bpm_slot = RAS_DEFAULT_BPM;
+
+#if RAS_UDMA
+// uDMA control structure of each buffer
+static const uint32_t RAS_DMA_SELECT[2] = {UDMA_PRI_SELECT, UDMA_ALT_SELECT};
+
+/*
+ * Point the uDMA control structure of a buffer at it for another block. The other structure
+ * keeps filling its buffer meanwhile.
+ */
+static void RASStartBlock(int buffer)
+{
+    uDMAChannelTransferSet(RAS_DMA_CHANNEL | RAS_DMA_SELECT[buffer], UDMA_MODE_PINGPONG,
+                           (void *) (ADC0_BASE + ADC_O_SSFIFO1), ras_buffer[buffer], RAS_BLOCK_SIZE);
+}
+#endif
+
 /*
  * Initialize ADC to use the external RAS
  *
  * Resources: ADC0, sequence #1, channel 7 (AIN7), aka: ADC_CTL_CH7 <-- corresponds to PD0 on the grover booster, which connects to pin23 on jumper j5
- * Configurations: processor trigger, interrupt enabled on trigger, use step 0 only
+ *            TIMER2A as the ADC trigger, and with RAS_UDMA, uDMA channel 15
+ * Configurations: timer trigger, hardware oversampling, interrupt enabled on each sample
+ *                 (on each block with RAS_UDMA), use step 0 only
  */
 void RASInit()
 {
     // Enable the ADC0 peripheral
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_ADC0);
+
+    // Configure ADC0's sequencer #1, started by the timer
+    ADCSequenceConfigure(ADC0_BASE, 1 /* sequencer */, ADC_TRIGGER_TIMER, 0 /* priority */);
 
-    // Configure ADC0's sequencer #1
-    ADCSequenceConfigure(ADC0_BASE, 1 /* sequencer */, ADC_TRIGGER_PROCESSOR, 0 /* priority */);
+    // Average conversions in hardware for every sample, to remove most of the noise
+    // before the software filter
+    ADCHardwareOversampleConfigure(ADC0_BASE, RAS_OVERSAMPLE);
 
     // Configure step 0 of sequencer 1 to use the RAS, with
     // interrupt enable, as the end of the sequence.
@@ -52,43 +125,154 @@ void RASInit()
     ADCSequenceStepConfigure(ADC0_BASE, 1 /* sequencer */, 0 /* step */,
                              ADC_CTL_CH7 | ADC_CTL_IE | ADC_CTL_END);
 
+#if RAS_UDMA
+    // Set up uDMA channel 15 for ping-pong transfers of 16-bit samples from the sequencer FIFO,
+    // one sample per request, as in the adc_udma_pingpong example of TivaWare. The controller
+    // itself is set up by LaunchPadInit().
+    uDMAChannelAttributeDisable(RAS_DMA_CHANNEL, UDMA_ATTR_ALTSELECT | UDMA_ATTR_HIGH_PRIORITY |
+                                UDMA_ATTR_REQMASK);
+    uDMAChannelControlSet(RAS_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                          UDMA_DST_INC_16 | UDMA_ARB_1);
+    uDMAChannelControlSet(RAS_DMA_CHANNEL | UDMA_ALT_SELECT, UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                          UDMA_DST_INC_16 | UDMA_ARB_1);
+    RASStartBlock(0);
+    RASStartBlock(1);
+    uDMAChannelEnable(RAS_DMA_CHANNEL);
+
+    // The sequencer requests a transfer for each sample; its interrupt now comes once a block
+    // is complete
+    ADCSequenceDMAEnable(ADC0_BASE, 1 /* sequencer */);
+#endif
+
     // Configure the interrupt system for RAS
     ADCIntRegister(ADC0_BASE, 1 /* sequencer */, RotaryAngleSensorISR);
     ADCIntEnable(ADC0_BASE, 1 /* sequencer */);
 
     // Enable ADC0, sequencer 1
     ADCSequenceEnable(ADC0_BASE, 1 /* sequencer */);
+
+    // Configure TIMER2A to trigger the ADC periodically. Only its ADC trigger output is used;
+    // the timer interrupt stays disabled.
+    SysCtlPeripheralEnable(RAS_TIMER_PERIPH);
+    SysCtlPeripheralSleepEnable(RAS_TIMER_PERIPH);
+    TimerConfigure(RAS_TIMER_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(RAS_TIMER_BASE, TIMER_A, RAS_SAMPLE_PERIOD_MS * (CPU_CLOCK_RATE / 1000) - 1);
+    TimerControlTrigger(RAS_TIMER_BASE, TIMER_A, true);
+    TimerEnable(RAS_TIMER_BASE, TIMER_A);
+}
+
+/*
+ * Filter a new reading and publish the BPM
+ */
+static void RASFilter(uint32_t raw_data)
+{
+    TempSensorState *ras = &rotary_angle_sensor;
+    int32_t reading, distance;
+
+    ras->raw_data = raw_data;
+
+    // IIR low-pass: filtered += (sample - filtered) / 2^RAS_FILTER_SHIFT. The first sample
+    // starts the filter, so the tempo is right from the beginning.
+    if (!ras->primed)
+    {
+        ras->filtered = raw_data << RAS_FILTER_FRAC;
+        ras->reading = raw_data;
+        ras->primed = true;
+    }
+    else
+    {
+        ras->filtered += ((int32_t) (raw_data << RAS_FILTER_FRAC) - ras->filtered) >> RAS_FILTER_SHIFT;
+    }
+
+    // Hysteresis: keep the reading until the filtered one has clearly moved away, so that a knob
+    // sitting between two BPMs does not make the tempo flip between them
+    reading = (ras->filtered + (1 << (RAS_FILTER_FRAC - 1))) >> RAS_FILTER_FRAC;
+    distance = reading - (int32_t) ras->reading;
+    if (distance > RAS_HYSTERESIS || distance < -RAS_HYSTERESIS)
+        ras->reading = reading;
+
+    // Look up the BPM of the reading (150 at 0, down to 50 at 4095) in the tempo table,
+    // and publish it
+    ras_bpm_slot = TempoBpmOfReading(ras->reading);
 }
 
+#if !RAS_UDMA
 /*
- * The ISR function: Read the data, mark data ready flag, and
- * schedule the callback event
+ * The ISR function: Read the sample, filter it, and publish the BPM
  */
 void RotaryAngleSensorISR()
 {
+    uint32_t start = CycleCounterGet();
+    uint32_t raw_data;
+
     // Get the data <--> [0, 4095]
-    ADCSequenceDataGet(ADC0_BASE, 1 /* sequencer */, &rotary_angle_sensor.raw_data /* pointer to data buffer */);
+    ADCSequenceDataGet(ADC0_BASE, 1 /* sequencer */, &raw_data /* pointer to data buffer */);
 
-    float ras_BPM_ratio = (rotary_angle_sensor.raw_data / 4095.0);
-    rotary_angle_sensor.new_BPM = 150 - (ras_BPM_ratio * 100);
+    // IMPORTANT: Clear the interrupt flag
+    ADCIntClear(ADC0_BASE, 1 /* sequencer */);
+
+    RASFilter(raw_data);
+
+    // Keep the worst-case ISR time, to measure it on the target
+    uint32_t cycles = CycleCounterGet() - start;
+    if (cycles > rotary_angle_sensor.isr_cycles)
+        rotary_angle_sensor.isr_cycles = cycles;
+}
+#else
+/*
+ * The ISR function: A block is complete. Filter its mean, publish the BPM, and give the
+ * buffer back to the uDMA. The structure that stopped tells which buffer is full.
+ */
+void RotaryAngleSensorISR()
+{
+    uint32_t start = CycleCounterGet();
+    uint32_t sum;
+    int buffer, i;
 
     // IMPORTANT: Clear the interrupt flag
     ADCIntClear(ADC0_BASE, 1 /* sequencer */);
+
+    for (buffer = 0; buffer < 2; buffer++)
+    {
+        if (uDMAChannelModeGet(RAS_DMA_CHANNEL | RAS_DMA_SELECT[buffer]) != UDMA_MODE_STOP)
+            continue;
+
+        sum = 0;
+        for (i = 0; i < RAS_BLOCK_SIZE; i++)
+            sum += ras_buffer[buffer][i];
+        RASFilter((sum + RAS_BLOCK_SIZE / 2) / RAS_BLOCK_SIZE);
+        rotary_angle_sensor.blocks++;
+
+        RASStartBlock(buffer);
+    }
+
+    // Both structures stopped means the uDMA ran out of buffers, and disabled the channel
+    if (!uDMAChannelIsEnabled(RAS_DMA_CHANNEL))
+    {
+        rotary_angle_sensor.overruns++;
+        uDMAChannelEnable(RAS_DMA_CHANNEL);
+    }
+
+    // Keep the worst-case ISR time, to measure it on the target
+    uint32_t cycles = CycleCounterGet() - start;
+    if (cycles > rotary_angle_sensor.isr_cycles)
+        rotary_angle_sensor.isr_cycles = cycles;
 }
+#endif
 
 /*
- * Trigger RAS reading
+ * Returns the latest BPM computed from the filtered RAS readings. This is a plain load of
+ * the latest-value slot, so it never blocks and may be called from anywhere.
  */
-void RASTriggerReading()
+int RASDataRead()
 {
-    // Trigger the sampling
-    ADCProcessorTrigger(ADC0_BASE, 1 /* sequencer */);
+    return ras_bpm_slot;
 }
 
 /*
- * Returns the new BPM that was computed during the previous manual trigger and ISR
+ * Returns the most CPU cycles the ISR has taken so far
  */
-int RASDataRead()
+uint32_t RASIsrCycles()
 {
-    return rotary_angle_sensor.new_BPM;
+    return rotary_angle_sensor.isr_cycles;
 }
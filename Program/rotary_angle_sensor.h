@@ -16,16 +16,24 @@
 
 #include "launchpad.h" // so event objects can be used in function prototypes
 
+// ADC backend. With RAS_UDMA, the uDMA streams the samples into two buffers in turn, and the
+// ISR runs once per block of samples instead of once per sample. Define to 0 for one interrupt
+// per sample.
+#ifndef RAS_UDMA
+#define RAS_UDMA 1
+#endif
+
 // Initialize ADC to use the RAS on jumper 5
 void RASInit();
 
-// Trigger RAS reading/sampling
-void RASTriggerReading();
-
-// Return RAS reading after properly interpreting raw data
+// Return the latest BPM from the RAS, filtered and with hysteresis. The RAS is sampled
+// continuously, so this is a non-blocking load that never returns a stale trigger's result.
 int RASDataRead();
 
 // The ISR function
 void RotaryAngleSensorISR();
 
+// Return the most CPU cycles the ISR has taken so far
+uint32_t RASIsrCycles();
+
 #endif /* ROTARY_ANGLE_SENSOR_H_ */
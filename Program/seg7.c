@@ -70,25 +70,54 @@ static uint8_t seg7_coding_table[36] = {
     0b01011011, // Z
 };
 
+#define SEG7_TABLE_SIZE (sizeof(seg7_coding_table) / sizeof(seg7_coding_table[0]))
+
+/*
+ * Pending update. Seg7Update() only encodes the digits; the flush event, scheduled for the
+ * current time, sends them once the running callback returns. All updates requested within
+ * one EventExecute() pass thus go to the display as a single update.
+ */
+static uint8_t seg7_pending_code[4];
+static Event seg7_flush_event;
+static EventProfile seg7_flush_profile;
+
+static void Seg7Flush(Event *event)
+{
+    Seg7RawUpdate(seg7_pending_code);
+}
+
+// Get the raw encoding of a digit; blank (SEG7_BLANK) and any other digit outside the table
+// has all segments off
+static uint8_t Seg7Encode(uint8_t digit)
+{
+    return (digit < SEG7_TABLE_SIZE) ? seg7_coding_table[digit] : 0b00000000;
+}
+
 /*
  * Update the 7-segment display using the Seg7Display structure.
  */
 void Seg7Update(Seg7Display *seg7)
 {
-    uint8_t seg7_code[4];
     uint8_t colon_code;
 
     // Get the raw encoding for the colon
     colon_code = seg7->colon_on ? 0b10000000 : 0b00000000;
 
     // Get the raw encoding for 7-segment digits
-    seg7_code[0] = seg7_coding_table[seg7->digit[0]] + colon_code;
-    seg7_code[1] = seg7_coding_table[seg7->digit[1]] + colon_code;
-    seg7_code[2] = seg7_coding_table[seg7->digit[2]] + colon_code;
-    seg7_code[3] = seg7_coding_table[seg7->digit[3]] + colon_code;
+    seg7_pending_code[0] = Seg7Encode(seg7->digit[0]) + colon_code;
+    seg7_pending_code[1] = Seg7Encode(seg7->digit[1]) + colon_code;
+    seg7_pending_code[2] = Seg7Encode(seg7->digit[2]) + colon_code;
+    seg7_pending_code[3] = Seg7Encode(seg7->digit[3]) + colon_code;
 
-    // Update the 7-segment
-    Seg7RawUpdate(seg7_code);
+    // Update the 7-segment once the current callback is done
+    if (!EventInitialized(&seg7_flush_event))
+    {
+        EventInit(&seg7_flush_event, Seg7Flush);
+        EventSetPriority(&seg7_flush_event, EVENT_PRIORITY_LOW, 0);
+        EventSetProfile(&seg7_flush_event, &seg7_flush_profile, "display");
+    }
+    if (!seg7_flush_event.flags.scheduled)
+        EventSchedule(&seg7_flush_event, EventGetCurrentTime());
 }
 
 /*
@@ -96,8 +125,8 @@ void Seg7Update(Seg7Display *seg7)
  */
 void Seg7Clear(Seg7Display *seg7)
 {
-    seg7->digit[3] = 0xFF;
-    seg7->digit[2] = 0xFF;
-    seg7->digit[1] = 0xFF;
-    seg7->digit[0] = 0xFF;
+    seg7->digit[3] = SEG7_BLANK;
+    seg7->digit[2] = SEG7_BLANK;
+    seg7->digit[1] = SEG7_BLANK;
+    seg7->digit[0] = SEG7_BLANK;
 }
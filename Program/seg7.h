@@ -17,13 +17,26 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "event.h" // for the update done event
 
 #ifndef SEG7_H_
 #define SEG7_H_
 
+/*
+ * TM1637 transport. With SEG7_ASYNC, Seg7RawUpdate() queues the update and returns right away,
+ * and a timer interrupt clocks it out to the display in the background. Define to 0 for the
+ * original bit-banging, which busy-waits until the update is sent.
+ */
+#ifndef SEG7_ASYNC
+#define SEG7_ASYNC 1
+#endif
+
 /*
  * The state of the 4-digit 7-segment display
  */
+// Digit value that leaves a digit blank
+#define SEG7_BLANK 0xFF
+
 typedef struct
 {
     uint8_t digit[4]; // 4 digits, digit[0] for the right most
@@ -34,16 +47,26 @@ typedef struct
  * Interface functions
  */
 
-// Initialize the port connection to TiM1637 and the 7-segment display
+// Initialize the port connection to TM1637 and the 7-segment display
 void Seg7Init();
 
-// Update all 4 digits of the 7-segment displays
+// Update the 7-segment displays with raw codes; only the digits that changed are sent
 void Seg7RawUpdate(uint8_t code[]);
 
-// Update the 4-digit 7-segment display with digit numbers (not 7-segment display pattern)
+// Update the 4-digit 7-segment display with digit numbers (not 7-segment display pattern).
+// The update is sent after the current event callback, together with any later update in it.
 void Seg7Update(Seg7Display *seg7);
 
 // Updates all digits to be blank -- a commonly used task for this project
 void Seg7Clear(Seg7Display *seg7);
 
+// Set an event to be scheduled whenever the display has received the latest update
+void Seg7RegisterDoneEvent(Event *done_event);
+
+// Return true while an update is being sent to the display
+bool Seg7Busy();
+
+// Return the average CPU cycles the transport has spent per update, for comparing both modes
+uint32_t Seg7RawCyclesPerUpdate();
+
 #endif /* SEG7_H_ */
@@ -1,17 +1,22 @@
 /*
- * seg7.c: Communication functions with the TiM1637 chip used with the Groove 4-digit 7-segment display.
+ * seg7.c: Communication functions with the TM1637 chip used with the Groove 4-digit 7-segment display.
  *
  * ----------------------------
  *  Created and Provided by:
  *     Zhao Zhang @ UIC
  * ----------------------------
  *
- * TiM1637 uses an I2C-like protocol, but it is not I2C-compatible. See the data sheet of TiM1637 for the
+ * TM1637 uses an I2C-like protocol, but it is not I2C-compatible. See the data sheet of TM1637 for the
  * required timing.  It uses the same signal forms for the START, STOP and data bits of I2C, the data byte format
  * is similar, but it does not follow the packet format (address byte followed by data bytes) of I2C.
  *
  * It seems that the only practical way is to use bit-banging, as done in this program file. Note that bit-banging
  * is not CPU-efficient and should be avoided whenever possible.
+ *
+ * With SEG7_ASYNC (see seg7.h) the same signal forms are produced by a timer interrupt instead: an update is
+ * compiled into a list of steps, one per clock cycle, and the timer ISR writes one of them per period. A step is
+ * either a whole clock pulse, for a data bit or an ACK, or a DIO edge while CLK is high, for START and STOP. The
+ * CPU is then free between two steps, instead of busy-waiting for the whole update.
  */
 
 #include <stdint.h>
@@ -19,13 +24,17 @@
 #include <stdio.h>
 #include <driverlib/sysctl.h>
 #include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <inc/hw_gpio.h>
 #include <driverlib/gpio.h>
 #include <driverlib/pin_map.h>
+#include <driverlib/timer.h>
+#include <driverlib/interrupt.h>
 #include "launchpad.h"
 #include "seg7.h"
 
-// MCU connections to TiM1637's CLK and DIO pins. The default pin connections are as follows:
-//	MCU Pin		Grove Pin		TiM1637 Pin
+// MCU connections to TM1637's CLK and DIO pins. The default pin connections are as follows:
+//	MCU Pin		Grove Pin		TM1637 Pin
 //	  PA6		  J10 SCL	      CLK
 //	  PA7		  J10 SDA		  DIO
 // CHANGE THE MACROS if you use a different jumper of the Grove boosterpack.
@@ -38,8 +47,57 @@
 #define HALF_CCT		5					// Half clock cycle is 5 milliseconds
 #define DELTA			1					// Time difference between CLK and DIO change, for tolerance
 
-// Initialize the port connection to TiM1637 and the 7-segment display. TiM1637 is connected to
-// the SCL and SDA pins of I2C #1, which are PA6 and PA7, respectively. However, TiM1637 is NOT I2C
+// Transport statistics, for comparing the CPU cost of the blocking and asynchronous modes
+static struct {
+	uint32_t updates;				// number of updates sent
+	uint64_t cycles;				// CPU cycles spent sending them
+} tm_stats;
+
+#if SEG7_ASYNC
+// Timer that clocks out the steps, one per clock cycle. Its interrupt has the lowest
+// priority, since the display does not mind a step coming late.
+#define TM_TIMER_PERIPH	SYSCTL_PERIPH_TIMER1
+#define TM_TIMER_BASE	TIMER1_BASE
+#define TM_TIMER_INT	INT_TIMER1A
+#define TM_PRIORITY		0xE0
+
+// Cycles of the exception entry and exit of each step, which the cycle counter cannot see from
+// inside the ISR: 12 cycles each way, without floating-point state
+#define TM_ENTRY_EXIT	24
+
+// SysCtlDelay() count that holds CLK low for 0.5 us within a pulse; TM1637 needs 400 ns
+#define CLK_LOW_DELAY	(CPU_CLOCK_RATE / 2000000 / 3)
+
+// The GPIO data register, at the address that masks all the pins but the given ones
+#define TM_DATA(pins)	HWREG(PORT + GPIO_O_DATA + ((pins) << 2))
+
+// Pin states of a step
+#define STEP_CLK		0x01				// CLK high
+#define STEP_DIO		0x02				// DIO high
+#define STEP_DIO_IN		0x04				// DIO is an input (ACK from TM1637)
+#define STEP_PULSE		0x08				// CLK low with this DIO, then high again
+
+// Steps of the longest update, the first one: three STARTs and STOPs, and seven bytes with their
+// ACKs. tmCompose() never picks anything longer.
+#define MAX_STEPS		(3 * (2 + 2) + 7 * (8 + 1))
+
+// Transport state shared with the timer ISR
+static struct {
+	uint8_t steps[MAX_STEPS];		// the update being sent
+	uint8_t count;					// number of steps
+	uint8_t next;					// next step to write
+	bool dio_in;					// DIO is currently an input
+	volatile bool busy;				// an update is being sent
+	volatile bool pending;			// another update is waiting
+	uint8_t pending_code[4];		// the waiting update; a newer one replaces it
+	Event *done_event;				// scheduled when the display is up to date
+} tm;
+
+static void tmTimerISR();
+#endif
+
+// Initialize the port connection to TM1637 and the 7-segment display. TM1637 is connected to
+// the SCL and SDA pins of I2C #1, which are PA6 and PA7, respectively. However, TM1637 is NOT I2C
 // comptatible and thus we have to use PA6 and PA7 as GPIO pins (and use bit banging to emulate
 // the START, STOP, and data bits of I2C).
 void
@@ -47,6 +105,7 @@ Seg7Init()
 {
 	// Enable GPIO Port B as peripheral.
 	SysCtlPeripheralEnable(PORT_PERIPH);
+	SysCtlPeripheralSleepEnable(PORT_PERIPH);
 
     // Set the pads for standard push-pull operation, with 8ma strength
     GPIOPadConfigSet(PORT, CLK | DIO, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_OD);
@@ -56,8 +115,53 @@ Seg7Init()
 
     // Initial states are high
     GPIOPinWrite(PORT, CLK | DIO, CLK | DIO);
+
+#if SEG7_ASYNC
+    // Configure the step timer with a period of a clock cycle. It is enabled when an update is
+    // started, and disabled when the last step is written.
+    SysCtlPeripheralEnable(TM_TIMER_PERIPH);
+    SysCtlPeripheralSleepEnable(TM_TIMER_PERIPH);
+    TimerConfigure(TM_TIMER_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(TM_TIMER_BASE, TIMER_A, 2 * HALF_CCT * (CPU_CLOCK_RATE / 1000000) - 1);
+    TimerIntRegister(TM_TIMER_BASE, TIMER_A, tmTimerISR);
+    TimerIntEnable(TM_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    IntPrioritySet(TM_TIMER_INT, TM_PRIORITY);
+#endif
+}
+
+// Set an event to be scheduled whenever the display has received the latest update
+void
+Seg7RegisterDoneEvent(Event *done_event)
+{
+#if SEG7_ASYNC
+	assert(EventInitialized(done_event));
+	tm.done_event = done_event;
+#endif
+}
+
+// Return true while an update is being sent to the display
+bool
+Seg7Busy()
+{
+#if SEG7_ASYNC
+	return tm.busy;
+#else
+	return false;
+#endif
 }
 
+// Return the average CPU cycles the transport has spent per update, including the exception
+// entry and exit of the step interrupts
+uint32_t
+Seg7RawCyclesPerUpdate()
+{
+	if (tm_stats.updates == 0)
+		return 0;
+	return tm_stats.cycles / tm_stats.updates;
+}
+
+#if !SEG7_ASYNC
+
 // Send START bit of I2C: Keep CLK high (inactive), pull DIO from high to low.
 static void
 tmSendStart()
@@ -141,31 +245,281 @@ tmSendByte(uint8_t byte)
 	}
 }
 
-// Update all 4 digits of the 7-segment displays
-void
-Seg7RawUpdate(uint8_t code[])
+// Frame primitives for tmCompose(): the bits go out right away
+static void
+tmFrameStart()
 {
 	tmSendStart();
-	tmSendByte(0x40);
-	tmWaitAck();
-	tmSendStop();
+}
 
-	tmSendStart();
-	tmSendByte(0xc0);
-	tmWaitAck();
-	tmSendByte(code[3]);
-	tmWaitAck();
-	tmSendByte(code[2]);
-	tmWaitAck();
-	tmSendByte(code[1]);
-	tmWaitAck();
-	tmSendByte(code[0]);
+static void
+tmFrameByte(uint8_t byte)
+{
+	tmSendByte(byte);
 	tmWaitAck();
-	tmSendStop();
+}
 
-	tmSendStart();
-	tmSendByte(0x8A);
-	tmWaitAck();
+static void
+tmFrameStop()
+{
 	tmSendStop();
 }
 
+#else
+
+// Append a step to the update
+static void
+tmQueue(uint8_t step)
+{
+	assert(tm.count < MAX_STEPS);
+	tm.steps[tm.count++] = step;
+}
+
+// START: DIO goes low while CLK is high
+static void
+tmQueueStart()
+{
+	tmQueue(STEP_CLK | STEP_DIO);
+	tmQueue(STEP_CLK);
+}
+
+// Eight data bits, from LSB to MSB, a clock pulse each. DIO changes while CLK is low.
+static void
+tmQueueByte(uint8_t byte)
+{
+	int i;
+
+	for (i = 0; i < 8; i++, byte >>= 1)
+		tmQueue(STEP_PULSE | ((byte & 0b00000001) ? STEP_DIO : 0));
+}
+
+// One clock pulse with DIO released, for the ACK (which is not checked)
+static void
+tmQueueAck()
+{
+	tmQueue(STEP_PULSE | STEP_DIO_IN);
+}
+
+// STOP: a clock pulse with DIO low, then DIO goes high while CLK is high
+static void
+tmQueueStop()
+{
+	tmQueue(STEP_PULSE);
+	tmQueue(STEP_CLK | STEP_DIO);
+}
+
+// Frame primitives for tmCompose(): the bits are queued as steps for the step timer
+static void
+tmFrameStart()
+{
+	tmQueueStart();
+}
+
+static void
+tmFrameByte(uint8_t byte)
+{
+	tmQueueByte(byte);
+	tmQueueAck();
+}
+
+static void
+tmFrameStop()
+{
+	tmQueueStop();
+}
+
+#endif
+
+/*
+ * Dirty-digit diffing. The driver keeps a copy of the digits last sent, and sends only the digits
+ * that differ. TM1637 keeps its data command mode between frames, so the changed digits go either
+ * as one auto-increment run from the first changed digit to the last, or each with its own address
+ * in fixed-address mode, whichever takes fewer clock cycles on the bus.
+ */
+#define DATA_AUTO_INCREMENT	0x40
+#define DATA_FIXED_ADDRESS	0x44
+#define DISPLAY_ON			0x8A				// display on, brightness 2 of 7
+
+// Bus cost in half clock cycles: a byte with its ACK, and the START and STOP around a frame
+#define BYTE_COST			(9 * 2)
+#define FRAME_COST			(2 + 3)
+
+static struct {
+	uint8_t code[4];				// digits as last sent, in code[] order
+	uint8_t data_command;			// data command mode of TM1637, 0 before the first update
+} tm_shadow;
+
+// Send the frames that bring the display from the shadow to the given code. TM1637 grid
+// address 0 is the leftmost digit, code[3]. Return false if there is nothing to send.
+static bool
+tmCompose(uint8_t code[])
+{
+	bool first_update = (tm_shadow.data_command == 0);
+	int addr, first = -1, last = -1, count = 0;
+	int auto_cost, fixed_cost;
+	uint8_t mode;
+
+	for (addr = 0; addr < 4; addr++) {
+		if (first_update || code[3 - addr] != tm_shadow.code[3 - addr]) {
+			if (first < 0)
+				first = addr;
+			last = addr;
+			count++;
+		}
+	}
+	if (count == 0)
+		return false;
+
+	auto_cost = FRAME_COST + (1 + last - first + 1) * BYTE_COST;
+	fixed_cost = count * (FRAME_COST + 2 * BYTE_COST);
+	if (tm_shadow.data_command != DATA_AUTO_INCREMENT)
+		auto_cost += FRAME_COST + BYTE_COST;
+	if (tm_shadow.data_command != DATA_FIXED_ADDRESS)
+		fixed_cost += FRAME_COST + BYTE_COST;
+
+	// On a tie, stay in the current mode
+	if (auto_cost == fixed_cost)
+		mode = first_update ? DATA_AUTO_INCREMENT : tm_shadow.data_command;
+	else
+		mode = (auto_cost < fixed_cost) ? DATA_AUTO_INCREMENT : DATA_FIXED_ADDRESS;
+
+	if (mode != tm_shadow.data_command) {
+		tmFrameStart();
+		tmFrameByte(mode);
+		tmFrameStop();
+		tm_shadow.data_command = mode;
+	}
+
+	if (mode == DATA_AUTO_INCREMENT) {
+		tmFrameStart();
+		tmFrameByte(0xc0 | first);
+		for (addr = first; addr <= last; addr++)
+			tmFrameByte(code[3 - addr]);
+		tmFrameStop();
+	}
+	else {
+		for (addr = first; addr <= last; addr++) {
+			if (first_update || code[3 - addr] != tm_shadow.code[3 - addr]) {
+				tmFrameStart();
+				tmFrameByte(0xc0 | addr);
+				tmFrameByte(code[3 - addr]);
+				tmFrameStop();
+			}
+		}
+	}
+
+	// The display control setting is kept, so it only needs to be sent once
+	if (first_update) {
+		tmFrameStart();
+		tmFrameByte(DISPLAY_ON);
+		tmFrameStop();
+	}
+
+	for (addr = 0; addr < 4; addr++)
+		tm_shadow.code[addr] = code[addr];
+
+	return true;
+}
+
+#if !SEG7_ASYNC
+
+// Update the digits of the 7-segment displays that have changed since the last update
+void
+Seg7RawUpdate(uint8_t code[])
+{
+	uint32_t start = CycleCounterGet();
+
+	if (tmCompose(code))
+		tm_stats.updates++;
+
+	tm_stats.cycles += CycleCounterGet() - start;
+}
+
+#else
+
+// Compile an update into steps, and start the step timer. Return false if the display already
+// shows the update, in which case there is nothing to start.
+static bool
+tmStart(uint8_t code[])
+{
+	tm.count = 0;
+	tm.next = 0;
+
+	if (!tmCompose(code))
+		return false;
+
+	tm.busy = true;
+	tm_stats.updates++;
+	TimerEnable(TM_TIMER_BASE, TIMER_A);
+	return true;
+}
+
+// Display is up to date: stop the step timer and report it
+static void
+tmFinish()
+{
+	TimerDisable(TM_TIMER_BASE, TIMER_A);
+	tm.busy = false;
+	if (tm.done_event != NULL)
+		EventPost(tm.done_event, EventGetCurrentTime());
+}
+
+// Step timer ISR: write the next step to the pins, and finish or chain the update after the last
+static void
+tmTimerISR()
+{
+	uint32_t start = CycleCounterGet();
+	uint8_t step = tm.steps[tm.next++];
+
+	TimerIntClear(TM_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+	// CLK and DIO in one write. A pulse lowers CLK, and DIO may change at the same time, since
+	// TM1637 samples it on the rising edge; the other steps keep CLK high and move DIO only.
+	// DIO turns around while CLK is low, and an input pin ignores the written level.
+	TM_DATA(CLK | DIO) = ((step & STEP_CLK) ? CLK : 0) | ((step & STEP_DIO) ? DIO : 0);
+	if (((step & STEP_DIO_IN) != 0) != tm.dio_in) {
+		tm.dio_in = !tm.dio_in;
+		GPIODirModeSet(PORT, DIO, tm.dio_in ? GPIO_DIR_MODE_IN : GPIO_DIR_MODE_OUT);
+	}
+	if (step & STEP_PULSE) {
+		SysCtlDelay(CLK_LOW_DELAY);
+		TM_DATA(CLK) = CLK;
+	}
+
+	if (tm.next == tm.count) {
+		// Send the update that came in meanwhile, if it changes anything
+		bool chained = tm.pending && tmStart(tm.pending_code);
+
+		tm.pending = false;
+		if (!chained)
+			tmFinish();
+	}
+
+	tm_stats.cycles += CycleCounterGet() - start + TM_ENTRY_EXIT;
+}
+
+// Update the digits of the 7-segment displays that have changed. The update is sent in the
+// background; if another one is still being sent, it waits and is replaced by any newer update.
+void
+Seg7RawUpdate(uint8_t code[])
+{
+	uint32_t start = CycleCounterGet();
+	int i;
+
+	// Keep the step timer ISR from finishing the current update in the middle
+	IntDisable(TM_TIMER_INT);
+	if (tm.busy) {
+		for (i = 0; i < 4; i++)
+			tm.pending_code[i] = code[i];
+		tm.pending = true;
+	}
+	else if (!tmStart(code)) {
+		tmFinish();
+	}
+	IntEnable(TM_TIMER_INT);
+
+	tm_stats.cycles += CycleCounterGet() - start;
+}
+
+#endif
+
@@ -0,0 +1,204 @@
+/*
+ * settings.c: settings kept in the EEPROM across power-ups
+ *
+ * ----------------------------
+ *  Created on: Dec 14, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * The EEPROM is a ring of 16-byte records, written in turn and never erased. Record N of the
+ * write sequence goes into slot N % SETTINGS_SLOTS, so every slot wears alike, and it carries N
+ * and a CRC-32, so the newest one can be told from the others and a write cut short by a power
+ * loss fails its check. The slots written in the current lap of the ring come first, with
+ * sequence numbers of that lap; a binary search finds the last of them in log2(SETTINGS_SLOTS)
+ * reads. If that record fails its check, the ones before it are tried, a few at most.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/eeprom.h>
+#include <driverlib/sw_crc.h>
+#include "settings.h"
+
+#define SETTINGS_VERSION    1           // layout of the settings in a record
+#define SETTINGS_SLOTS      128         // records in the 2 KB EEPROM
+#define SETTINGS_FALLBACK   4           // older records tried after a failed check
+#define SETTINGS_ERASED     0xFFFFFFFF  // a word never written
+
+// One record, four words
+typedef struct
+{
+    uint32_t sequence;      // number of the write since the EEPROM was erased
+    uint8_t version;
+    uint8_t pattern;
+    uint8_t pitch;
+    uint8_t bpm;
+    uint32_t reserved;      // 0
+    uint32_t crc;           // CRC-32 of the words before it
+} SettingsRecord;
+
+static struct
+{
+    bool available;         // the EEPROM started up
+    Event write_event;
+    uint32_t sequence;      // of the newest record, SETTINGS_ERASED for none
+    Settings stored;        // the settings in the newest record
+    Settings pending;       // the settings to write
+    uint32_t writes;
+    uint32_t init_reads;
+} store;
+
+static uint32_t SlotAddress(uint32_t slot)
+{
+    return slot * sizeof(SettingsRecord);
+}
+
+static uint32_t RecordCrc(const SettingsRecord *record)
+{
+    return Crc32(0xFFFFFFFF, (const uint8_t *) record, offsetof(SettingsRecord, crc)) ^ 0xFFFFFFFF;
+}
+
+// Sequence number of a slot; the other words of the record are not read
+static uint32_t SlotSequence(uint32_t slot)
+{
+    uint32_t sequence;
+
+    EEPROMRead(&sequence, SlotAddress(slot), sizeof(sequence));
+    store.init_reads++;
+    return sequence;
+}
+
+// Whether a slot was written in the given lap of the ring
+static bool SlotInLap(uint32_t slot, uint32_t lap)
+{
+    uint32_t sequence = SlotSequence(slot);
+
+    return sequence != SETTINGS_ERASED && sequence % SETTINGS_SLOTS == slot && sequence / SETTINGS_SLOTS == lap;
+}
+
+// Read a slot; return true if it holds a valid record of the expected sequence number
+static bool SlotRead(uint32_t slot, uint32_t sequence, SettingsRecord *record)
+{
+    EEPROMRead((uint32_t *) record, SlotAddress(slot), sizeof(*record));
+    store.init_reads += sizeof(*record) / 4;
+    return record->sequence == sequence && record->version == SETTINGS_VERSION && record->crc == RecordCrc(record);
+}
+
+/*
+ * Find the newest valid record; return its sequence number, SETTINGS_ERASED for none
+ */
+static uint32_t SettingsFind(SettingsRecord *record)
+{
+    uint32_t newest, lap, low, high, i, sequence = SlotSequence(0);
+
+    // The newest write is at or after slot 0 in its lap, or slot 0 holds a write cut short
+    // and the newest is the last slot, of the lap before
+    if (sequence != SETTINGS_ERASED && sequence % SETTINGS_SLOTS == 0)
+    {
+        lap = sequence / SETTINGS_SLOTS;
+
+        // Slots [0, low] are of this lap, and [high, SETTINGS_SLOTS) are not
+        low = 0;
+        high = SETTINGS_SLOTS;
+        while (high - low > 1)
+        {
+            uint32_t middle = (low + high) / 2;
+            if (SlotInLap(middle, lap))
+                low = middle;
+            else
+                high = middle;
+        }
+        newest = lap * SETTINGS_SLOTS + low;
+    }
+    else
+    {
+        sequence = SlotSequence(SETTINGS_SLOTS - 1);
+        if (sequence == SETTINGS_ERASED || sequence % SETTINGS_SLOTS != SETTINGS_SLOTS - 1)
+            return SETTINGS_ERASED;
+        newest = sequence;
+    }
+
+    // Step back over records cut short
+    for (i = 0; i <= SETTINGS_FALLBACK && i <= newest; i++)
+        if (SlotRead((newest - i) % SETTINGS_SLOTS, newest - i, record))
+            return newest - i;
+
+    return SETTINGS_ERASED;
+}
+
+/*
+ * Write event: append the pending settings, unless the newest record holds them already
+ */
+static void SettingsWrite(Event *event)
+{
+    SettingsRecord record;
+
+    if (store.sequence != SETTINGS_ERASED && memcmp(&store.pending, &store.stored, sizeof(Settings)) == 0)
+        return;
+
+    record.sequence = store.sequence + 1; // 0 after none
+    record.version = SETTINGS_VERSION;
+    record.pattern = store.pending.pattern;
+    record.pitch = store.pending.pitch;
+    record.bpm = store.pending.bpm;
+    record.reserved = 0;
+    record.crc = RecordCrc(&record);
+
+    if (EEPROMProgram((uint32_t *) &record, SlotAddress(record.sequence % SETTINGS_SLOTS), sizeof(record)) != 0)
+        return;
+
+    store.sequence = record.sequence;
+    store.stored = store.pending;
+    store.writes++;
+}
+
+bool SettingsInit(Settings *settings)
+{
+    SettingsRecord record;
+
+    // The settings are written when nothing more urgent is ready
+    EventInit(&store.write_event, SettingsWrite);
+    EventSetPriority(&store.write_event, EVENT_PRIORITY_LOW, 0);
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    store.available = EEPROMInit() == EEPROM_INIT_OK && EEPROMSizeGet() >= SETTINGS_SLOTS * sizeof(SettingsRecord);
+    store.sequence = SETTINGS_ERASED;
+    if (!store.available)
+        return false;
+
+    store.sequence = SettingsFind(&record);
+    if (store.sequence == SETTINGS_ERASED)
+        return false;
+
+    store.stored.pattern = record.pattern;
+    store.stored.pitch = record.pitch;
+    store.stored.bpm = record.bpm;
+    *settings = store.stored;
+    return true;
+}
+
+void SettingsUpdate(const Settings *settings)
+{
+    if (!store.available)
+        return;
+
+    store.pending = *settings;
+    EventSchedule(&store.write_event, EventGetCurrentTime() + SETTINGS_WRITE_DELAY);
+}
+
+uint32_t SettingsWriteCount()
+{
+    return store.writes;
+}
+
+uint32_t SettingsInitReads()
+{
+    return store.init_reads;
+}
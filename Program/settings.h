@@ -0,0 +1,44 @@
+/*
+ * settings.h: settings kept in the EEPROM across power-ups
+ *
+ * ----------------------------
+ *  Created on: Dec 14, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ */
+
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "launchpad.h"
+
+// The settings that survive a power-up
+typedef struct
+{
+    uint8_t pattern;    // menu position of the beat pattern
+    uint8_t pitch;      // pitch index of the buzzer
+    uint8_t bpm;        // last tempo; the knob sets it again once the metronome plays
+} Settings;
+
+// Delay from a change of the settings to their EEPROM write. Further changes in that time push
+// the write back, so that turning the knob writes once, after the knob has settled.
+#define SETTINGS_WRITE_DELAY    MS_TO_TICKS(2000)
+
+// Set up the EEPROM and the write event, and copy the newest valid settings into *settings.
+// Return false, with *settings unchanged, if the EEPROM holds none.
+bool SettingsInit(Settings *settings);
+
+// Have the settings written SETTINGS_WRITE_DELAY from now, unless they are those stored already
+void SettingsUpdate(const Settings *settings);
+
+// Records written since power-up, and EEPROM words read by SettingsInit() to find the newest
+uint32_t SettingsWriteCount();
+uint32_t SettingsInitReads();
+
+#endif /* SETTINGS_H_ */
@@ -0,0 +1,138 @@
+/*
+ * tempo_table.c: precomputed tempo values for the metronome
+ *
+ * Generated by Host/tempo_table_gen.c; do not edit. See tempo_table.h.
+ */
+
+#include <stdint.h>
+#include "event.h"
+#include "tempo_table.h"
+
+#if EVENT_TICK_RATE != 50000000ULL || TEMPO_ADC_SHIFT != 4 || TEMPO_MIN_BPM != 50 || TEMPO_MAX_BPM != 150
+#error "tempo_table.c is out of date; regenerate it with make tempo_table in Host/"
+#endif
+
+// BPM by reading >> 4, computed for the lowest reading of each entry
+const uint8_t TEMPO_BPM_OF_READING[TEMPO_ADC_ENTRIES] = {
+    150, 149, 149, 148, 148, 148, 147, 147, 146, 146, 146, 145, 145, 144, 144, 144,
+    143, 143, 142, 142, 142, 141, 141, 141, 140, 140, 139, 139, 139, 138, 138, 137,
+    137, 137, 136, 136, 135, 135, 135, 134, 134, 133, 133, 133, 132, 132, 132, 131,
+    131, 130, 130, 130, 129, 129, 128, 128, 128, 127, 127, 126, 126, 126, 125, 125,
+    124, 124, 124, 123, 123, 123, 122, 122, 121, 121, 121, 120, 120, 119, 119, 119,
+    118, 118, 117, 117, 117, 116, 116, 116, 115, 115, 114, 114, 114, 113, 113, 112,
+    112, 112, 111, 111, 110, 110, 110, 109, 109, 108, 108, 108, 107, 107, 107, 106,
+    106, 105, 105, 105, 104, 104, 103, 103, 103, 102, 102, 101, 101, 101, 100, 100,
+    99, 99, 99, 98, 98, 98, 97, 97, 96, 96, 96, 95, 95, 94, 94, 94,
+    93, 93, 92, 92, 92, 91, 91, 91, 90, 90, 89, 89, 89, 88, 88, 87,
+    87, 87, 86, 86, 85, 85, 85, 84, 84, 83, 83, 83, 82, 82, 82, 81,
+    81, 80, 80, 80, 79, 79, 78, 78, 78, 77, 77, 76, 76, 76, 75, 75,
+    74, 74, 74, 73, 73, 73, 72, 72, 71, 71, 71, 70, 70, 69, 69, 69,
+    68, 68, 67, 67, 67, 66, 66, 65, 65, 65, 64, 64, 64, 63, 63, 62,
+    62, 62, 61, 61, 60, 60, 60, 59, 59, 58, 58, 58, 57, 57, 57, 56,
+    56, 55, 55, 55, 54, 54, 53, 53, 53, 52, 52, 51, 51, 51, 50, 50,
+};
+
+// {period, buzz_on, buzz_off, remainder} of 50 to 150 BPM
+const TempoEntry TEMPO_TABLE[TEMPO_MAX_BPM - TEMPO_MIN_BPM + 1] = {
+    {60000000u, 12000000u, 48000000u, 0u}, // 50 BPM
+    {58823529u, 11764705u, 47058824u, 21u}, // 51 BPM
+    {57692307u, 11538461u, 46153846u, 36u}, // 52 BPM
+    {56603773u, 11320754u, 45283019u, 31u}, // 53 BPM
+    {55555555u, 11111111u, 44444444u, 30u}, // 54 BPM
+    {54545454u, 10909090u, 43636364u, 30u}, // 55 BPM
+    {53571428u, 10714285u, 42857143u, 32u}, // 56 BPM
+    {52631578u, 10526315u, 42105263u, 54u}, // 57 BPM
+    {51724137u, 10344827u, 41379310u, 54u}, // 58 BPM
+    {50847457u, 10169491u, 40677966u, 37u}, // 59 BPM
+    {50000000u, 10000000u, 40000000u, 0u}, // 60 BPM
+    {49180327u, 9836065u, 39344262u, 53u}, // 61 BPM
+    {48387096u, 9677419u, 38709677u, 48u}, // 62 BPM
+    {47619047u, 9523809u, 38095238u, 39u}, // 63 BPM
+    {46875000u, 9375000u, 37500000u, 0u}, // 64 BPM
+    {46153846u, 9230769u, 36923077u, 10u}, // 65 BPM
+    {45454545u, 9090909u, 36363636u, 30u}, // 66 BPM
+    {44776119u, 8955223u, 35820896u, 27u}, // 67 BPM
+    {44117647u, 8823529u, 35294118u, 4u}, // 68 BPM
+    {43478260u, 8695652u, 34782608u, 60u}, // 69 BPM
+    {42857142u, 8571428u, 34285714u, 60u}, // 70 BPM
+    {42253521u, 8450704u, 33802817u, 9u}, // 71 BPM
+    {41666666u, 8333333u, 33333333u, 48u}, // 72 BPM
+    {41095890u, 8219178u, 32876712u, 30u}, // 73 BPM
+    {40540540u, 8108108u, 32432432u, 40u}, // 74 BPM
+    {40000000u, 8000000u, 32000000u, 0u}, // 75 BPM
+    {39473684u, 7894736u, 31578948u, 16u}, // 76 BPM
+    {38961038u, 7792207u, 31168831u, 74u}, // 77 BPM
+    {38461538u, 7692307u, 30769231u, 36u}, // 78 BPM
+    {37974683u, 7594936u, 30379747u, 43u}, // 79 BPM
+    {37500000u, 7500000u, 30000000u, 0u}, // 80 BPM
+    {37037037u, 7407407u, 29629630u, 3u}, // 81 BPM
+    {36585365u, 7317073u, 29268292u, 70u}, // 82 BPM
+    {36144578u, 7228915u, 28915663u, 26u}, // 83 BPM
+    {35714285u, 7142857u, 28571428u, 60u}, // 84 BPM
+    {35294117u, 7058823u, 28235294u, 55u}, // 85 BPM
+    {34883720u, 6976744u, 27906976u, 80u}, // 86 BPM
+    {34482758u, 6896551u, 27586207u, 54u}, // 87 BPM
+    {34090909u, 6818181u, 27272728u, 8u}, // 88 BPM
+    {33707865u, 6741573u, 26966292u, 15u}, // 89 BPM
+    {33333333u, 6666666u, 26666667u, 30u}, // 90 BPM
+    {32967032u, 6593406u, 26373626u, 88u}, // 91 BPM
+    {32608695u, 6521739u, 26086956u, 60u}, // 92 BPM
+    {32258064u, 6451612u, 25806452u, 48u}, // 93 BPM
+    {31914893u, 6382978u, 25531915u, 58u}, // 94 BPM
+    {31578947u, 6315789u, 25263158u, 35u}, // 95 BPM
+    {31250000u, 6250000u, 25000000u, 0u}, // 96 BPM
+    {30927835u, 6185567u, 24742268u, 5u}, // 97 BPM
+    {30612244u, 6122448u, 24489796u, 88u}, // 98 BPM
+    {30303030u, 6060606u, 24242424u, 30u}, // 99 BPM
+    {30000000u, 6000000u, 24000000u, 0u}, // 100 BPM
+    {29702970u, 5940594u, 23762376u, 30u}, // 101 BPM
+    {29411764u, 5882352u, 23529412u, 72u}, // 102 BPM
+    {29126213u, 5825242u, 23300971u, 61u}, // 103 BPM
+    {28846153u, 5769230u, 23076923u, 88u}, // 104 BPM
+    {28571428u, 5714285u, 22857143u, 60u}, // 105 BPM
+    {28301886u, 5660377u, 22641509u, 84u}, // 106 BPM
+    {28037383u, 5607476u, 22429907u, 19u}, // 107 BPM
+    {27777777u, 5555555u, 22222222u, 84u}, // 108 BPM
+    {27522935u, 5504587u, 22018348u, 85u}, // 109 BPM
+    {27272727u, 5454545u, 21818182u, 30u}, // 110 BPM
+    {27027027u, 5405405u, 21621622u, 3u}, // 111 BPM
+    {26785714u, 5357142u, 21428572u, 32u}, // 112 BPM
+    {26548672u, 5309734u, 21238938u, 64u}, // 113 BPM
+    {26315789u, 5263157u, 21052632u, 54u}, // 114 BPM
+    {26086956u, 5217391u, 20869565u, 60u}, // 115 BPM
+    {25862068u, 5172413u, 20689655u, 112u}, // 116 BPM
+    {25641025u, 5128205u, 20512820u, 75u}, // 117 BPM
+    {25423728u, 5084745u, 20338983u, 96u}, // 118 BPM
+    {25210084u, 5042016u, 20168068u, 4u}, // 119 BPM
+    {25000000u, 5000000u, 20000000u, 0u}, // 120 BPM
+    {24793388u, 4958677u, 19834711u, 52u}, // 121 BPM
+    {24590163u, 4918032u, 19672131u, 114u}, // 122 BPM
+    {24390243u, 4878048u, 19512195u, 111u}, // 123 BPM
+    {24193548u, 4838709u, 19354839u, 48u}, // 124 BPM
+    {24000000u, 4800000u, 19200000u, 0u}, // 125 BPM
+    {23809523u, 4761904u, 19047619u, 102u}, // 126 BPM
+    {23622047u, 4724409u, 18897638u, 31u}, // 127 BPM
+    {23437500u, 4687500u, 18750000u, 0u}, // 128 BPM
+    {23255813u, 4651162u, 18604651u, 123u}, // 129 BPM
+    {23076923u, 4615384u, 18461539u, 10u}, // 130 BPM
+    {22900763u, 4580152u, 18320611u, 47u}, // 131 BPM
+    {22727272u, 4545454u, 18181818u, 96u}, // 132 BPM
+    {22556390u, 4511278u, 18045112u, 130u}, // 133 BPM
+    {22388059u, 4477611u, 17910448u, 94u}, // 134 BPM
+    {22222222u, 4444444u, 17777778u, 30u}, // 135 BPM
+    {22058823u, 4411764u, 17647059u, 72u}, // 136 BPM
+    {21897810u, 4379562u, 17518248u, 30u}, // 137 BPM
+    {21739130u, 4347826u, 17391304u, 60u}, // 138 BPM
+    {21582733u, 4316546u, 17266187u, 113u}, // 139 BPM
+    {21428571u, 4285714u, 17142857u, 60u}, // 140 BPM
+    {21276595u, 4255319u, 17021276u, 105u}, // 141 BPM
+    {21126760u, 4225352u, 16901408u, 80u}, // 142 BPM
+    {20979020u, 4195804u, 16783216u, 140u}, // 143 BPM
+    {20833333u, 4166666u, 16666667u, 48u}, // 144 BPM
+    {20689655u, 4137931u, 16551724u, 25u}, // 145 BPM
+    {20547945u, 4109589u, 16438356u, 30u}, // 146 BPM
+    {20408163u, 4081632u, 16326531u, 39u}, // 147 BPM
+    {20270270u, 4054054u, 16216216u, 40u}, // 148 BPM
+    {20134228u, 4026845u, 16107383u, 28u}, // 149 BPM
+    {20000000u, 4000000u, 16000000u, 0u}, // 150 BPM
+};
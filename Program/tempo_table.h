@@ -0,0 +1,56 @@
+/*
+ * tempo_table.h: precomputed tempo values for the metronome
+ *
+ * ----------------------------
+ *  Created on: Dec 6, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * Everything the beat path used to compute on a tempo change is looked up here instead: the BPM
+ * of a rotary angle sensor reading, and the beat and buzzer timing of each BPM in event ticks.
+ * The tables in tempo_table.c are generated by Host/tempo_table_gen.c; do not edit them by hand.
+ */
+
+#ifndef TEMPO_TABLE_H_
+#define TEMPO_TABLE_H_
+
+#include <stdint.h>
+
+// Tempo range of the metronome: the rotary angle sensor maps [0, 4095] onto [150, 50] BPM
+#define TEMPO_MIN_BPM       50
+#define TEMPO_MAX_BPM       150
+
+// The BPM table is indexed by the 12-bit ADC reading shifted right by this many bits; all
+// readings in one entry get the BPM of the lowest one, which is at most 1 BPM off
+#define TEMPO_ADC_SHIFT     4
+#define TEMPO_ADC_ENTRIES   (4096 >> TEMPO_ADC_SHIFT)
+
+// Timing of one tempo, in event ticks
+typedef struct
+{
+    uint32_t period;    // whole ticks per beat
+    uint32_t buzz_on;   // ticks the buzzer is on at the start of a beat (20% of the beat)
+    uint32_t buzz_off;  // ticks the buzzer is off for the rest of the beat
+    uint8_t remainder;  // fractional ticks per beat, in units of 1/BPM tick; see EventPeriod in event.h
+} TempoEntry;
+
+extern const uint8_t TEMPO_BPM_OF_READING[TEMPO_ADC_ENTRIES];
+extern const TempoEntry TEMPO_TABLE[TEMPO_MAX_BPM - TEMPO_MIN_BPM + 1];
+
+// BPM of a rotary angle sensor reading in [0, 4095]
+static inline uint32_t TempoBpmOfReading(uint32_t reading)
+{
+    return TEMPO_BPM_OF_READING[reading >> TEMPO_ADC_SHIFT];
+}
+
+// Timing of a BPM in [TEMPO_MIN_BPM, TEMPO_MAX_BPM]
+static inline const TempoEntry *TempoLookup(uint32_t bpm)
+{
+    return &TEMPO_TABLE[bpm - TEMPO_MIN_BPM];
+}
+
+#endif /* TEMPO_TABLE_H_ */
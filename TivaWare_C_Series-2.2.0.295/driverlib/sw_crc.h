@@ -51,6 +51,27 @@ extern "C"
 {
 #endif
 
+//*****************************************************************************
+//
+// The software engine of Crc32Accel(): the slice-by-8 CRC-32 (8), the
+// slice-by-4 CRC-32 (4), or the byte-at-a-time CRC-32 (1), with 7 KB, 3 KB or
+// none of tables beyond the 1 KB of Crc32().
+//
+//*****************************************************************************
+#ifndef SW_CRC32_SLICES
+#define SW_CRC32_SLICES         8
+#endif
+
+//*****************************************************************************
+//
+// Whether Crc32Accel() uses the hardware CRC module of the TM4C129 devices,
+// when the part has one.
+//
+//*****************************************************************************
+#ifndef SW_CRC32_HARDWARE
+#define SW_CRC32_HARDWARE       1
+#endif
+
 //*****************************************************************************
 //
 // Prototypes for the functions.
@@ -65,6 +86,12 @@ extern void Crc16Array3(uint32_t ui32WordLen, const uint32_t *pui32Data,
                         uint16_t *pui16Crc3);
 extern uint32_t Crc32(uint32_t ui32Crc, const uint8_t *pui8Data,
                       uint32_t ui32Count);
+extern uint32_t Crc32Slice4(uint32_t ui32Crc, const uint8_t *pui8Data,
+                            uint32_t ui32Count);
+extern uint32_t Crc32Slice8(uint32_t ui32Crc, const uint8_t *pui8Data,
+                            uint32_t ui32Count);
+extern uint32_t Crc32Accel(uint32_t ui32Crc, const uint8_t *pui8Data,
+                           uint32_t ui32Count);
 
 //*****************************************************************************
 //
@@ -61,7 +61,8 @@
 static void
 ScheduleNextTransmission(tUSBBuffer *psBuffer)
 {
-    uint32_t ui32Packet, ui32Space, ui32Total, ui32Sent;
+    uint32_t ui32Packet, ui32Sent;
+    tUSBRingBufSpan psSpan[2];
 
     //
     // Ask the lower layer if it has space to accept another packet of data.
@@ -75,25 +76,17 @@ ScheduleNextTransmission(tUSBBuffer *psBuffer)
     if(ui32Packet)
     {
         //
-        // How much contiguous data do we have in the buffer?
+        // Find the data for the packet, in place in the buffer: up to the
+        // end of the buffer, and from its start if the data wraps.
         //
-        ui32Space = USBRingBufContigUsed(&psBuffer->sPrivateData.sRingBuf);
+        ui32Sent = USBRingBufReadPeek(&psBuffer->sPrivateData.sRingBuf,
+                                      ui32Packet, psSpan);
 
         //
-        // How much total data do we have in the buffer?
+        // Write the bytes to the lower layer assuming there is something to
+        // send.
         //
-        ui32Total = USBRingBufUsed(&psBuffer->sPrivateData.sRingBuf);
-
-        //
-        // How much data will we be sending as a result of this call?
-        //
-        ui32Sent = (ui32Packet < ui32Total) ? ui32Packet : ui32Total;
-
-        //
-        // Write the contiguous bytes to the lower layer assuming there is
-        // something to send.
-        //
-        if(ui32Space)
+        if(ui32Sent)
         {
             //
             // There is data available to send.  Update our state to indicate
@@ -101,44 +94,24 @@ ScheduleNextTransmission(tUSBBuffer *psBuffer)
             //
             psBuffer->sPrivateData.ui32LastSent = ui32Sent;
 
-            //
-            // Determine the maximum sized block we can send in this transfer.
-            //
-            ui32Space = (ui32Space < ui32Packet) ? ui32Space : ui32Packet;
             //
             // Call the lower layer to send the new packet.  If the current
             // data spans the buffer wrap, tell the lower layer that it can
             // expect a second call to fill the whole packet before it
             // transmits it.
             //
-            psBuffer->pfnTransfer(psBuffer->pvHandle,
-                              (psBuffer->sPrivateData.sRingBuf.pui8Buf +
-                               psBuffer->sPrivateData.sRingBuf.ui32ReadIndex),
-                               ui32Space,
-                              (((ui32Space < ui32Packet) &&
-                                (ui32Space < ui32Total)) ? false : true));
+            psBuffer->pfnTransfer(psBuffer->pvHandle, psSpan[0].pui8Data,
+                                  psSpan[0].ui32Length,
+                                  (psSpan[1].ui32Length ? false : true));
 
             //
             // Do we need to send a second part to fill out the packet?  This
             // will occur if the current packet spans the buffer wrap.
             //
-            if((ui32Space < ui32Packet) && (ui32Space < ui32Total))
+            if(psSpan[1].ui32Length)
             {
-                //
-                // The packet straddled the wrap.  How much space remains in
-                // the packet?
-                //
-                ui32Packet -= ui32Space;
-
-                //
-                // How much data can we actually send?
-                //
-                ui32Space = ui32Total - ui32Space;
-                ui32Space = (ui32Space > ui32Packet) ? ui32Packet : ui32Space;
-
-                psBuffer->pfnTransfer(psBuffer->pvHandle,
-                                      psBuffer->sPrivateData.sRingBuf.pui8Buf,
-                                      ui32Space, true);
+                psBuffer->pfnTransfer(psBuffer->pvHandle, psSpan[1].pui8Data,
+                                      psSpan[1].ui32Length, true);
             }
         }
         else
@@ -194,6 +167,7 @@ static uint32_t
 HandleRxAvailable(tUSBBuffer *psBuffer, uint32_t ui32Size, uint8_t *pui8Data)
 {
     uint32_t ui32Avail, ui32Read, ui32Packet, ui32RetCount;
+    tUSBRingBufSpan psSpan[2];
 
     //
     // Has the data already been read into memory?
@@ -259,58 +233,37 @@ HandleRxAvailable(tUSBBuffer *psBuffer, uint32_t ui32Size, uint8_t *pui8Data)
         ui32Packet = psBuffer->pfnAvailable(psBuffer->pvHandle);
 
         //
-        // How much contiguous space do we have in the buffer?
+        // Find the space for it, in place in the buffer: up to the end of the
+        // buffer, and from its start if the space wraps.
         //
-        ui32Avail = USBRingBufContigFree(&psBuffer->sPrivateData.sRingBuf);
+        USBRingBufWriteReserve(&psBuffer->sPrivateData.sRingBuf, ui32Packet,
+                               psSpan);
 
         //
-        // Get as much of the packet as we can in the available space.
+        // Get as much of the packet as we can in the space before the wrap.
         //
         ui32Read = psBuffer->pfnTransfer(psBuffer->pvHandle,
-                              (psBuffer->sPrivateData.sRingBuf.pui8Buf +
-                               psBuffer->sPrivateData.sRingBuf.ui32WriteIndex),
-                              ui32Avail, true);
+                                         psSpan[0].pui8Data,
+                                         psSpan[0].ui32Length, true);
 
         //
-        // Advance the ring buffer write pointer to add our new data.
+        // Did that fill the space before the wrap, with the packet still not
+        // complete?  If so, read as much of the remainder of the packet as
+        // we can into the space after it.
         //
-        if(ui32Read)
+        if((ui32Read == psSpan[0].ui32Length) && psSpan[1].ui32Length)
         {
-            USBRingBufAdvanceWrite(&psBuffer->sPrivateData.sRingBuf, ui32Read);
+            ui32Read += psBuffer->pfnTransfer(psBuffer->pvHandle,
+                                              psSpan[1].pui8Data,
+                                              psSpan[1].ui32Length, true);
         }
 
         //
-        // Did we get the whole packet?
+        // Advance the ring buffer write pointer to add our new data.
         //
-        if(ui32Read < ui32Packet)
+        if(ui32Read)
         {
-            //
-            // No - how much space do we have in the buffer?
-            //
-            ui32Avail = USBRingBufContigFree(&psBuffer->sPrivateData.sRingBuf);
-
-            //
-            // If there is any space left, read as much of the remainder of
-            // the packet as we can.
-            //
-            if(ui32Avail)
-            {
-                ui32Packet =
-                    psBuffer->pfnTransfer(psBuffer->pvHandle,
-                              (psBuffer->sPrivateData.sRingBuf.pui8Buf +
-                               psBuffer->sPrivateData.sRingBuf.ui32WriteIndex),
-                               ui32Avail, true);
-
-                //
-                // Update the write pointer after we read more data into the
-                // buffer.
-                //
-                if(ui32Packet)
-                {
-                    USBRingBufAdvanceWrite(&psBuffer->sPrivateData.sRingBuf,
-                                           ui32Packet);
-                }
-            }
+            USBRingBufWriteCommit(&psBuffer->sPrivateData.sRingBuf, ui32Read);
         }
 
         //
@@ -323,7 +276,9 @@ HandleRxAvailable(tUSBBuffer *psBuffer, uint32_t ui32Size, uint8_t *pui8Data)
     //
     // How much data do we have in the buffer?
     //
-    ui32Avail = USBRingBufUsed(&psBuffer->sPrivateData.sRingBuf);
+    ui32Avail = USBRingBufReadPeek(&psBuffer->sPrivateData.sRingBuf,
+                                   USBRingBufSize(&psBuffer->sPrivateData.sRingBuf),
+                                   psSpan);
 
     //
     // Pass the event on to the client with the current read pointer and
@@ -333,8 +288,7 @@ HandleRxAvailable(tUSBBuffer *psBuffer, uint32_t ui32Size, uint8_t *pui8Data)
     //
     ui32Read = psBuffer->pfnCallback(psBuffer->pvCBData,
                              USB_EVENT_RX_AVAILABLE, ui32Avail,
-                             (psBuffer->sPrivateData.sRingBuf.pui8Buf +
-                              psBuffer->sPrivateData.sRingBuf.ui32ReadIndex));
+                             psSpan[0].pui8Data);
 
     //
     // If the client read anything from the buffer, update the read pointer.
@@ -450,23 +404,23 @@ static uint32_t
 HandleRequestBuffer(tUSBBuffer *psBuffer, uint32_t ui32Size,
                     uint8_t **ppui8Buffer)
 {
-    uint32_t ui32Space;
+    tUSBRingBufSpan psSpan[2];
 
     //
     // How much contiguous space do we have available?
     //
-    ui32Space = USBRingBufContigFree(&psBuffer->sPrivateData.sRingBuf);
+    USBRingBufWriteReserve(&psBuffer->sPrivateData.sRingBuf, ui32Size,
+                           psSpan);
 
     //
     // Is there enough space available to satisfy the request?
     //
-    if(ui32Space >= ui32Size)
+    if(psSpan[0].ui32Length >= ui32Size)
     {
         //
         // Yes - return the current write pointer
         //
-        *ppui8Buffer = psBuffer->sPrivateData.sRingBuf.pui8Buf +
-                       psBuffer->sPrivateData.sRingBuf.ui32WriteIndex;
+        *ppui8Buffer = psSpan[0].pui8Data;
         return(ui32Size);
     }
     else
@@ -604,6 +558,10 @@ USBBufferZeroLengthPacketInsert(const tUSBBuffer *psBuffer, bool bSendZLP)
 //! client has written all data it wishes to send, it should call function
 //! USBBufferDataWritten() to indicate that transmission may begin.
 //!
+//! The indices returned are offsets into the buffer.  USBBufferWriteReserve()
+//! and USBBufferReadPeek() describe the same space and data with the wrap
+//! already handled.
+//!
 //! \return None.
 //
 //*****************************************************************************
@@ -616,12 +574,17 @@ USBBufferInfoGet(const tUSBBuffer *psBuffer, tUSBRingBufObject *psRingBuf)
     ASSERT(psBuffer && psRingBuf);
 
     //
-    // Copy the current ring buffer settings to the clients storage.
+    // Copy the current ring buffer settings to the clients storage, with the
+    // indices as offsets into the buffer.
     //
     psRingBuf->pui8Buf = psBuffer->sPrivateData.sRingBuf.pui8Buf;
-    psRingBuf->ui32ReadIndex = psBuffer->sPrivateData.sRingBuf.ui32ReadIndex;
-    psRingBuf->ui32Size = psBuffer->sPrivateData.sRingBuf.ui32ReadIndex;
-    psRingBuf->ui32WriteIndex = psBuffer->sPrivateData.sRingBuf.ui32WriteIndex;
+    psRingBuf->ui32ReadIndex =
+        RingBufCoreOffset(&psBuffer->sPrivateData.sRingBuf,
+                          psBuffer->sPrivateData.sRingBuf.ui32ReadIndex);
+    psRingBuf->ui32Size = psBuffer->sPrivateData.sRingBuf.ui32Size;
+    psRingBuf->ui32WriteIndex =
+        RingBufCoreOffset(&psBuffer->sPrivateData.sRingBuf,
+                          psBuffer->sPrivateData.sRingBuf.ui32WriteIndex);
 }
 
 //*****************************************************************************
@@ -731,6 +694,84 @@ USBBufferDataRemoved(const tUSBBuffer *psBuffer, uint32_t ui32Length)
     }
 }
 
+//*****************************************************************************
+//
+//! Reserves space in a transmit buffer, for a client to write data in place.
+//!
+//! \param psBuffer is the pointer to the buffer instance to be written to.
+//! \param ui32Length is the number of bytes the client wishes to write.
+//! \param psSpan points to an array of two spans, which are written with the
+//! space reserved: the run up to the end of the buffer, and the run that
+//! continues from its start, empty unless the space wraps.
+//!
+//! This function is provided to aid a client wishing to produce data directly
+//! into the USB buffer, for example with the uDMA or by formatting it there,
+//! rather than copying it in with USBBufferWrite().  Once the client has
+//! written the data, it must call USBBufferDataWritten() with the number of
+//! bytes written to add them to the buffer and start their transmission.
+//!
+//! \return Returns the number of bytes reserved, which is less than
+//! \e ui32Length if the buffer has less free space.
+//
+//*****************************************************************************
+uint32_t
+USBBufferWriteReserve(const tUSBBuffer *psBuffer, uint32_t ui32Length,
+                      tUSBRingBufSpan *psSpan)
+{
+    tUSBBufferVars *psPrivate;
+
+    //
+    // Check parameter validity.
+    //
+    ASSERT(psBuffer && psSpan);
+    ASSERT(psBuffer->bTransmitBuffer == true);
+
+    //
+    // Create a writable pointer to the private data.
+    //
+    psPrivate = &((tUSBBuffer *)psBuffer)->sPrivateData;
+
+    return(USBRingBufWriteReserve(&psPrivate->sRingBuf, ui32Length, psSpan));
+}
+
+//*****************************************************************************
+//
+//! Finds the data in a receive buffer, for a client to read it in place.
+//!
+//! \param psBuffer is the pointer to the buffer instance to be read from.
+//! \param ui32Length is the number of bytes the client wishes to read.
+//! \param psSpan points to an array of two spans, which are written with the
+//! data found: the run up to the end of the buffer, and the run that
+//! continues from its start, empty unless the data wraps.
+//!
+//! This function is provided to aid a client wishing to consume data directly
+//! from the USB buffer rather than copying it out with USBBufferRead().  Once
+//! the client has processed the data, it must call USBBufferDataRemoved()
+//! with the number of bytes processed to free their space in the buffer.
+//!
+//! \return Returns the number of bytes found, which is less than
+//! \e ui32Length if the buffer holds fewer.
+//
+//*****************************************************************************
+uint32_t
+USBBufferReadPeek(const tUSBBuffer *psBuffer, uint32_t ui32Length,
+                  tUSBRingBufSpan *psSpan)
+{
+    tUSBBufferVars *psPrivate;
+
+    //
+    // Check parameter validity.
+    //
+    ASSERT(psBuffer && psSpan);
+
+    //
+    // Create a writable pointer to the private data.
+    //
+    psPrivate = &((tUSBBuffer *)psBuffer)->sPrivateData;
+
+    return(USBRingBufReadPeek(&psPrivate->sRingBuf, ui32Length, psSpan));
+}
+
 //*****************************************************************************
 //
 //! Sets the callback pointer supplied to clients of this buffer.
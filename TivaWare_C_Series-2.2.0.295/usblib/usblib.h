@@ -25,6 +25,14 @@
 #ifndef __USBLIB_H__
 #define __USBLIB_H__
 
+//*****************************************************************************
+//
+// The USB buffers' ring buffer is the one of the utility library, from its
+// header-only core; see utils/ringbuf_core.h.
+//
+//*****************************************************************************
+#include "utils/ringbuf_core.h"
+
 //*****************************************************************************
 //
 // If building with a C++ compiler, make all of the definitions in this header
@@ -1768,29 +1776,17 @@ tLPMFeature;
 //! ring buffer.
 //
 //*****************************************************************************
-typedef struct
-{
-    //
-    //! The ring buffer size.
-    //
-    uint32_t ui32Size;
-
-    //
-    //! The ring buffer write index.
-    //
-    volatile uint32_t ui32WriteIndex;
-
-    //
-    //! The ring buffer read index.
-    //
-    volatile uint32_t ui32ReadIndex;
+typedef tRingBufCore tUSBRingBufObject;
 
-    //
-    //! The ring buffer.
-    //
-    uint8_t *pui8Buf;
-}
-tUSBRingBufObject;
+//*****************************************************************************
+//
+//! A contiguous run of bytes in a ring buffer, with its first byte in
+//! \e pui8Data and its length in \e ui32Length, as described by
+//! USBRingBufWriteReserve(), USBRingBufReadPeek(), USBBufferWriteReserve()
+//! and USBBufferReadPeek().
+//
+//*****************************************************************************
+typedef tRingBufSpan tUSBRingBufSpan;
 
 //*****************************************************************************
 //
@@ -1901,6 +1897,12 @@ extern void USBBufferDataWritten(const tUSBBuffer *psBuffer,
                                  uint32_t ui32Length);
 extern void USBBufferDataRemoved(const tUSBBuffer *psBuffer,
                                  uint32_t ui32Length);
+extern uint32_t USBBufferWriteReserve(const tUSBBuffer *psBuffer,
+                                      uint32_t ui32Length,
+                                      tUSBRingBufSpan *psSpan);
+extern uint32_t USBBufferReadPeek(const tUSBBuffer *psBuffer,
+                                  uint32_t ui32Length,
+                                  tUSBRingBufSpan *psSpan);
 extern void USBBufferFlush(const tUSBBuffer *psBuffer);
 extern uint32_t USBBufferRead(const tUSBBuffer *psBuffer, uint8_t *pui8Data,
                               uint32_t ui32Length);
@@ -1929,6 +1931,16 @@ extern void USBRingBufAdvanceRead(tUSBRingBufObject *psUSBRingBuf,
                                   uint32_t ui32NumBytes);
 extern void USBRingBufInit(tUSBRingBufObject *psUSBRingBuf,
                            uint8_t *pui8Buf, uint32_t ui32Size);
+extern uint32_t USBRingBufWriteReserve(tUSBRingBufObject *psUSBRingBuf,
+                                       uint32_t ui32Length,
+                                       tUSBRingBufSpan *psSpan);
+extern void USBRingBufWriteCommit(tUSBRingBufObject *psUSBRingBuf,
+                                  uint32_t ui32Length);
+extern uint32_t USBRingBufReadPeek(tUSBRingBufObject *psUSBRingBuf,
+                                   uint32_t ui32Length,
+                                   tUSBRingBufSpan *psSpan);
+extern void USBRingBufReadRelease(tUSBRingBufObject *psUSBRingBuf,
+                                  uint32_t ui32Length);
 
 //*****************************************************************************
 //
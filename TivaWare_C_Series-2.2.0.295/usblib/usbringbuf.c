@@ -26,7 +26,6 @@
 #include <stdint.h>
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
-#include "driverlib/interrupt.h"
 #include "usblib/usblib.h"
 
 //*****************************************************************************
@@ -36,67 +35,6 @@
 //
 //*****************************************************************************
 
-//*****************************************************************************
-//
-// Define NULL, if not already defined.
-//
-//*****************************************************************************
-#ifndef NULL
-#define NULL                    ((void *)0)
-#endif
-
-//*****************************************************************************
-//
-// Change the value of a variable atomically.
-//
-// \param pui32Val points to the index whose value is to be modified.
-// \param ui32Delta is the number of bytes to increment the index by.
-// \param ui32Size is the size of the buffer the index refers to.
-//
-// This function is used to increment a read or write buffer index that may be
-// written in various different contexts.  It ensures that the
-// read/modify/write sequence is not interrupted and, hence, guards against
-// corruption of the variable.  The new value is adjusted for buffer wrap.
-//
-// \return None.
-//
-//*****************************************************************************
-static void
-UpdateIndexAtomic(volatile uint32_t *pui32Val, uint32_t ui32Delta,
-                  uint32_t ui32Size)
-{
-    bool bIntsOff;
-
-    //
-    // Turn interrupts off temporarily.
-    //
-    bIntsOff = IntMasterDisable();
-
-    //
-    // Update the variable value.
-    //
-    *pui32Val += ui32Delta;
-
-    //
-    // Correct for wrap.  We use a loop here since we don't want to use a
-    // modulus operation with interrupts off but we don't want to fail in
-    // case ui32Delta is greater than ui32Size (which is extremely unlikely
-    // but...)
-    //
-    while(*pui32Val >= ui32Size)
-    {
-        *pui32Val -= ui32Size;
-    }
-
-    //
-    // Restore the interrupt state
-    //
-    if(!bIntsOff)
-    {
-        IntMasterEnable();
-    }
-}
-
 //*****************************************************************************
 //
 //! Determines whether a ring buffer is full or not.
@@ -114,25 +52,7 @@ UpdateIndexAtomic(volatile uint32_t *pui32Val, uint32_t ui32Delta,
 bool
 USBRingBufFull(tUSBRingBufObject *psUSBRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psUSBRingBuf->ui32WriteIndex;
-    ui32Read = psUSBRingBuf->ui32ReadIndex;
-
-    //
-    // Return the full status of the buffer.
-    //
-    return((((ui32Write + 1) % psUSBRingBuf->ui32Size) == ui32Read) ? true :
-                                                                      false);
+    return(RingBufCoreFull(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -152,24 +72,7 @@ USBRingBufFull(tUSBRingBufObject *psUSBRingBuf)
 bool
 USBRingBufEmpty(tUSBRingBufObject *psUSBRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psUSBRingBuf->ui32WriteIndex;
-    ui32Read = psUSBRingBuf->ui32ReadIndex;
-
-    //
-    // Return the empty status of the buffer.
-    //
-    return((ui32Write == ui32Read) ? true : false);
+    return(RingBufCoreEmpty(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -186,23 +89,7 @@ USBRingBufEmpty(tUSBRingBufObject *psUSBRingBuf)
 void
 USBRingBufFlush(tUSBRingBufObject *psUSBRingBuf)
 {
-    bool bIntsOff;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Set the Read/Write pointers to be the same.  Do this with interrupts
-    // disabled to prevent the possibility of corruption of the read index.
-    //
-    bIntsOff = IntMasterDisable();
-    psUSBRingBuf->ui32ReadIndex = psUSBRingBuf->ui32WriteIndex;
-    if(!bIntsOff)
-    {
-        IntMasterEnable();
-    }
+    RingBufCoreFlush(psUSBRingBuf);
 }
 
 //*****************************************************************************
@@ -219,25 +106,7 @@ USBRingBufFlush(tUSBRingBufObject *psUSBRingBuf)
 uint32_t
 USBRingBufUsed(tUSBRingBufObject *psUSBRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psUSBRingBuf->ui32WriteIndex;
-    ui32Read = psUSBRingBuf->ui32ReadIndex;
-
-    //
-    // Return the number of bytes contained in the ring buffer.
-    //
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (psUSBRingBuf->ui32Size - (ui32Read - ui32Write)));
+    return(RingBufCoreUsed(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -254,15 +123,7 @@ USBRingBufUsed(tUSBRingBufObject *psUSBRingBuf)
 uint32_t
 USBRingBufFree(tUSBRingBufObject *psUSBRingBuf)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Return the number of bytes available in the ring buffer.
-    //
-    return((psUSBRingBuf->ui32Size - 1) - USBRingBufUsed(psUSBRingBuf));
+    return(RingBufCoreFree(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -282,25 +143,7 @@ USBRingBufFree(tUSBRingBufObject *psUSBRingBuf)
 uint32_t
 USBRingBufContigUsed(tUSBRingBufObject *psUSBRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psUSBRingBuf->ui32WriteIndex;
-    ui32Read = psUSBRingBuf->ui32ReadIndex;
-
-    //
-    // Return the number of contiguous bytes available.
-    //
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (psUSBRingBuf->ui32Size - ui32Read));
+    return(RingBufCoreContigUsed(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -319,43 +162,7 @@ USBRingBufContigUsed(tUSBRingBufObject *psUSBRingBuf)
 uint32_t
 USBRingBufContigFree(tUSBRingBufObject *psUSBRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psUSBRingBuf->ui32WriteIndex;
-    ui32Read = psUSBRingBuf->ui32ReadIndex;
-
-    //
-    // Return the number of contiguous bytes available.
-    //
-    if(ui32Read > ui32Write)
-    {
-        //
-        // The read pointer is above the write pointer so the amount of free
-        // space is the difference between the two indices minus 1 to account
-        // for the buffer full condition (write index one behind read index).
-        //
-        return((ui32Read - ui32Write) - 1);
-    }
-    else
-    {
-        //
-        // If the write pointer is above the read pointer, the amount of free
-        // space is the size of the buffer minus the write index.  We need to
-        // add a special-case adjustment if the read index is 0 since we need
-        // to leave 1 byte empty to ensure we can tell the difference between
-        // the buffer being full and empty.
-        //
-        return(psUSBRingBuf->ui32Size - ui32Write - ((ui32Read == 0) ? 1 : 0));
-    }
+    return(RingBufCoreContigFree(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -372,15 +179,7 @@ USBRingBufContigFree(tUSBRingBufObject *psUSBRingBuf)
 uint32_t
 USBRingBufSize(tUSBRingBufObject *psUSBRingBuf)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Return the number of bytes available in the ring buffer.
-    //
-    return(psUSBRingBuf->ui32Size);
+    return(RingBufCoreSize(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -397,32 +196,7 @@ USBRingBufSize(tUSBRingBufObject *psUSBRingBuf)
 uint8_t
 USBRingBufReadOne(tUSBRingBufObject *psUSBRingBuf)
 {
-    uint8_t ui8Temp;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Verify that space is available in the buffer.
-    //
-    ASSERT(USBRingBufUsed(psUSBRingBuf) != 0);
-
-    //
-    // Write the data byte.
-    //
-    ui8Temp = psUSBRingBuf->pui8Buf[psUSBRingBuf->ui32ReadIndex];
-
-    //
-    // Increment the read index.
-    //
-    UpdateIndexAtomic(&psUSBRingBuf->ui32ReadIndex, 1, psUSBRingBuf->ui32Size);
-
-    //
-    // Return the character read.
-    //
-    return(ui8Temp);
+    return(RingBufCoreReadOne(psUSBRingBuf));
 }
 
 //*****************************************************************************
@@ -442,27 +216,7 @@ void
 USBRingBufRead(tUSBRingBufObject *psUSBRingBuf, uint8_t *pui8Data,
                uint32_t ui32Length)
 {
-    uint32_t ui32Temp;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-    ASSERT(pui8Data != NULL);
-    ASSERT(ui32Length != 0);
-
-    //
-    // Verify that data is available in the buffer.
-    //
-    ASSERT(ui32Length <= USBRingBufUsed(psUSBRingBuf));
-
-    //
-    // Read the data from the ring buffer.
-    //
-    for(ui32Temp = 0; ui32Temp < ui32Length; ui32Temp++)
-    {
-        pui8Data[ui32Temp] = USBRingBufReadOne(psUSBRingBuf);
-    }
+    RingBufCoreRead(psUSBRingBuf, pui8Data, ui32Length);
 }
 
 //*****************************************************************************
@@ -484,25 +238,7 @@ USBRingBufRead(tUSBRingBufObject *psUSBRingBuf, uint8_t *pui8Data,
 void
 USBRingBufAdvanceRead(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32NumBytes)
 {
-    uint32_t ui32Count;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Make sure that we are not being asked to remove more data than is
-    // there to be removed.
-    //
-    ui32Count = USBRingBufUsed(psUSBRingBuf);
-    ui32Count =  (ui32Count < ui32NumBytes) ? ui32Count : ui32NumBytes;
-
-    //
-    // Advance the buffer read index by the required number of bytes.
-    //
-    UpdateIndexAtomic(&psUSBRingBuf->ui32ReadIndex, ui32Count,
-                      psUSBRingBuf->ui32Size);
+    RingBufCoreAdvanceRead(psUSBRingBuf, ui32NumBytes);
 }
 
 //*****************************************************************************
@@ -525,7 +261,8 @@ USBRingBufAdvanceRead(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32NumBytes)
 //! but this will, of course, result in some of the oldest data in the buffer
 //! being discarded and also, depending upon how data is being read from
 //! the buffer, may result in a race condition which could corrupt the read
-//! pointer.
+//! pointer.  With \b RINGBUF_SPSC, the bytes added are limited to the free
+//! space instead.
 //!
 //! \return None.
 //
@@ -533,69 +270,9 @@ USBRingBufAdvanceRead(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32NumBytes)
 void
 USBRingBufAdvanceWrite(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32NumBytes)
 {
-    uint32_t ui32Count;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Make sure we were not asked to add a silly number of bytes.
-    //
-    ASSERT(ui32NumBytes <= psUSBRingBuf->ui32Size);
-
-    //
-    // Determine how much free space we currently think the buffer has.
-    //
-    ui32Count = USBRingBufFree(psUSBRingBuf);
-
-    //
-    // Check that the client has not added more data to the buffer than there
-    // is space for.  In this case, corruption may have occurred since the
-    // buffer may have been read under interrupt context while the writer was
-    // busy trashing the area around the read pointer.
-    //
-    ASSERT(ui32Count >= ui32NumBytes);
-
-    //
-    // Update the write pointer.
-    //
-    psUSBRingBuf->ui32WriteIndex += ui32NumBytes;
-
-    //
-    // Check and correct for wrap.
-    //
-    if(psUSBRingBuf->ui32WriteIndex >= psUSBRingBuf->ui32Size)
-    {
-        psUSBRingBuf->ui32WriteIndex -= psUSBRingBuf->ui32Size;
-    }
-
-    //
-    // Did the client add more bytes than the buffer had free space for?  This
-    // should be considered a bug since, unless this function is called in
-    // the same context as the code which is reading from the buffer, writing
-    // over the earliest data can cause corrupted data to be read.  The
-    // ASSERT above catches this in debug builds but, in release builds, we
-    // go ahead and try to fix up the read pointer appropriately.
-    //
-    if(ui32Count < ui32NumBytes)
-    {
-        //
-        // Yes - we need to advance the read pointer to ahead of the write
-        // pointer to discard some of the oldest data.
-        //
-        psUSBRingBuf->ui32ReadIndex = psUSBRingBuf->ui32WriteIndex + 1;
-
-        //
-        // Correct for buffer wrap if necessary.
-        //
-        if(psUSBRingBuf->ui32ReadIndex >= psUSBRingBuf->ui32Size)
-        {
-            psUSBRingBuf->ui32ReadIndex -= psUSBRingBuf->ui32Size;
-        }
-    }
+    ASSERT(ui32NumBytes <= RingBufCoreFree(psUSBRingBuf));
 
+    RingBufCoreAdvanceWrite(psUSBRingBuf, ui32NumBytes);
 }
 
 //*****************************************************************************
@@ -613,26 +290,7 @@ USBRingBufAdvanceWrite(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32NumBytes)
 void
 USBRingBufWriteOne(tUSBRingBufObject *psUSBRingBuf, uint8_t ui8Data)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-
-    //
-    // Verify that space is available in the buffer.
-    //
-    ASSERT(USBRingBufFree(psUSBRingBuf) != 0);
-
-    //
-    // Write the data byte.
-    //
-    psUSBRingBuf->pui8Buf[psUSBRingBuf->ui32WriteIndex] = ui8Data;
-
-    //
-    // Increment the write index.
-    //
-    UpdateIndexAtomic(&psUSBRingBuf->ui32WriteIndex, 1,
-                      psUSBRingBuf->ui32Size);
+    RingBufCoreWriteOne(psUSBRingBuf, ui8Data);
 }
 
 //*****************************************************************************
@@ -652,27 +310,7 @@ void
 USBRingBufWrite(tUSBRingBufObject *psUSBRingBuf, const uint8_t *pui8Data,
                 uint32_t ui32Length)
 {
-    uint32_t ui32Temp;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-    ASSERT(pui8Data != NULL);
-    ASSERT(ui32Length != 0);
-
-    //
-    // Verify that space is available in the buffer.
-    //
-    ASSERT(ui32Length <= USBRingBufFree(psUSBRingBuf));
-
-    //
-    // Write the data into the ring buffer.
-    //
-    for(ui32Temp = 0; ui32Temp < ui32Length; ui32Temp++)
-    {
-        USBRingBufWriteOne(psUSBRingBuf, pui8Data[ui32Temp]);
-    }
+    RingBufCoreWrite(psUSBRingBuf, pui8Data, ui32Length);
 }
 
 //*****************************************************************************
@@ -684,6 +322,7 @@ USBRingBufWrite(tUSBRingBufObject *psUSBRingBuf, const uint8_t *pui8Data,
 //! \param ui32Size is the size of the buffer in bytes.
 //!
 //! This function initializes a ring buffer object, preparing it to store data.
+//! With \b RINGBUF_SPSC, \e ui32Size must be a power of two.
 //!
 //! \return None.
 //
@@ -692,19 +331,101 @@ void
 USBRingBufInit(tUSBRingBufObject *psUSBRingBuf, uint8_t *pui8Buf,
                uint32_t ui32Size)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psUSBRingBuf != NULL);
-    ASSERT(pui8Buf != NULL);
-    ASSERT(ui32Size != 0);
+    RingBufCoreInit(psUSBRingBuf, pui8Buf, ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Reserves space in a ring buffer, to be written in place.
+//!
+//! \param psUSBRingBuf points to the ring buffer to be written to.
+//! \param ui32Length is the number of bytes wanted.
+//! \param psSpan points to an array of two spans, which are written with the
+//! space reserved.
+//!
+//! This function describes up to \e ui32Length bytes of free space after the
+//! data in the buffer, as two runs: the one up to the end of the buffer, and
+//! the one that continues from its start, empty unless the space wraps.  An
+//! endpoint FIFO or the uDMA can then fill them in place, instead of through a
+//! copy with USBRingBufWrite().  The bytes written are added to the buffer by
+//! USBRingBufWriteCommit().
+//!
+//! \return Returns the number of bytes reserved, which is less than
+//! \e ui32Length if the buffer has less free space.
+//
+//*****************************************************************************
+uint32_t
+USBRingBufWriteReserve(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32Length,
+                       tUSBRingBufSpan *psSpan)
+{
+    return(RingBufCoreWriteReserve(psUSBRingBuf, ui32Length, psSpan));
+}
 
-    //
-    // Initialize the ring buffer object.
-    //
-    psUSBRingBuf->ui32Size = ui32Size;
-    psUSBRingBuf->pui8Buf = pui8Buf;
-    psUSBRingBuf->ui32WriteIndex = psUSBRingBuf->ui32ReadIndex = 0;
+//*****************************************************************************
+//
+//! Adds bytes written in place to a ring buffer.
+//!
+//! \param psUSBRingBuf points to the ring buffer written to.
+//! \param ui32Length is the number of bytes written, at most the number
+//! reserved by USBRingBufWriteReserve().
+//!
+//! This function makes the first \e ui32Length bytes of the space reserved
+//! by USBRingBufWriteReserve() available to the reader.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBRingBufWriteCommit(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32Length)
+{
+    USBRingBufAdvanceWrite(psUSBRingBuf, ui32Length);
+}
+
+//*****************************************************************************
+//
+//! Describes the data in a ring buffer, to be read in place.
+//!
+//! \param psUSBRingBuf points to the ring buffer to be read from.
+//! \param ui32Length is the number of bytes wanted.
+//! \param psSpan points to an array of two spans, which are written with the
+//! data found.
+//!
+//! This function describes up to \e ui32Length bytes of the oldest data in
+//! the buffer, as two runs: the one up to the end of the buffer, and the one
+//! that continues from its start, empty unless the data wraps.  An endpoint
+//! FIFO or the uDMA can then take them in place, instead of through a copy
+//! with USBRingBufRead().  The bytes stay in the buffer until they are
+//! released by USBRingBufReadRelease().
+//!
+//! \return Returns the number of bytes described, which is less than
+//! \e ui32Length if the buffer holds fewer.
+//
+//*****************************************************************************
+uint32_t
+USBRingBufReadPeek(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32Length,
+                   tUSBRingBufSpan *psSpan)
+{
+    return(RingBufCoreReadPeek(psUSBRingBuf, ui32Length, psSpan));
+}
+
+//*****************************************************************************
+//
+//! Removes bytes read in place from a ring buffer.
+//!
+//! \param psUSBRingBuf points to the ring buffer read from.
+//! \param ui32Length is the number of bytes read, at most the number
+//! described by USBRingBufReadPeek().
+//!
+//! This function frees the first \e ui32Length bytes of the data described
+//! by USBRingBufReadPeek(), for the writer to use again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBRingBufReadRelease(tUSBRingBufObject *psUSBRingBuf, uint32_t ui32Length)
+{
+    RingBufCoreAdvanceRead(psUSBRingBuf, ui32Length);
 }
 
 //*****************************************************************************
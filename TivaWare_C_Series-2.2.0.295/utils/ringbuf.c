@@ -26,7 +26,6 @@
 #include <stdint.h>
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
-#include "driverlib/interrupt.h"
 #include "utils/ringbuf.h"
 
 //*****************************************************************************
@@ -36,67 +35,6 @@
 //
 //*****************************************************************************
 
-//*****************************************************************************
-//
-// Define NULL, if not already defined.
-//
-//*****************************************************************************
-#ifndef NULL
-#define NULL                    ((void *)0)
-#endif
-
-//*****************************************************************************
-//
-// Change the value of a variable atomically.
-//
-// \param pui32Val points to the index whose value is to be modified.
-// \param ui32Delta is the number of bytes to increment the index by.
-// \param ui32Size is the size of the buffer the index refers to.
-//
-// This function is used to increment a read or write buffer index that may be
-// written in various different contexts.  It ensures that the
-// read/modify/write sequence is not interrupted and, hence, guards against
-// corruption of the variable.  The new value is adjusted for buffer wrap.
-//
-// \return None.
-//
-//*****************************************************************************
-static void
-UpdateIndexAtomic(volatile uint32_t *pui32Val, uint32_t ui32Delta,
-                  uint32_t ui32Size)
-{
-    bool bIntsOff;
-
-    //
-    // Turn interrupts off temporarily.
-    //
-    bIntsOff = IntMasterDisable();
-
-    //
-    // Update the variable value.
-    //
-    *pui32Val += ui32Delta;
-
-    //
-    // Correct for wrap.  We use a loop here since we don't want to use a
-    // modulus operation with interrupts off but we don't want to fail in
-    // case ui32Delta is greater than ui32Size (which is extremely unlikely
-    // but...)
-    //
-    while(*pui32Val >= ui32Size)
-    {
-        *pui32Val -= ui32Size;
-    }
-
-    //
-    // Restore the interrupt state
-    //
-    if(!bIntsOff)
-    {
-        IntMasterEnable();
-    }
-}
-
 //*****************************************************************************
 //
 //! Determines whether the ring buffer whose pointers and size are provided
@@ -115,25 +53,7 @@ UpdateIndexAtomic(volatile uint32_t *pui32Val, uint32_t ui32Delta,
 bool
 RingBufFull(tRingBufObject *psRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psRingBuf->ui32WriteIndex;
-    ui32Read = psRingBuf->ui32ReadIndex;
-
-    //
-    // Return the full status of the buffer.
-    //
-    return((((ui32Write + 1) % psRingBuf->ui32Size) == ui32Read) ? true :
-           false);
+    return(RingBufCoreFull(psRingBuf));
 }
 
 //*****************************************************************************
@@ -154,24 +74,7 @@ RingBufFull(tRingBufObject *psRingBuf)
 bool
 RingBufEmpty(tRingBufObject *psRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psRingBuf->ui32WriteIndex;
-    ui32Read = psRingBuf->ui32ReadIndex;
-
-    //
-    // Return the empty status of the buffer.
-    //
-    return((ui32Write == ui32Read) ? true : false);
+    return(RingBufCoreEmpty(psRingBuf));
 }
 
 //*****************************************************************************
@@ -188,23 +91,7 @@ RingBufEmpty(tRingBufObject *psRingBuf)
 void
 RingBufFlush(tRingBufObject *psRingBuf)
 {
-    bool bIntsOff;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Set the Read/Write pointers to be the same.  Do this with interrupts
-    // disabled to prevent the possibility of corruption of the read index.
-    //
-    bIntsOff = IntMasterDisable();
-    psRingBuf->ui32ReadIndex = psRingBuf->ui32WriteIndex;
-    if(!bIntsOff)
-    {
-        IntMasterEnable();
-    }
+    RingBufCoreFlush(psRingBuf);
 }
 
 //*****************************************************************************
@@ -221,25 +108,7 @@ RingBufFlush(tRingBufObject *psRingBuf)
 uint32_t
 RingBufUsed(tRingBufObject *psRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psRingBuf->ui32WriteIndex;
-    ui32Read = psRingBuf->ui32ReadIndex;
-
-    //
-    // Return the number of bytes contained in the ring buffer.
-    //
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (psRingBuf->ui32Size - (ui32Read - ui32Write)));
+    return(RingBufCoreUsed(psRingBuf));
 }
 
 //*****************************************************************************
@@ -256,15 +125,7 @@ RingBufUsed(tRingBufObject *psRingBuf)
 uint32_t
 RingBufFree(tRingBufObject *psRingBuf)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Return the number of bytes available in the ring buffer.
-    //
-    return((psRingBuf->ui32Size - 1) - RingBufUsed(psRingBuf));
+    return(RingBufCoreFree(psRingBuf));
 }
 
 //*****************************************************************************
@@ -284,25 +145,7 @@ RingBufFree(tRingBufObject *psRingBuf)
 uint32_t
 RingBufContigUsed(tRingBufObject *psRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psRingBuf->ui32WriteIndex;
-    ui32Read = psRingBuf->ui32ReadIndex;
-
-    //
-    // Return the number of contiguous bytes available.
-    //
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (psRingBuf->ui32Size - ui32Read));
+    return(RingBufCoreContigUsed(psRingBuf));
 }
 
 //*****************************************************************************
@@ -321,43 +164,7 @@ RingBufContigUsed(tRingBufObject *psRingBuf)
 uint32_t
 RingBufContigFree(tRingBufObject *psRingBuf)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Copy the Read/Write indices for calculation.
-    //
-    ui32Write = psRingBuf->ui32WriteIndex;
-    ui32Read = psRingBuf->ui32ReadIndex;
-
-    //
-    // Return the number of contiguous bytes available.
-    //
-    if(ui32Read > ui32Write)
-    {
-        //
-        // The read pointer is above the write pointer so the amount of free
-        // space is the difference between the two indices minus 1 to account
-        // for the buffer full condition (write index one behind read index).
-        //
-        return((ui32Read - ui32Write) - 1);
-    }
-    else
-    {
-        //
-        // If the write pointer is above the read pointer, the amount of free
-        // space is the size of the buffer minus the write index.  We need to
-        // add a special-case adjustment if the read index is 0 since we need
-        // to leave 1 byte empty to ensure we can tell the difference between
-        // the buffer being full and empty.
-        //
-        return(psRingBuf->ui32Size - ui32Write - ((ui32Read == 0) ? 1 : 0));
-    }
+    return(RingBufCoreContigFree(psRingBuf));
 }
 
 //*****************************************************************************
@@ -374,15 +181,7 @@ RingBufContigFree(tRingBufObject *psRingBuf)
 uint32_t
 RingBufSize(tRingBufObject *psRingBuf)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Return the number of bytes available in the ring buffer.
-    //
-    return(psRingBuf->ui32Size);
+    return(RingBufCoreSize(psRingBuf));
 }
 
 //*****************************************************************************
@@ -399,32 +198,7 @@ RingBufSize(tRingBufObject *psRingBuf)
 uint8_t
 RingBufReadOne(tRingBufObject *psRingBuf)
 {
-    uint8_t ui8Temp;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Verify that space is available in the buffer.
-    //
-    ASSERT(RingBufUsed(psRingBuf) != 0);
-
-    //
-    // Write the data byte.
-    //
-    ui8Temp = psRingBuf->pui8Buf[psRingBuf->ui32ReadIndex];
-
-    //
-    // Increment the read index.
-    //
-    UpdateIndexAtomic(&psRingBuf->ui32ReadIndex, 1, psRingBuf->ui32Size);
-
-    //
-    // Return the character read.
-    //
-    return(ui8Temp);
+    return(RingBufCoreReadOne(psRingBuf));
 }
 
 //*****************************************************************************
@@ -443,27 +217,7 @@ RingBufReadOne(tRingBufObject *psRingBuf)
 void
 RingBufRead(tRingBufObject *psRingBuf, uint8_t *pui8Data, uint32_t ui32Length)
 {
-    uint32_t ui32Temp;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-    ASSERT(pui8Data != NULL);
-    ASSERT(ui32Length != 0);
-
-    //
-    // Verify that data is available in the buffer.
-    //
-    ASSERT(ui32Length <= RingBufUsed(psRingBuf));
-
-    //
-    // Read the data from the ring buffer.
-    //
-    for(ui32Temp = 0; ui32Temp < ui32Length; ui32Temp++)
-    {
-        pui8Data[ui32Temp] = RingBufReadOne(psRingBuf);
-    }
+    RingBufCoreRead(psRingBuf, pui8Data, ui32Length);
 }
 
 //*****************************************************************************
@@ -485,25 +239,7 @@ RingBufRead(tRingBufObject *psRingBuf, uint8_t *pui8Data, uint32_t ui32Length)
 void
 RingBufAdvanceRead(tRingBufObject *psRingBuf, uint32_t ui32NumBytes)
 {
-    uint32_t ui32Count;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Make sure that we are not being asked to remove more data than is
-    // there to be removed.
-    //
-    ui32Count = RingBufUsed(psRingBuf);
-    ui32Count = (ui32Count < ui32NumBytes) ? ui32Count : ui32NumBytes;
-
-    //
-    // Advance the buffer read index by the required number of bytes.
-    //
-    UpdateIndexAtomic(&psRingBuf->ui32ReadIndex, ui32Count,
-                      psRingBuf->ui32Size);
+    RingBufCoreAdvanceRead(psRingBuf, ui32NumBytes);
 }
 
 //*****************************************************************************
@@ -519,7 +255,8 @@ RingBufAdvanceRead(tRingBufObject *psRingBuf, uint32_t ui32NumBytes)
 //! \e ui32NumBytes parameter is larger than the amount of free space in the
 //! buffer, the read pointer will be advanced to cater for the addition.  Note
 //! that this will result in some of the oldest data in the buffer being
-//! discarded.
+//! discarded.  With \b RINGBUF_SPSC, where the read index belongs to the
+//! consumer, the bytes added are limited to the free space instead.
 //!
 //! \return None.
 //
@@ -528,72 +265,7 @@ void
 RingBufAdvanceWrite(tRingBufObject *psRingBuf,
                     uint32_t ui32NumBytes)
 {
-    uint32_t ui32Count;
-    bool bIntsOff;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Make sure we were not asked to add a silly number of bytes.
-    //
-    ASSERT(ui32NumBytes <= psRingBuf->ui32Size);
-
-    //
-    // Determine how much free space we currently think the buffer has.
-    //
-    ui32Count = RingBufFree(psRingBuf);
-
-    //
-    // Advance the buffer write index by the required number of bytes and
-    // check that we have not run past the read index.  Note that we must do
-    // this within a critical section (interrupts disabled) to prevent
-    // race conditions that could corrupt one or other of the indices.
-    //
-    bIntsOff = IntMasterDisable();
-
-    //
-    // Update the write pointer.
-    //
-    psRingBuf->ui32WriteIndex += ui32NumBytes;
-
-    //
-    // Check and correct for wrap.
-    //
-    if(psRingBuf->ui32WriteIndex >= psRingBuf->ui32Size)
-    {
-        psRingBuf->ui32WriteIndex -= psRingBuf->ui32Size;
-    }
-
-    //
-    // Did the client add more bytes than the buffer had free space for?
-    //
-    if(ui32Count < ui32NumBytes)
-    {
-        //
-        // Yes - we need to advance the read pointer to ahead of the write
-        // pointer to discard some of the oldest data.
-        //
-        psRingBuf->ui32ReadIndex = psRingBuf->ui32WriteIndex + 1;
-
-        //
-        // Correct for buffer wrap if necessary.
-        //
-        if(psRingBuf->ui32ReadIndex >= psRingBuf->ui32Size)
-        {
-            psRingBuf->ui32ReadIndex -= psRingBuf->ui32Size;
-        }
-    }
-
-    //
-    // Restore interrupts if we turned them off earlier.
-    //
-    if(!bIntsOff)
-    {
-        IntMasterEnable();
-    }
+    RingBufCoreAdvanceWrite(psRingBuf, ui32NumBytes);
 }
 
 //*****************************************************************************
@@ -611,25 +283,7 @@ RingBufAdvanceWrite(tRingBufObject *psRingBuf,
 void
 RingBufWriteOne(tRingBufObject *psRingBuf, uint8_t ui8Data)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-
-    //
-    // Verify that space is available in the buffer.
-    //
-    ASSERT(RingBufFree(psRingBuf) != 0);
-
-    //
-    // Write the data byte.
-    //
-    psRingBuf->pui8Buf[psRingBuf->ui32WriteIndex] = ui8Data;
-
-    //
-    // Increment the write index.
-    //
-    UpdateIndexAtomic(&psRingBuf->ui32WriteIndex, 1, psRingBuf->ui32Size);
+    RingBufCoreWriteOne(psRingBuf, ui8Data);
 }
 
 //*****************************************************************************
@@ -649,27 +303,7 @@ void
 RingBufWrite(tRingBufObject *psRingBuf, uint8_t *pui8Data,
              uint32_t ui32Length)
 {
-    uint32_t ui32Temp;
-
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-    ASSERT(pui8Data != NULL);
-    ASSERT(ui32Length != 0);
-
-    //
-    // Verify that space is available in the buffer.
-    //
-    ASSERT(ui32Length <= RingBufFree(psRingBuf));
-
-    //
-    // Write the data into the ring buffer.
-    //
-    for(ui32Temp = 0; ui32Temp < ui32Length; ui32Temp++)
-    {
-        RingBufWriteOne(psRingBuf, pui8Data[ui32Temp]);
-    }
+    RingBufCoreWrite(psRingBuf, pui8Data, ui32Length);
 }
 
 //*****************************************************************************
@@ -681,6 +315,7 @@ RingBufWrite(tRingBufObject *psRingBuf, uint8_t *pui8Data,
 //! \param ui32Size is the size of the buffer in bytes.
 //!
 //! This function initializes a ring buffer object, preparing it to store data.
+//! With \b RINGBUF_SPSC, \e ui32Size must be a power of two.
 //!
 //! \return None.
 //
@@ -689,19 +324,102 @@ void
 RingBufInit(tRingBufObject *psRingBuf, uint8_t *pui8Buf,
             uint32_t ui32Size)
 {
-    //
-    // Check the arguments.
-    //
-    ASSERT(psRingBuf != NULL);
-    ASSERT(pui8Buf != NULL);
-    ASSERT(ui32Size != 0);
+    RingBufCoreInit(psRingBuf, pui8Buf, ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Reserves space in a ring buffer, to be written in place.
+//!
+//! \param psRingBuf points to the ring buffer to be written to.
+//! \param ui32Length is the number of bytes wanted.
+//! \param psSpan points to an array of two spans, which are written with the
+//! space reserved.
+//!
+//! This function describes up to \e ui32Length bytes of free space after the
+//! data in the buffer, as two runs: the one up to the end of the buffer, and
+//! the one that continues from its start, empty unless the space wraps.  A
+//! producer such as a peripheral FIFO or the uDMA can then fill them in place,
+//! instead of through a copy with RingBufWrite().  The bytes written are added
+//! to the buffer by RingBufWriteCommit().  Nothing is changed until then, so
+//! the space may also be left unused.
+//!
+//! \return Returns the number of bytes reserved, which is less than
+//! \e ui32Length if the buffer has less free space.
+//
+//*****************************************************************************
+uint32_t
+RingBufWriteReserve(tRingBufObject *psRingBuf, uint32_t ui32Length,
+                    tRingBufSpan *psSpan)
+{
+    return(RingBufCoreWriteReserve(psRingBuf, ui32Length, psSpan));
+}
 
-    //
-    // Initialize the ring buffer object.
-    //
-    psRingBuf->ui32Size = ui32Size;
-    psRingBuf->pui8Buf = pui8Buf;
-    psRingBuf->ui32WriteIndex = psRingBuf->ui32ReadIndex = 0;
+//*****************************************************************************
+//
+//! Adds bytes written in place to a ring buffer.
+//!
+//! \param psRingBuf points to the ring buffer written to.
+//! \param ui32Length is the number of bytes written, at most the number
+//! reserved by RingBufWriteReserve().
+//!
+//! This function makes the first \e ui32Length bytes of the space reserved
+//! by RingBufWriteReserve() available to the reader.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RingBufWriteCommit(tRingBufObject *psRingBuf, uint32_t ui32Length)
+{
+    RingBufCoreAdvanceWrite(psRingBuf, ui32Length);
+}
+
+//*****************************************************************************
+//
+//! Describes the data in a ring buffer, to be read in place.
+//!
+//! \param psRingBuf points to the ring buffer to be read from.
+//! \param ui32Length is the number of bytes wanted.
+//! \param psSpan points to an array of two spans, which are written with the
+//! data found.
+//!
+//! This function describes up to \e ui32Length bytes of the oldest data in
+//! the buffer, as two runs: the one up to the end of the buffer, and the one
+//! that continues from its start, empty unless the data wraps.  A consumer
+//! such as a peripheral FIFO or the uDMA can then take them in place, instead
+//! of through a copy with RingBufRead().  The bytes stay in the buffer until
+//! they are released by RingBufReadRelease().
+//!
+//! \return Returns the number of bytes described, which is less than
+//! \e ui32Length if the buffer holds fewer.
+//
+//*****************************************************************************
+uint32_t
+RingBufReadPeek(tRingBufObject *psRingBuf, uint32_t ui32Length,
+                tRingBufSpan *psSpan)
+{
+    return(RingBufCoreReadPeek(psRingBuf, ui32Length, psSpan));
+}
+
+//*****************************************************************************
+//
+//! Removes bytes read in place from a ring buffer.
+//!
+//! \param psRingBuf points to the ring buffer read from.
+//! \param ui32Length is the number of bytes read, at most the number
+//! described by RingBufReadPeek().
+//!
+//! This function frees the first \e ui32Length bytes of the data described
+//! by RingBufReadPeek(), for the writer to use again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RingBufReadRelease(tRingBufObject *psRingBuf, uint32_t ui32Length)
+{
+    RingBufCoreAdvanceRead(psRingBuf, ui32Length);
 }
 
 //*****************************************************************************
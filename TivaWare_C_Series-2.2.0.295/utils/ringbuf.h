@@ -25,6 +25,15 @@
 #ifndef __RINGBUF_H__
 #define __RINGBUF_H__
 
+//*****************************************************************************
+//
+// The ring buffer is implemented in utils/ringbuf_core.h, which is shared with
+// the USB library's ring buffer; RINGBUF_SPSC there selects between the
+// single-producer, single-consumer implementation and the original one.
+//
+//*****************************************************************************
+#include "utils/ringbuf_core.h"
+
 //*****************************************************************************
 //
 // If building with a C++ compiler, make all of the definitions in this header
@@ -42,30 +51,7 @@ extern "C"
 // ring buffer.
 //
 //*****************************************************************************
-typedef struct
-{
-    //
-    // The ring buffer size.
-    //
-    uint32_t ui32Size;
-
-    //
-    // The ring buffer write index.
-    //
-    volatile uint32_t ui32WriteIndex;
-
-    //
-    // The ring buffer read index.
-    //
-    volatile uint32_t ui32ReadIndex;
-
-    //
-    // The ring buffer.
-    //
-    uint8_t *pui8Buf;
-
-}
-tRingBufObject;
+typedef tRingBufCore tRingBufObject;
 
 //*****************************************************************************
 //
@@ -92,6 +78,16 @@ extern void RingBufAdvanceRead(tRingBufObject *psRingBuf,
                                 uint32_t ui32NumBytes);
 extern void RingBufInit(tRingBufObject *psRingBuf, uint8_t *pui8Buf,
                         uint32_t ui32Size);
+extern uint32_t RingBufWriteReserve(tRingBufObject *psRingBuf,
+                                    uint32_t ui32Length,
+                                    tRingBufSpan *psSpan);
+extern void RingBufWriteCommit(tRingBufObject *psRingBuf,
+                               uint32_t ui32Length);
+extern uint32_t RingBufReadPeek(tRingBufObject *psRingBuf,
+                                uint32_t ui32Length,
+                                tRingBufSpan *psSpan);
+extern void RingBufReadRelease(tRingBufObject *psRingBuf,
+                               uint32_t ui32Length);
 
 //*****************************************************************************
 //
@@ -0,0 +1,846 @@
+//*****************************************************************************
+//
+// ringbuf_core.h - Ring buffer implementation shared by the utility and USB
+//                  libraries.
+//
+// Copyright (c) 2008-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __RINGBUF_CORE_H__
+#define __RINGBUF_CORE_H__
+
+//*****************************************************************************
+//
+// utils/ringbuf.c (RingBuf*) and usblib/usbringbuf.c (USBRingBuf*) are thin
+// wrappers around the functions below, which are static inline so that
+// neither library needs the other at link time.  Applications use the
+// wrappers; only the types are of interest to them.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// By default, the ring buffers keep their original implementation, which
+// keeps the indices within the buffer, one byte short of full, and updates
+// them with interrupts disabled.
+//
+// With RINGBUF_SPSC defined to 1 by the build, each ring buffer has a single
+// producer and a single consumer, which may run in different contexts (thread
+// and ISR, or the uDMA).  The size must be a power of two; the indices run
+// freely and are masked, and are published after memory barriers, so no
+// function disables interrupts, and all ui32Size bytes can be used.  Flush and
+// AdvanceRead belong to the consumer, and AdvanceWrite to the producer; it no
+// longer discards data.  The setting applies to the ring buffers of both
+// libraries, so every ring buffer of an application built with it must meet
+// these rules.
+//
+//*****************************************************************************
+#ifndef RINGBUF_SPSC
+#define RINGBUF_SPSC            0
+#endif
+
+//*****************************************************************************
+//
+// The structure used for encapsulating all the items associated with a
+// ring buffer.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The ring buffer size.
+    //
+    uint32_t ui32Size;
+
+    //
+    // The ring buffer write index.
+    //
+    volatile uint32_t ui32WriteIndex;
+
+    //
+    // The ring buffer read index.
+    //
+    volatile uint32_t ui32ReadIndex;
+
+    //
+    // The ring buffer.
+    //
+    uint8_t *pui8Buf;
+
+}
+tRingBufCore;
+
+//*****************************************************************************
+//
+// A contiguous run of bytes in a ring buffer.  The span functions describe
+// the space or data they cover with two of these: the run up to the end of
+// the buffer, and the run that continues from its start, of length 0 if
+// none does.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The first byte of the run.
+    //
+    uint8_t *pui8Data;
+
+    //
+    // The number of bytes in the run.
+    //
+    uint32_t ui32Length;
+}
+tRingBufSpan;
+
+//*****************************************************************************
+//
+// Data memory barrier, for the single-producer, single-consumer ring buffers
+// and for other lock-free code of the application.  On a host build, such as
+// a simulation of the target, it is a full fence, as the DMB is.
+//
+//*****************************************************************************
+#if defined(ewarm)
+#include <intrinsics.h>
+#define RingBufBarrier()        __DMB()
+#elif defined(rvmdk) || defined(__ARMCC_VERSION)
+#define RingBufBarrier()        __dmb(0xF)
+#elif defined(ccs)
+#define RingBufBarrier()        __asm("    dmb")
+#elif defined(__arm__)
+#define RingBufBarrier()        __asm volatile("    dmb" : : : "memory")
+#else
+#define RingBufBarrier()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#if !RINGBUF_SPSC
+
+//*****************************************************************************
+//
+// Change the value of a variable atomically.
+//
+// This function is used to increment a read or write buffer index that may be
+// written in various different contexts.  It ensures that the
+// read/modify/write sequence is not interrupted and, hence, guards against
+// corruption of the variable.  The new value is adjusted for buffer wrap.
+//
+//*****************************************************************************
+static inline void
+RingBufCoreUpdateIndex(volatile uint32_t *pui32Val, uint32_t ui32Delta,
+                       uint32_t ui32Size)
+{
+    bool bIntsOff;
+
+    //
+    // Turn interrupts off temporarily.
+    //
+    bIntsOff = IntMasterDisable();
+
+    //
+    // Update the variable value.
+    //
+    *pui32Val += ui32Delta;
+
+    //
+    // Correct for wrap.  We use a loop here since we don't want to use a
+    // modulus operation with interrupts off but we don't want to fail in
+    // case ui32Delta is greater than ui32Size (which is extremely unlikely
+    // but...)
+    //
+    while(*pui32Val >= ui32Size)
+    {
+        *pui32Val -= ui32Size;
+    }
+
+    //
+    // Restore the interrupt state
+    //
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+// The offset into the buffer of an index; the indices stay within the buffer.
+//
+//*****************************************************************************
+static inline uint32_t
+RingBufCoreOffset(const tRingBufCore *psRing, uint32_t ui32Index)
+{
+    return(ui32Index);
+}
+
+static inline bool
+RingBufCoreFull(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    //
+    // Copy the Read/Write indices for calculation.
+    //
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    //
+    // The buffer is full with the write index one behind the read index.
+    //
+    return((((ui32Write + 1) % psRing->ui32Size) == ui32Read) ? true :
+           false);
+}
+
+static inline void
+RingBufCoreFlush(tRingBufCore *psRing)
+{
+    bool bIntsOff;
+
+    ASSERT(psRing != NULL);
+
+    //
+    // Set the Read/Write pointers to be the same.  Do this with interrupts
+    // disabled to prevent the possibility of corruption of the read index.
+    //
+    bIntsOff = IntMasterDisable();
+    psRing->ui32ReadIndex = psRing->ui32WriteIndex;
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+static inline uint32_t
+RingBufCoreUsed(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
+           (psRing->ui32Size - (ui32Read - ui32Write)));
+}
+
+static inline uint32_t
+RingBufCoreFree(tRingBufCore *psRing)
+{
+    ASSERT(psRing != NULL);
+
+    //
+    // One byte is always left empty, to tell a full buffer from an empty one.
+    //
+    return((psRing->ui32Size - 1) - RingBufCoreUsed(psRing));
+}
+
+static inline uint32_t
+RingBufCoreContigUsed(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
+           (psRing->ui32Size - ui32Read));
+}
+
+static inline uint32_t
+RingBufCoreContigFree(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    if(ui32Read > ui32Write)
+    {
+        //
+        // The read pointer is above the write pointer so the amount of free
+        // space is the difference between the two indices minus 1 to account
+        // for the buffer full condition (write index one behind read index).
+        //
+        return((ui32Read - ui32Write) - 1);
+    }
+    else
+    {
+        //
+        // If the write pointer is above the read pointer, the amount of free
+        // space is the size of the buffer minus the write index.  We need to
+        // add a special-case adjustment if the read index is 0 since we need
+        // to leave 1 byte empty to ensure we can tell the difference between
+        // the buffer being full and empty.
+        //
+        return(psRing->ui32Size - ui32Write - ((ui32Read == 0) ? 1 : 0));
+    }
+}
+
+static inline uint8_t
+RingBufCoreReadOne(tRingBufCore *psRing)
+{
+    uint8_t ui8Temp;
+
+    ASSERT(psRing != NULL);
+    ASSERT(RingBufCoreUsed(psRing) != 0);
+
+    ui8Temp = psRing->pui8Buf[psRing->ui32ReadIndex];
+    RingBufCoreUpdateIndex(&psRing->ui32ReadIndex, 1, psRing->ui32Size);
+
+    return(ui8Temp);
+}
+
+static inline void
+RingBufCoreRead(tRingBufCore *psRing, uint8_t *pui8Data, uint32_t ui32Length)
+{
+    uint32_t ui32Temp;
+
+    ASSERT(psRing != NULL);
+    ASSERT(pui8Data != NULL);
+    ASSERT(ui32Length <= RingBufCoreUsed(psRing));
+
+    for(ui32Temp = 0; ui32Temp < ui32Length; ui32Temp++)
+    {
+        pui8Data[ui32Temp] = RingBufCoreReadOne(psRing);
+    }
+}
+
+static inline void
+RingBufCoreAdvanceRead(tRingBufCore *psRing, uint32_t ui32NumBytes)
+{
+    uint32_t ui32Count;
+
+    ASSERT(psRing != NULL);
+
+    //
+    // Make sure that we are not being asked to remove more data than is
+    // there to be removed.
+    //
+    ui32Count = RingBufCoreUsed(psRing);
+    ui32Count = (ui32Count < ui32NumBytes) ? ui32Count : ui32NumBytes;
+
+    RingBufCoreUpdateIndex(&psRing->ui32ReadIndex, ui32Count,
+                           psRing->ui32Size);
+}
+
+static inline void
+RingBufCoreAdvanceWrite(tRingBufCore *psRing, uint32_t ui32NumBytes)
+{
+    uint32_t ui32Count;
+    bool bIntsOff;
+
+    ASSERT(psRing != NULL);
+    ASSERT(ui32NumBytes <= psRing->ui32Size);
+
+    //
+    // Determine how much free space we currently think the buffer has.
+    //
+    ui32Count = RingBufCoreFree(psRing);
+
+    //
+    // Advance the buffer write index by the required number of bytes and
+    // check that we have not run past the read index.  Note that we must do
+    // this within a critical section (interrupts disabled) to prevent
+    // race conditions that could corrupt one or other of the indices.
+    //
+    bIntsOff = IntMasterDisable();
+
+    psRing->ui32WriteIndex += ui32NumBytes;
+    if(psRing->ui32WriteIndex >= psRing->ui32Size)
+    {
+        psRing->ui32WriteIndex -= psRing->ui32Size;
+    }
+
+    //
+    // Did the client add more bytes than the buffer had free space for?
+    //
+    if(ui32Count < ui32NumBytes)
+    {
+        //
+        // Yes - we need to advance the read pointer to ahead of the write
+        // pointer to discard some of the oldest data.
+        //
+        psRing->ui32ReadIndex = psRing->ui32WriteIndex + 1;
+        if(psRing->ui32ReadIndex >= psRing->ui32Size)
+        {
+            psRing->ui32ReadIndex -= psRing->ui32Size;
+        }
+    }
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+static inline void
+RingBufCoreWriteOne(tRingBufCore *psRing, uint8_t ui8Data)
+{
+    ASSERT(psRing != NULL);
+    ASSERT(RingBufCoreFree(psRing) != 0);
+
+    psRing->pui8Buf[psRing->ui32WriteIndex] = ui8Data;
+    RingBufCoreUpdateIndex(&psRing->ui32WriteIndex, 1, psRing->ui32Size);
+}
+
+static inline void
+RingBufCoreWrite(tRingBufCore *psRing, const uint8_t *pui8Data,
+                 uint32_t ui32Length)
+{
+    uint32_t ui32Temp;
+
+    ASSERT(psRing != NULL);
+    ASSERT(pui8Data != NULL);
+    ASSERT(ui32Length <= RingBufCoreFree(psRing));
+
+    for(ui32Temp = 0; ui32Temp < ui32Length; ui32Temp++)
+    {
+        RingBufCoreWriteOne(psRing, pui8Data[ui32Temp]);
+    }
+}
+
+static inline void
+RingBufCoreInit(tRingBufCore *psRing, uint8_t *pui8Buf, uint32_t ui32Size)
+{
+    ASSERT(psRing != NULL);
+    ASSERT(pui8Buf != NULL);
+    ASSERT(ui32Size != 0);
+
+    psRing->ui32Size = ui32Size;
+    psRing->pui8Buf = pui8Buf;
+    psRing->ui32WriteIndex = psRing->ui32ReadIndex = 0;
+}
+
+#else // RINGBUF_SPSC
+
+//*****************************************************************************
+//
+// Single-producer, single-consumer ring buffer.
+//
+// The indices run freely and wrap at 2^32; since the size is a power of two,
+// an index masked with (size - 1) is the offset into the buffer, and the
+// difference of the two indices is the number of bytes stored, from 0 to the
+// full size.  Only the producer writes the write index and only the consumer
+// the read index, so neither needs interrupts disabled.  Each side reads the
+// other's index, puts a barrier between that and its data accesses, and
+// another between its data accesses and the store of its own index, so that
+// the bytes are in place before the consumer sees them, and read out before
+// the producer may overwrite them.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The offset into the buffer of a free-running index.
+//
+//*****************************************************************************
+static inline uint32_t
+RingBufCoreOffset(const tRingBufCore *psRing, uint32_t ui32Index)
+{
+    return(ui32Index & (psRing->ui32Size - 1));
+}
+
+static inline bool
+RingBufCoreFull(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    return((ui32Write - ui32Read) == psRing->ui32Size);
+}
+
+//
+// Called by the consumer.
+//
+static inline void
+RingBufCoreFlush(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    RingBufBarrier();
+    psRing->ui32ReadIndex = ui32Write;
+}
+
+static inline uint32_t
+RingBufCoreUsed(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    return(ui32Write - ui32Read);
+}
+
+static inline uint32_t
+RingBufCoreFree(tRingBufCore *psRing)
+{
+    ASSERT(psRing != NULL);
+
+    return(psRing->ui32Size - RingBufCoreUsed(psRing));
+}
+
+static inline uint32_t
+RingBufCoreContigUsed(tRingBufCore *psRing)
+{
+    uint32_t ui32Read;
+    uint32_t ui32Used;
+    uint32_t ui32Contig;
+
+    ASSERT(psRing != NULL);
+
+    ui32Read = psRing->ui32ReadIndex;
+    ui32Used = psRing->ui32WriteIndex - ui32Read;
+    ui32Contig = psRing->ui32Size - RingBufCoreOffset(psRing, ui32Read);
+
+    return((ui32Used < ui32Contig) ? ui32Used : ui32Contig);
+}
+
+static inline uint32_t
+RingBufCoreContigFree(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Free;
+    uint32_t ui32Contig;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Free = psRing->ui32Size - (ui32Write - psRing->ui32ReadIndex);
+    ui32Contig = psRing->ui32Size - RingBufCoreOffset(psRing, ui32Write);
+
+    return((ui32Free < ui32Contig) ? ui32Free : ui32Contig);
+}
+
+static inline uint8_t
+RingBufCoreReadOne(tRingBufCore *psRing)
+{
+    uint32_t ui32Read;
+    uint8_t ui8Temp;
+
+    ASSERT(psRing != NULL);
+    ASSERT(RingBufCoreUsed(psRing) != 0);
+
+    ui32Read = psRing->ui32ReadIndex;
+    RingBufBarrier();
+    ui8Temp = psRing->pui8Buf[RingBufCoreOffset(psRing, ui32Read)];
+    RingBufBarrier();
+    psRing->ui32ReadIndex = ui32Read + 1;
+
+    return(ui8Temp);
+}
+
+//
+// Copies the bytes out in at most two runs, and then releases them.
+//
+static inline void
+RingBufCoreRead(tRingBufCore *psRing, uint8_t *pui8Data, uint32_t ui32Length)
+{
+    uint32_t ui32Read;
+    uint32_t ui32Offset;
+    uint32_t ui32First;
+
+    ASSERT(psRing != NULL);
+    ASSERT(pui8Data != NULL);
+    ASSERT(ui32Length <= RingBufCoreUsed(psRing));
+
+    ui32Read = psRing->ui32ReadIndex;
+    ui32Offset = RingBufCoreOffset(psRing, ui32Read);
+    ui32First = psRing->ui32Size - ui32Offset;
+    if(ui32First > ui32Length)
+    {
+        ui32First = ui32Length;
+    }
+
+    RingBufBarrier();
+    memcpy(pui8Data, psRing->pui8Buf + ui32Offset, ui32First);
+    if(ui32First < ui32Length)
+    {
+        memcpy(pui8Data + ui32First, psRing->pui8Buf, ui32Length - ui32First);
+    }
+    RingBufBarrier();
+    psRing->ui32ReadIndex = ui32Read + ui32Length;
+}
+
+//
+// Called by the consumer, for example once the uDMA has sent the bytes.
+//
+static inline void
+RingBufCoreAdvanceRead(tRingBufCore *psRing, uint32_t ui32NumBytes)
+{
+    uint32_t ui32Count;
+
+    ASSERT(psRing != NULL);
+
+    ui32Count = RingBufCoreUsed(psRing);
+    ui32Count = (ui32Count < ui32NumBytes) ? ui32Count : ui32NumBytes;
+
+    RingBufBarrier();
+    psRing->ui32ReadIndex += ui32Count;
+}
+
+//
+// Called by the producer.  The read index belongs to the consumer, so unlike
+// the original implementation, this cannot discard the oldest data to make
+// room: the bytes added are limited to the free space.
+//
+static inline void
+RingBufCoreAdvanceWrite(tRingBufCore *psRing, uint32_t ui32NumBytes)
+{
+    uint32_t ui32Count;
+
+    ASSERT(psRing != NULL);
+    ASSERT(ui32NumBytes <= RingBufCoreFree(psRing));
+
+    ui32Count = RingBufCoreFree(psRing);
+    ui32Count = (ui32Count < ui32NumBytes) ? ui32Count : ui32NumBytes;
+
+    RingBufBarrier();
+    psRing->ui32WriteIndex += ui32Count;
+}
+
+static inline void
+RingBufCoreWriteOne(tRingBufCore *psRing, uint8_t ui8Data)
+{
+    uint32_t ui32Write;
+
+    ASSERT(psRing != NULL);
+    ASSERT(RingBufCoreFree(psRing) != 0);
+
+    ui32Write = psRing->ui32WriteIndex;
+    RingBufBarrier();
+    psRing->pui8Buf[RingBufCoreOffset(psRing, ui32Write)] = ui8Data;
+    RingBufBarrier();
+    psRing->ui32WriteIndex = ui32Write + 1;
+}
+
+//
+// Copies the bytes in in at most two runs, and then publishes them.
+//
+static inline void
+RingBufCoreWrite(tRingBufCore *psRing, const uint8_t *pui8Data,
+                 uint32_t ui32Length)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Offset;
+    uint32_t ui32First;
+
+    ASSERT(psRing != NULL);
+    ASSERT(pui8Data != NULL);
+    ASSERT(ui32Length <= RingBufCoreFree(psRing));
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Offset = RingBufCoreOffset(psRing, ui32Write);
+    ui32First = psRing->ui32Size - ui32Offset;
+    if(ui32First > ui32Length)
+    {
+        ui32First = ui32Length;
+    }
+
+    RingBufBarrier();
+    memcpy(psRing->pui8Buf + ui32Offset, pui8Data, ui32First);
+    if(ui32First < ui32Length)
+    {
+        memcpy(psRing->pui8Buf, pui8Data + ui32First, ui32Length - ui32First);
+    }
+    RingBufBarrier();
+    psRing->ui32WriteIndex = ui32Write + ui32Length;
+}
+
+static inline void
+RingBufCoreInit(tRingBufCore *psRing, uint8_t *pui8Buf, uint32_t ui32Size)
+{
+    ASSERT(psRing != NULL);
+    ASSERT(pui8Buf != NULL);
+    ASSERT((ui32Size != 0) && ((ui32Size & (ui32Size - 1)) == 0));
+
+    psRing->ui32Size = ui32Size;
+    psRing->pui8Buf = pui8Buf;
+    psRing->ui32WriteIndex = psRing->ui32ReadIndex = 0;
+}
+
+#endif // RINGBUF_SPSC
+
+//*****************************************************************************
+//
+// The functions below are common to both implementations.
+//
+//*****************************************************************************
+static inline bool
+RingBufCoreEmpty(tRingBufCore *psRing)
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+
+    ASSERT(psRing != NULL);
+
+    ui32Write = psRing->ui32WriteIndex;
+    ui32Read = psRing->ui32ReadIndex;
+
+    return((ui32Write == ui32Read) ? true : false);
+}
+
+static inline uint32_t
+RingBufCoreSize(tRingBufCore *psRing)
+{
+    ASSERT(psRing != NULL);
+
+    return(psRing->ui32Size);
+}
+
+//*****************************************************************************
+//
+// Describe, as two spans, the ui32Length bytes from the offset of an index,
+// running over the end of the buffer to its start.
+//
+//*****************************************************************************
+static inline void
+RingBufCoreSpans(tRingBufCore *psRing, uint32_t ui32Index,
+                 uint32_t ui32Length, tRingBufSpan *psSpan)
+{
+    uint32_t ui32Offset;
+    uint32_t ui32First;
+
+    ui32Offset = RingBufCoreOffset(psRing, ui32Index);
+    ui32First = psRing->ui32Size - ui32Offset;
+    if(ui32First > ui32Length)
+    {
+        ui32First = ui32Length;
+    }
+
+    psSpan[0].pui8Data = psRing->pui8Buf + ui32Offset;
+    psSpan[0].ui32Length = ui32First;
+    psSpan[1].pui8Data = psRing->pui8Buf;
+    psSpan[1].ui32Length = ui32Length - ui32First;
+}
+
+//*****************************************************************************
+//
+// Producer: describe up to ui32Length bytes of free space, from the write
+// index, and return their number.  The bytes written there are added by
+// RingBufCoreAdvanceWrite().
+//
+//*****************************************************************************
+static inline uint32_t
+RingBufCoreWriteReserve(tRingBufCore *psRing, uint32_t ui32Length,
+                        tRingBufSpan *psSpan)
+{
+    uint32_t ui32Free;
+
+    ASSERT(psRing != NULL);
+    ASSERT(psSpan != NULL);
+
+    ui32Free = RingBufCoreFree(psRing);
+    if(ui32Length > ui32Free)
+    {
+        ui32Length = ui32Free;
+    }
+
+    //
+    // On the consumer's side of the barrier, the free space has been read out.
+    //
+#if RINGBUF_SPSC
+    RingBufBarrier();
+#endif
+    RingBufCoreSpans(psRing, psRing->ui32WriteIndex, ui32Length, psSpan);
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+// Consumer: describe up to ui32Length bytes of data, from the read index,
+// and return their number.  They stay in the buffer until released by
+// RingBufCoreAdvanceRead().
+//
+//*****************************************************************************
+static inline uint32_t
+RingBufCoreReadPeek(tRingBufCore *psRing, uint32_t ui32Length,
+                    tRingBufSpan *psSpan)
+{
+    uint32_t ui32Used;
+
+    ASSERT(psRing != NULL);
+    ASSERT(psSpan != NULL);
+
+    ui32Used = RingBufCoreUsed(psRing);
+    if(ui32Length > ui32Used)
+    {
+        ui32Length = ui32Used;
+    }
+
+    //
+    // On the producer's side of the barrier, the data has been written.
+    //
+#if RINGBUF_SPSC
+    RingBufBarrier();
+#endif
+    RingBufCoreSpans(psRing, psRing->ui32ReadIndex, ui32Length, psSpan);
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RINGBUF_CORE_H__
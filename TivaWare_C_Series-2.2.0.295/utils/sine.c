@@ -23,6 +23,7 @@
 //*****************************************************************************
 
 #include <stdint.h>
+#include <string.h>
 #include "utils/sine.h"
 
 //*****************************************************************************
@@ -58,6 +59,131 @@ static const uint16_t g_pui16FixedSineTable[] =
     0xFFEC, 0xFFFB, 0xFFFF
 };
 
+//*****************************************************************************
+//
+// A table of the sine function over a whole circle with 256 entries, for
+// SineOscillatorFill().  Each entry packs the sine, in 1.15 fixed point
+// notation, in its lower half, and the difference to the next entry in its
+// upper half, so that one dual 16-bit multiply interpolates between them.
+//
+//*****************************************************************************
+static const uint32_t g_pui32SineSlopeTable[256] =
+{
+    0x03240000, 0x03240324, 0x03220648, 0x0322096A, 0x031F0C8C, 0x031D0FAB,
+    0x031A12C8, 0x031715E2, 0x031218F9, 0x030F1C0B, 0x03091F1A, 0x03052223,
+    0x02FE2528, 0x02F92826, 0x02F22B1F, 0x02EA2E11, 0x02E430FB, 0x02DB33DF,
+    0x02D236BA, 0x02CA398C, 0x02C13C56, 0x02B73F17, 0x02AC41CE, 0x02A2447A,
+    0x0298471C, 0x028B49B4, 0x02804C3F, 0x02744EBF, 0x02685133, 0x025A539B,
+    0x024D55F5, 0x02405842, 0x02315A82, 0x02245CB3, 0x02145ED7, 0x020660EB,
+    0x01F762F1, 0x01E764E8, 0x01D766CF, 0x01C768A6, 0x01B66A6D, 0x01A66C23,
+    0x01956DC9, 0x01846F5E, 0x017270E2, 0x01617254, 0x014F73B5, 0x013D7504,
+    0x012A7641, 0x0119776B, 0x01057884, 0x00F37989, 0x00E07A7C, 0x00CD7B5C,
+    0x00BA7C29, 0x00A67CE3, 0x00947D89, 0x007F7E1D, 0x006D7E9C, 0x00587F09,
+    0x00457F61, 0x00327FA6, 0x001D7FD8, 0x000A7FF5, 0xFFF67FFF, 0xFFE37FF5,
+    0xFFCE7FD8, 0xFFBB7FA6, 0xFFA87F61, 0xFF937F09, 0xFF817E9C, 0xFF6C7E1D,
+    0xFF5A7D89, 0xFF467CE3, 0xFF337C29, 0xFF207B5C, 0xFF0D7A7C, 0xFEFB7989,
+    0xFEE77884, 0xFED6776B, 0xFEC37641, 0xFEB17504, 0xFE9F73B5, 0xFE8E7254,
+    0xFE7C70E2, 0xFE6B6F5E, 0xFE5A6DC9, 0xFE4A6C23, 0xFE396A6D, 0xFE2968A6,
+    0xFE1966CF, 0xFE0964E8, 0xFDFA62F1, 0xFDEC60EB, 0xFDDC5ED7, 0xFDCF5CB3,
+    0xFDC05A82, 0xFDB35842, 0xFDA655F5, 0xFD98539B, 0xFD8C5133, 0xFD804EBF,
+    0xFD754C3F, 0xFD6849B4, 0xFD5E471C, 0xFD54447A, 0xFD4941CE, 0xFD3F3F17,
+    0xFD363C56, 0xFD2E398C, 0xFD2536BA, 0xFD1C33DF, 0xFD1630FB, 0xFD0E2E11,
+    0xFD072B1F, 0xFD022826, 0xFCFB2528, 0xFCF72223, 0xFCF11F1A, 0xFCEE1C0B,
+    0xFCE918F9, 0xFCE615E2, 0xFCE312C8, 0xFCE10FAB, 0xFCDE0C8C, 0xFCDE096A,
+    0xFCDC0648, 0xFCDC0324, 0xFCDC0000, 0xFCDCFCDC, 0xFCDEF9B8, 0xFCDEF696,
+    0xFCE1F374, 0xFCE3F055, 0xFCE6ED38, 0xFCE9EA1E, 0xFCEEE707, 0xFCF1E3F5,
+    0xFCF7E0E6, 0xFCFBDDDD, 0xFD02DAD8, 0xFD07D7DA, 0xFD0ED4E1, 0xFD16D1EF,
+    0xFD1CCF05, 0xFD25CC21, 0xFD2EC946, 0xFD36C674, 0xFD3FC3AA, 0xFD49C0E9,
+    0xFD54BE32, 0xFD5EBB86, 0xFD68B8E4, 0xFD75B64C, 0xFD80B3C1, 0xFD8CB141,
+    0xFD98AECD, 0xFDA6AC65, 0xFDB3AA0B, 0xFDC0A7BE, 0xFDCFA57E, 0xFDDCA34D,
+    0xFDECA129, 0xFDFA9F15, 0xFE099D0F, 0xFE199B18, 0xFE299931, 0xFE39975A,
+    0xFE4A9593, 0xFE5A93DD, 0xFE6B9237, 0xFE7C90A2, 0xFE8E8F1E, 0xFE9F8DAC,
+    0xFEB18C4B, 0xFEC38AFC, 0xFED689BF, 0xFEE78895, 0xFEFB877C, 0xFF0D8677,
+    0xFF208584, 0xFF3384A4, 0xFF4683D7, 0xFF5A831D, 0xFF6C8277, 0xFF8181E3,
+    0xFF938164, 0xFFA880F7, 0xFFBB809F, 0xFFCE805A, 0xFFE38028, 0xFFF6800B,
+    0x000A8001, 0x001D800B, 0x00328028, 0x0045805A, 0x0058809F, 0x006D80F7,
+    0x007F8164, 0x009481E3, 0x00A68277, 0x00BA831D, 0x00CD83D7, 0x00E084A4,
+    0x00F38584, 0x01058677, 0x0119877C, 0x012A8895, 0x013D89BF, 0x014F8AFC,
+    0x01618C4B, 0x01728DAC, 0x01848F1E, 0x019590A2, 0x01A69237, 0x01B693DD,
+    0x01C79593, 0x01D7975A, 0x01E79931, 0x01F79B18, 0x02069D0F, 0x02149F15,
+    0x0224A129, 0x0231A34D, 0x0240A57E, 0x024DA7BE, 0x025AAA0B, 0x0268AC65,
+    0x0274AECD, 0x0280B141, 0x028BB3C1, 0x0298B64C, 0x02A2B8E4, 0x02ACBB86,
+    0x02B7BE32, 0x02C1C0E9, 0x02CAC3AA, 0x02D2C674, 0x02DBC946, 0x02E4CC21,
+    0x02EACF05, 0x02F2D1EF, 0x02F9D4E1, 0x02FED7DA, 0x0305DAD8, 0x0309DDDD,
+    0x030FE0E6, 0x0312E3F5, 0x0317E707, 0x031AEA1E, 0x031DED38, 0x031FF055,
+    0x0322F374, 0x0322F696, 0x0324F9B8, 0x0324FCDC
+};
+
+//*****************************************************************************
+//
+// The packed multiplies of SineOscillatorFill().  On a Cortex-M4 these are
+// single DSP instructions; elsewhere, C code gives the same results, so that
+// the oscillator can run and be checked on any processor.
+//
+//*****************************************************************************
+#if defined(__ARM_FEATURE_DSP) && defined(__GNUC__)
+static inline int32_t
+SineSMUAD(uint32_t ui32A, uint32_t ui32B)
+{
+    int32_t i32Result;
+
+    //
+    // Add the products of the lower halves and of the upper halves.
+    //
+    __asm("smuad %0, %1, %2" : "=r" (i32Result) : "r" (ui32A), "r" (ui32B));
+    return(i32Result);
+}
+
+static inline int32_t
+SineSMMULR(int32_t i32A, int32_t i32B)
+{
+    int32_t i32Result;
+
+    //
+    // Take the upper word of the product, rounded.
+    //
+    __asm("smmulr %0, %1, %2" : "=r" (i32Result) : "r" (i32A), "r" (i32B));
+    return(i32Result);
+}
+
+static inline uint32_t
+SinePKHBT(int32_t i32Low, int32_t i32High)
+{
+    uint32_t ui32Result;
+
+    //
+    // Pack the lower halves of two words into one.
+    //
+    __asm("pkhbt %0, %1, %2, lsl #16" : "=r" (ui32Result) :
+          "r" (i32Low), "r" (i32High));
+    return(ui32Result);
+}
+#else
+static inline int32_t
+SineSMUAD(uint32_t ui32A, uint32_t ui32B)
+{
+    //
+    // Add unsigned, so that the one sum that overflows, of two products of
+    // -32768 by -32768, wraps as the instruction's does.
+    //
+    return((int32_t)((uint32_t)((int32_t)(int16_t)ui32A * (int16_t)ui32B) +
+                     (uint32_t)((int32_t)(int16_t)(ui32A >> 16) *
+                                (int16_t)(ui32B >> 16))));
+}
+
+static inline int32_t
+SineSMMULR(int32_t i32A, int32_t i32B)
+{
+    return((int32_t)((((int64_t)i32A * i32B) + 0x80000000) >> 32));
+}
+
+static inline uint32_t
+SinePKHBT(int32_t i32Low, int32_t i32High)
+{
+    return(((uint32_t)i32Low & 0xFFFF) | ((uint32_t)i32High << 16));
+}
+#endif
+
 //*****************************************************************************
 //
 //! Computes an approximation of the sine of the input angle.
@@ -118,6 +244,272 @@ sine(uint32_t ui32Angle)
     }
 }
 
+//*****************************************************************************
+//
+//! Computes the sine of the input angle, interpolated linearly.
+//!
+//! \param ui32Angle is an angle expressed as a 0.32 fixed-point value that is
+//! the percentage of the way around a circle.
+//!
+//! This function computes the sine for the given input angle, as sine() does,
+//! but interpolates linearly between the two entries of the sine table on
+//! either side of the angle instead of taking the nearest one.  The result is
+//! within 3/65536 of the sine, where sine() can be 1/160 off.
+//!
+//! \return Returns the sine of the angle, in 16.16 fixed point format.
+//
+//*****************************************************************************
+int32_t
+SineLinear(uint32_t ui32Angle)
+{
+    uint32_t ui32Pos, ui32Idx, ui32Frac, ui32Value;
+
+    //
+    // Get the position within the quarter circle, from 0 to 0x40000000.  If
+    // bit 30 is set, the angle is between 90 and 180 or 270 and 360, and the
+    // position is counted back from 90 degrees.
+    //
+    ui32Pos = ui32Angle & 0x3FFFFFFF;
+    if(ui32Angle & 0x40000000)
+    {
+        ui32Pos = 0x40000000 - ui32Pos;
+    }
+
+    //
+    // Get the index into the sine table from bits 30:23, and the fraction of
+    // the way to the next entry from bits 22:7.
+    //
+    ui32Idx = ui32Pos >> 23;
+    ui32Frac = (ui32Pos >> 7) & 0xFFFF;
+
+    //
+    // Interpolate between the two entries.  At 90 degrees there is no next
+    // entry, and no fraction either.
+    //
+    ui32Value = g_pui16FixedSineTable[ui32Idx];
+    if(ui32Frac)
+    {
+        ui32Value += (((g_pui16FixedSineTable[ui32Idx + 1] - ui32Value) *
+                       ui32Frac) + 0x8000) >> 16;
+    }
+
+    //
+    // If bit 31 is set, the angle is between 180 and 360.  In this case, the
+    // sine value is negative; otherwise it is positive.
+    //
+    if(ui32Angle & 0x80000000)
+    {
+        return(0 - ui32Value);
+    }
+    else
+    {
+        return(ui32Value);
+    }
+}
+
+//*****************************************************************************
+//
+//! Computes the sine of the input angle, interpolated quadratically.
+//!
+//! \param ui32Angle is an angle expressed as a 0.32 fixed-point value that is
+//! the percentage of the way around a circle.
+//!
+//! This function computes the sine for the given input angle, as sine() does,
+//! but fits a parabola through the nearest entry of the sine table and the
+//! entries on either side of it.  The result is within 2/65536 of the sine;
+//! the entries of the table are rounded, and the one for 90 degrees is 1/65536
+//! short of 1.
+//!
+//! \return Returns the sine of the angle, in 16.16 fixed point format.
+//
+//*****************************************************************************
+int32_t
+SineQuadratic(uint32_t ui32Angle)
+{
+    uint32_t ui32Pos, ui32Idx;
+    int32_t i32Frac, i32Prev, i32Entry, i32Next, i32Value;
+
+    //
+    // Get the position within the quarter circle, from 0 to 0x40000000, as
+    // SineLinear() does.
+    //
+    ui32Pos = ui32Angle & 0x3FFFFFFF;
+    if(ui32Angle & 0x40000000)
+    {
+        ui32Pos = 0x40000000 - ui32Pos;
+    }
+
+    //
+    // Get the index of the nearest entry of the sine table, and the fraction
+    // of the way to the entry before (negative) or after (positive) it, in
+    // 0.16 fixed point notation.
+    //
+    ui32Idx = (ui32Pos + 0x00400000) >> 23;
+    i32Frac = (int32_t)(ui32Pos - (ui32Idx << 23)) >> 7;
+
+    //
+    // Get the entry and its neighbors.  The sine is odd about 0 degrees and
+    // even about 90 degrees, which gives the neighbors past the ends of the
+    // table.
+    //
+    i32Entry = g_pui16FixedSineTable[ui32Idx];
+    i32Prev = (ui32Idx > 0) ? g_pui16FixedSineTable[ui32Idx - 1] :
+                              -g_pui16FixedSineTable[1];
+    i32Next = (ui32Idx < 128) ? g_pui16FixedSineTable[ui32Idx + 1] :
+                                g_pui16FixedSineTable[127];
+
+    //
+    // Add the slope and the curvature terms of the parabola through the three
+    // entries, each rounded.
+    //
+    i32Value = (i32Entry +
+                (((i32Frac * (i32Next - i32Prev)) + 0x10000) >> 17) +
+                (((((i32Frac * i32Frac) >> 16) *
+                   (i32Next - (2 * i32Entry) + i32Prev)) + 0x10000) >> 17));
+
+    //
+    // If bit 31 is set, the angle is between 180 and 360.  In this case, the
+    // sine value is negative; otherwise it is positive.
+    //
+    if(ui32Angle & 0x80000000)
+    {
+        return(0 - i32Value);
+    }
+    else
+    {
+        return(i32Value);
+    }
+}
+
+//*****************************************************************************
+//
+// Compute one sample of a sine oscillator: interpolate between the two
+// entries of the packed table on either side of the phase with one dual
+// multiply, in 1.15 fixed point notation scaled by 2^14, and scale by the
+// amplitude with the rounded upper word of a product.
+//
+//*****************************************************************************
+static inline int32_t
+SineOscillatorSample(uint32_t ui32Phase, int32_t i32Scale)
+{
+    uint32_t ui32Entry, ui32Weights;
+
+    //
+    // The entry is selected by bits 31:24 of the phase; bits 23:10 are the
+    // fraction of the way to the next one, weighting its difference in the
+    // upper half, against 1.0 in 2.14 fixed point for the sine in the lower.
+    //
+    ui32Entry = g_pui32SineSlopeTable[ui32Phase >> 24];
+    ui32Weights = ((ui32Phase << 6) & 0x3FFF0000) | 0x4000;
+
+    return(SineSMMULR(SineSMUAD(ui32Entry, ui32Weights), i32Scale));
+}
+
+//*****************************************************************************
+//
+//! Initializes a sine oscillator.
+//!
+//! \param psOscillator points to the oscillator to initialize.
+//! \param ui32Step is the phase step from one sample to the next, as a 0.32
+//! fixed-point fraction of a circle; SINE_OSCILLATOR_STEP() computes it from
+//! a frequency and a sample rate.
+//! \param ui32Phase is the phase of the first sample, as a 0.32 fixed-point
+//! fraction of a circle; 0x40000000 starts a cosine.
+//! \param i16Amplitude is the amplitude of the tone, in 1.15 fixed point
+//! format.
+//!
+//! This function sets up an oscillator for SineOscillatorFill().  The fields
+//! of the oscillator can be changed between blocks: \e ui32Step to change the
+//! frequency without a jump in phase.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SineOscillatorInit(tSineOscillator *psOscillator, uint32_t ui32Step,
+                   uint32_t ui32Phase, int16_t i16Amplitude)
+{
+    psOscillator->ui32Phase = ui32Phase;
+    psOscillator->ui32Step = ui32Step;
+
+    //
+    // The sample comes out of the dual multiply scaled by 2^29; the upper
+    // word of its product with the amplitude times 8 is the sample at the
+    // amplitude, in 1.15 fixed point format.
+    //
+    psOscillator->i32Scale = (int32_t)i16Amplitude * 8;
+}
+
+//*****************************************************************************
+//
+//! Fills a block of samples from a sine oscillator.
+//!
+//! \param psOscillator points to the oscillator.
+//! \param pi16Samples points to the buffer for the samples.
+//! \param ui32Count is the number of samples to compute.
+//!
+//! This function computes the next \e ui32Count samples of the tone of the
+//! oscillator, in 1.15 fixed point format, and advances its phase past them.
+//! Each sample is interpolated linearly in a 256-entry table of the sine over
+//! a whole circle, and is within 5/32768 of the amplitude times the sine of
+//! its phase.  On a Cortex-M4 the interpolation is one dual 16-bit multiply,
+//! and pairs of samples are stored as one word.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SineOscillatorFill(tSineOscillator *psOscillator, int16_t *pi16Samples,
+                   uint32_t ui32Count)
+{
+    uint32_t ui32Phase, ui32Step, ui32Packed;
+    int32_t i32Scale, i32Sample0, i32Sample1;
+
+    ui32Phase = psOscillator->ui32Phase;
+    ui32Step = psOscillator->ui32Step;
+    i32Scale = psOscillator->i32Scale;
+
+    //
+    // Compute one sample on its own if the buffer does not start on a word.
+    //
+    if(((uintptr_t)pi16Samples & 2) && ui32Count)
+    {
+        *pi16Samples++ = SineOscillatorSample(ui32Phase, i32Scale);
+        ui32Phase += ui32Step;
+        ui32Count--;
+    }
+
+    //
+    // Compute two samples at a time, and store them packed in one word.  The
+    // word is copied rather than stored through a uint32_t pointer, which
+    // would alias the int16_t samples; compilers make the copy one store.
+    //
+    while(ui32Count >= 2)
+    {
+        i32Sample0 = SineOscillatorSample(ui32Phase, i32Scale);
+        i32Sample1 = SineOscillatorSample(ui32Phase + ui32Step, i32Scale);
+        ui32Packed = SinePKHBT(i32Sample0, i32Sample1);
+        memcpy(pi16Samples, &ui32Packed, sizeof(ui32Packed));
+        pi16Samples += 2;
+        ui32Phase += 2 * ui32Step;
+        ui32Count -= 2;
+    }
+
+    //
+    // Compute the last sample of an odd count.
+    //
+    if(ui32Count)
+    {
+        *pi16Samples = SineOscillatorSample(ui32Phase, i32Scale);
+        ui32Phase += ui32Step;
+    }
+
+    //
+    // Save the phase of the next sample.
+    //
+    psOscillator->ui32Phase = ui32Phase;
+}
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
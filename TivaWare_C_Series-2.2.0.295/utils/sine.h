@@ -59,6 +59,55 @@ extern "C"
 //*****************************************************************************
 #define cosine(ui32Angle)         sine((ui32Angle) + 0x40000000)
 
+//*****************************************************************************
+//
+//! Computes the cosine of the input angle, interpolated linearly.
+//!
+//! \param ui32Angle is an angle expressed as a 0.32 fixed-point value that is
+//! the percentage of the way around a circle.
+//!
+//! This function computes the cosine for the given input angle with
+//! SineLinear().
+//!
+//! \return Returns the cosine of the angle, in 16.16 fixed point format.
+//
+//*****************************************************************************
+#define CosineLinear(ui32Angle)   SineLinear((ui32Angle) + 0x40000000)
+
+//*****************************************************************************
+//
+//! Computes the cosine of the input angle, interpolated quadratically.
+//!
+//! \param ui32Angle is an angle expressed as a 0.32 fixed-point value that is
+//! the percentage of the way around a circle.
+//!
+//! This function computes the cosine for the given input angle with
+//! SineQuadratic().
+//!
+//! \return Returns the cosine of the angle, in 16.16 fixed point format.
+//
+//*****************************************************************************
+#define CosineQuadratic(ui32Angle)                                            \
+                                  SineQuadratic((ui32Angle) + 0x40000000)
+
+//*****************************************************************************
+//
+//! Computes the phase step of a sine oscillator.
+//!
+//! \param ui32Frequency is the frequency of the tone, in Hz.
+//! \param ui32SampleRate is the sample rate, in Hz.
+//!
+//! This macro computes the phase step for SineOscillatorInit() that gives a
+//! tone of the given frequency at the given sample rate.  The frequency must
+//! be less than the sample rate.
+//!
+//! \return Returns the phase step, as a 0.32 fixed-point fraction of a circle
+//! per sample.
+//
+//*****************************************************************************
+#define SINE_OSCILLATOR_STEP(ui32Frequency, ui32SampleRate)                   \
+        ((uint32_t)(((uint64_t)(ui32Frequency) << 32) / (ui32SampleRate)))
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
@@ -68,10 +117,44 @@ extern "C"
 
 //*****************************************************************************
 //
-// Prototype for the fixed point sine function.
+// The state of a sine oscillator, which fills blocks of samples with
+// SineOscillatorFill().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The phase of the next sample, as a 0.32 fixed-point fraction of a
+    // circle.
+    //
+    uint32_t ui32Phase;
+
+    //
+    // The phase step from one sample to the next.
+    //
+    uint32_t ui32Step;
+
+    //
+    // The amplitude, in 1.15 fixed point format, scaled for the packed
+    // multiply of SineOscillatorFill().
+    //
+    int32_t i32Scale;
+}
+tSineOscillator;
+
+//*****************************************************************************
+//
+// Prototypes for the fixed point sine functions.
 //
 //*****************************************************************************
 extern int32_t sine(uint32_t ui32Angle);
+extern int32_t SineLinear(uint32_t ui32Angle);
+extern int32_t SineQuadratic(uint32_t ui32Angle);
+extern void SineOscillatorInit(tSineOscillator *psOscillator,
+                               uint32_t ui32Step, uint32_t ui32Phase,
+                               int16_t i16Amplitude);
+extern void SineOscillatorFill(tSineOscillator *psOscillator,
+                               int16_t *pi16Samples, uint32_t ui32Count);
 
 //*****************************************************************************
 //
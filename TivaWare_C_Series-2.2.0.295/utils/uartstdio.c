@@ -125,6 +125,7 @@ static volatile uint32_t g_ui32UARTRxReadIndex = 0;
 //*****************************************************************************
 static uint32_t g_ui32Base = 0;
 
+#if !UFORMAT_CORE
 //*****************************************************************************
 //
 // A mapping from an integer between 0 and 15 to its ASCII character
@@ -132,6 +133,7 @@ static uint32_t g_ui32Base = 0;
 //
 //*****************************************************************************
 static const char * const g_pcHex = "0123456789abcdef";
+#endif
 
 //*****************************************************************************
 //
@@ -826,6 +828,35 @@ UARTgetc(void)
 #endif
 }
 
+//*****************************************************************************
+//
+// Write the output of the formatting engine gathered in its buffer to the
+// UART, and empty the buffer.
+//
+//*****************************************************************************
+static void
+UARTFormatFlush(tUFormatOut *psOut)
+{
+    UARTwrite(psOut->pcStart, psOut->pcPos - psOut->pcStart);
+    psOut->pcPos = psOut->pcStart;
+}
+
+//*****************************************************************************
+//
+// Set up the output of the formatting engine to gather in a buffer of
+// UART_FORMAT_BUFFER_SIZE characters, written to the UART as it fills.
+//
+//*****************************************************************************
+static void
+UARTFormatStart(tUFormatOut *psOut, char *pcBuf)
+{
+    psOut->pcStart = pcBuf;
+    psOut->pcPos = pcBuf;
+    psOut->pcEnd = pcBuf + UART_FORMAT_BUFFER_SIZE;
+    psOut->ui32Count = 0;
+    psOut->pfnFlush = UARTFormatFlush;
+}
+
 //*****************************************************************************
 //
 //! A simple UART based vprintf function supporting \%c, \%d, \%p, \%s, \%u,
@@ -861,12 +892,36 @@ UARTgetc(void)
 //! requirements of the format string.  For example, if an integer was passed
 //! where a string was expected, an error of some kind will most likely occur.
 //!
+//! The formatting is done by the engine in utils/uformat_core.h, which
+//! uvsnprintf() shares, unless \b UFORMAT_CORE is defined to 0.  The output
+//! is gathered in a buffer of \b UART_FORMAT_BUFFER_SIZE characters on the
+//! stack, and written to the UART each time it fills.
+//!
 //! \return None.
 //
 //*****************************************************************************
 void
 UARTvprintf(const char *pcString, va_list vaArgP)
 {
+#if UFORMAT_CORE
+    char pcBuf[UART_FORMAT_BUFFER_SIZE];
+    tUFormatOut sOut;
+    va_list vaArg;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pcString != 0);
+
+    //
+    // Format the string, and write what is left in the buffer.
+    //
+    UARTFormatStart(&sOut, pcBuf);
+    va_copy(vaArg, vaArgP);
+    UFormatRun(&sOut, pcString, &vaArg);
+    va_end(vaArg);
+    UARTFormatFlush(&sOut);
+#else
     uint32_t ui32Idx, ui32Value, ui32Pos, ui32Count, ui32Base, ui32Neg;
     char *pcStr, pcBuf[16], cFill;
 
@@ -1256,6 +1311,44 @@ convert:
             }
         }
     }
+#endif
+}
+
+//*****************************************************************************
+//
+//! A UART based vprintf function for a format string parsed by
+//! UFormatCompile().
+//!
+//! \param psFormat is the pre-parsed format.
+//! \param vaArgP is a variable argument list pointer whose content will depend
+//! upon the format string of \e psFormat.
+//!
+//! This function sends the same output as UARTvprintf() given the format
+//! string of \e psFormat, without parsing the string again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTvprintfc(const tUFormat *psFormat, va_list vaArgP)
+{
+    char pcBuf[UART_FORMAT_BUFFER_SIZE];
+    tUFormatOut sOut;
+    va_list vaArg;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psFormat != 0);
+
+    //
+    // Format the string, and write what is left in the buffer.
+    //
+    UARTFormatStart(&sOut, pcBuf);
+    va_copy(vaArg, vaArgP);
+    UFormatRunCompiled(&sOut, psFormat, &vaArg);
+    va_end(vaArg);
+    UARTFormatFlush(&sOut);
 }
 
 //*****************************************************************************
@@ -1314,6 +1407,40 @@ UARTprintf(const char *pcString, ...)
     va_end(vaArgP);
 }
 
+//*****************************************************************************
+//
+//! A UART based printf function for a format string parsed by
+//! UFormatCompile().
+//!
+//! \param psFormat is the pre-parsed format.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function sends the same output as UARTprintf() given the format
+//! string of \e psFormat, without parsing the string again; see usnprintfc()
+//! for an example.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTprintfc(const tUFormat *psFormat, ...)
+{
+    va_list vaArgP;
+
+    //
+    // Start the varargs processing.
+    //
+    va_start(vaArgP, psFormat);
+
+    UARTvprintfc(psFormat, vaArgP);
+
+    //
+    // We're finished with the varargs now.
+    //
+    va_end(vaArgP);
+}
+
 //*****************************************************************************
 //
 //! Returns the number of bytes available in the receive buffer.
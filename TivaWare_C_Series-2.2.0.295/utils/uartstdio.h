@@ -26,6 +26,7 @@
 #define __UARTSTDIO_H__
 
 #include <stdarg.h>
+#include "utils/uformat_core.h"
 
 //*****************************************************************************
 //
@@ -53,6 +54,16 @@ extern "C"
 #endif
 #endif
 
+//*****************************************************************************
+//
+// The size of the buffer on the stack in which UARTprintf() gathers its
+// output before writing it to the UART.
+//
+//*****************************************************************************
+#ifndef UART_FORMAT_BUFFER_SIZE
+#define UART_FORMAT_BUFFER_SIZE 32
+#endif
+
 //*****************************************************************************
 //
 // Prototypes for the APIs.
@@ -62,8 +73,11 @@ extern void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud,
                             uint32_t ui32SrcClock);
 extern int UARTgets(char *pcBuf, uint32_t ui32Len);
 extern unsigned char UARTgetc(void);
-extern void UARTprintf(const char *pcString, ...);
-extern void UARTvprintf(const char *pcString, va_list vaArgP);
+extern void UARTprintf(const char *pcString, ...) UFORMAT_PRINTF(1, 2);
+extern void UARTprintfc(const tUFormat *psFormat, ...);
+extern void UARTvprintf(const char *pcString, va_list vaArgP)
+                        UFORMAT_PRINTF(1, 0);
+extern void UARTvprintfc(const tUFormat *psFormat, va_list vaArgP);
 extern int UARTwrite(const char *pcBuf, uint32_t ui32Len);
 #ifdef UART_BUFFERED
 extern int UARTPeek(unsigned char ucChar);
@@ -0,0 +1,743 @@
+//*****************************************************************************
+//
+// uformat_core.h - Formatting engine shared by the ustdlib and uartstdio
+//                  printf functions.
+//
+// Copyright (c) 2008-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __UFORMAT_CORE_H__
+#define __UFORMAT_CORE_H__
+
+//*****************************************************************************
+//
+// uvsnprintf() in utils/ustdlib.c and UARTvprintf() in utils/uartstdio.c are
+// thin wrappers around the functions below, which differ only in where the
+// output goes.  The functions are static inline so that neither file needs
+// the other at link time.
+//
+// The engine formats into a buffer described by a tUFormatOut.  When the
+// buffer fills, its flush function is called to empty it; without one, the
+// rest of the output is counted but dropped.  It allocates nothing, and uses
+// a few dozen bytes of stack.
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// With UFORMAT_CORE defined to 1, uvsnprintf() and UARTvprintf() use the
+// engine below.  Define it to 0 for their original, separate format parsers,
+// which find the digits of a value by dividing it by each power of the base
+// in turn.  The pre-parsed formats of UFormatCompile() use the engine either
+// way.
+//
+//*****************************************************************************
+#ifndef UFORMAT_CORE
+#define UFORMAT_CORE            1
+#endif
+
+//*****************************************************************************
+//
+// With UFORMAT_CHECK defined to 1, GCC and compatible compilers check the
+// arguments of every call of the printf functions against its format string,
+// as they do for the C library's printf().  The checks are off by default:
+// where uint32_t is an unsigned long, as with arm-none-eabi-gcc, the %u of a
+// uint32_t, which these functions take, would warn.
+//
+//*****************************************************************************
+#ifndef UFORMAT_CHECK
+#define UFORMAT_CHECK           0
+#endif
+
+#if UFORMAT_CHECK && defined(__GNUC__)
+#define UFORMAT_PRINTF(iFormat, iArgs)                                        \
+                                __attribute__((format(printf, iFormat, iArgs)))
+#else
+#define UFORMAT_PRINTF(iFormat, iArgs)
+#endif
+
+//*****************************************************************************
+//
+// With UFORMAT_INLINE defined to 1, GCC and compatible compilers put a copy of
+// the conversion function in each of its callers, and drop the flush path
+// from the copy of a string buffer, which has no flush function; it is faster,
+// but costs about 3.7 KB of code per file.  By default each file keeps one
+// copy, out of line, and every character it puts goes through the test for a
+// flush function.
+//
+//*****************************************************************************
+#ifndef UFORMAT_INLINE
+#define UFORMAT_INLINE          0
+#endif
+
+#if UFORMAT_INLINE && defined(__GNUC__)
+#define UFORMAT_CONVERT         static inline __attribute__((always_inline))
+#elif defined(__GNUC__)
+#define UFORMAT_CONVERT         static __attribute__((noinline, unused))
+#else
+#define UFORMAT_CONVERT         static inline
+#endif
+
+//*****************************************************************************
+//
+// The number of conversions, plus one for the text after the last of them,
+// that a pre-parsed format can hold.
+//
+//*****************************************************************************
+#ifndef UFORMAT_MAX_STEPS
+#define UFORMAT_MAX_STEPS       16
+#endif
+
+//*****************************************************************************
+//
+// The flag of a conversion padded with zeros instead of spaces.
+//
+//*****************************************************************************
+#define UFORMAT_FLAG_ZERO       0x01
+
+//*****************************************************************************
+//
+// The buffer that the engine formats into.
+//
+//*****************************************************************************
+typedef struct sUFormatOut
+{
+    //
+    // The start of the buffer.
+    //
+    char *pcStart;
+
+    //
+    // The next character of the buffer to write.
+    //
+    char *pcPos;
+
+    //
+    // The end of the buffer.
+    //
+    char *pcEnd;
+
+    //
+    // The number of characters formatted, including any that were dropped.
+    //
+    uint32_t ui32Count;
+
+    //
+    // The function that empties a full buffer and sets pcPos back to
+    // pcStart, or 0 to drop the characters that do not fit.
+    //
+    void (*pfnFlush)(struct sUFormatOut *psOut);
+}
+tUFormatOut;
+
+//*****************************************************************************
+//
+// One step of a pre-parsed format: the literal text before a conversion, and
+// the conversion.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The offset of the literal text in the format string.
+    //
+    uint16_t ui16Offset;
+
+    //
+    // The length of the literal text.
+    //
+    uint16_t ui16Length;
+
+    //
+    // The conversion character, or 0 for the text after the last conversion.
+    //
+    char cConversion;
+
+    //
+    // The flags of the conversion (UFORMAT_FLAG_ZERO).
+    //
+    uint8_t ui8Flags;
+
+    //
+    // The minimum field width of the conversion.
+    //
+    uint16_t ui16Width;
+}
+tUFormatStep;
+
+//*****************************************************************************
+//
+// A format string parsed once by UFormatCompile(), for usnprintfc() and
+// UARTprintfc().  It refers to the format string, which must outlive it.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The format string.
+    //
+    const char *pcFormat;
+
+    //
+    // The number of steps used.
+    //
+    uint32_t ui32Steps;
+
+    //
+    // The steps of the format.
+    //
+    tUFormatStep psSteps[UFORMAT_MAX_STEPS];
+}
+tUFormat;
+
+//*****************************************************************************
+//
+// The two-digit decimal numbers 00 to 99, and the hexadecimal digits.
+//
+//*****************************************************************************
+static const char g_pcUFormatDecimal[200] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char g_pcUFormatHex[16] =
+{
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
+//*****************************************************************************
+//
+// Append characters to the output.
+//
+//*****************************************************************************
+static inline void
+UFormatPut(tUFormatOut *psOut, const char *pcData, uint32_t ui32Len)
+{
+    char *pcPos;
+    uint32_t ui32Room;
+
+    psOut->ui32Count += ui32Len;
+
+    while(ui32Len)
+    {
+        //
+        // Empty a full buffer, or drop the rest.
+        //
+        if(psOut->pcPos == psOut->pcEnd)
+        {
+            if(!psOut->pfnFlush)
+            {
+                return;
+            }
+            psOut->pfnFlush(psOut);
+        }
+
+        //
+        // Copy as much as fits, through a local pointer that the stores
+        // cannot alias.
+        //
+        pcPos = psOut->pcPos;
+        ui32Room = psOut->pcEnd - pcPos;
+        if(ui32Room > ui32Len)
+        {
+            ui32Room = ui32Len;
+        }
+        ui32Len -= ui32Room;
+        while(ui32Room--)
+        {
+            *pcPos++ = *pcData++;
+        }
+        psOut->pcPos = pcPos;
+    }
+}
+
+//*****************************************************************************
+//
+// Append a character to the output a number of times.
+//
+//*****************************************************************************
+static inline void
+UFormatFill(tUFormatOut *psOut, char cFill, uint32_t ui32Len)
+{
+    char *pcPos;
+    uint32_t ui32Room;
+
+    psOut->ui32Count += ui32Len;
+
+    while(ui32Len)
+    {
+        if(psOut->pcPos == psOut->pcEnd)
+        {
+            if(!psOut->pfnFlush)
+            {
+                return;
+            }
+            psOut->pfnFlush(psOut);
+        }
+
+        pcPos = psOut->pcPos;
+        ui32Room = psOut->pcEnd - pcPos;
+        if(ui32Room > ui32Len)
+        {
+            ui32Room = ui32Len;
+        }
+        ui32Len -= ui32Room;
+        while(ui32Room--)
+        {
+            *pcPos++ = cFill;
+        }
+        psOut->pcPos = pcPos;
+    }
+}
+
+//*****************************************************************************
+//
+// Append the literal text at the start of a format string to the output, and
+// return a pointer to the % or the null character that ends it.  The text is
+// copied as it is scanned.
+//
+//*****************************************************************************
+static inline const char *
+UFormatText(tUFormatOut *psOut, const char *pcFormat)
+{
+    const char *pcText = pcFormat;
+    char *pcPos = psOut->pcPos;
+    char cChar;
+
+    while(1)
+    {
+        while((pcPos != psOut->pcEnd) && ((cChar = *pcFormat) != '%') &&
+              (cChar != '\0'))
+        {
+            *pcPos++ = cChar;
+            pcFormat++;
+        }
+
+        //
+        // Stop at the end of the text, or when the buffer is full and cannot
+        // be emptied; otherwise empty it and go on.
+        //
+        if((pcPos != psOut->pcEnd) || !psOut->pfnFlush)
+        {
+            break;
+        }
+        psOut->pcPos = pcPos;
+        psOut->pfnFlush(psOut);
+        pcPos = psOut->pcPos;
+    }
+
+    //
+    // Count any text that did not fit.
+    //
+    while((*pcFormat != '%') && (*pcFormat != '\0'))
+    {
+        pcFormat++;
+    }
+
+    psOut->pcPos = pcPos;
+    psOut->ui32Count += pcFormat - pcText;
+    return(pcFormat);
+}
+
+//*****************************************************************************
+//
+// Write the decimal digits of a value backward from the end of a buffer, two
+// at a time, and return a pointer to the first of them.  The quotient by 100
+// is taken with a multiplication by its reciprocal (2^37 / 100, rounded up),
+// which is exact for every 32-bit value, so that no division instruction is
+// used whatever the compiler's optimization settings.
+//
+//*****************************************************************************
+static inline char *
+UFormatDecimal(char *pcEnd, uint32_t ui32Value)
+{
+    uint32_t ui32Quot, ui32Pair;
+
+    while(ui32Value >= 100)
+    {
+        ui32Quot = (uint32_t)(((uint64_t)ui32Value * 0x51EB851F) >> 37);
+        ui32Pair = (ui32Value - (ui32Quot * 100)) * 2;
+        pcEnd -= 2;
+        pcEnd[0] = g_pcUFormatDecimal[ui32Pair];
+        pcEnd[1] = g_pcUFormatDecimal[ui32Pair + 1];
+        ui32Value = ui32Quot;
+    }
+
+    if(ui32Value >= 10)
+    {
+        pcEnd -= 2;
+        pcEnd[0] = g_pcUFormatDecimal[ui32Value * 2];
+        pcEnd[1] = g_pcUFormatDecimal[(ui32Value * 2) + 1];
+    }
+    else
+    {
+        *--pcEnd = '0' + ui32Value;
+    }
+
+    return(pcEnd);
+}
+
+//*****************************************************************************
+//
+// Write the hexadecimal digits of a value backward from the end of a buffer,
+// and return a pointer to the first of them.
+//
+//*****************************************************************************
+static inline char *
+UFormatHex(char *pcEnd, uint32_t ui32Value)
+{
+    do
+    {
+        *--pcEnd = g_pcUFormatHex[ui32Value & 15];
+        ui32Value >>= 4;
+    }
+    while(ui32Value);
+
+    return(pcEnd);
+}
+
+//*****************************************************************************
+//
+// Parse the flags and the field width of a conversion, which start after its
+// %, and return a pointer to the conversion character.
+//
+//*****************************************************************************
+static inline const char *
+UFormatSpec(const char *pcFormat, uint32_t *pui32Flags, uint32_t *pui32Width)
+{
+    uint32_t ui32Width = 0;
+
+    //
+    // A field width that starts with a zero pads with zeros.
+    //
+    *pui32Flags = (*pcFormat == '0') ? UFORMAT_FLAG_ZERO : 0;
+
+    while((*pcFormat >= '0') && (*pcFormat <= '9'))
+    {
+        ui32Width = (ui32Width * 10) + (*pcFormat++ - '0');
+    }
+
+    *pui32Width = ui32Width;
+    return(pcFormat);
+}
+
+//*****************************************************************************
+//
+// Append one conversion to the output, taking its argument from the list.
+// The conversions and their padding are those of uvsnprintf(): %X uses lower
+// case letters, %s is padded on the right, and an unknown conversion is
+// replaced by ERROR.
+//
+//*****************************************************************************
+UFORMAT_CONVERT void
+UFormatConvert(tUFormatOut *psOut, char cConversion, uint32_t ui32Flags,
+               uint32_t ui32Width, va_list *pvaArg)
+{
+    char pcBuf[12], *pcDigits, *pcEnd = pcBuf + sizeof(pcBuf);
+    const char *pcStr;
+    uint32_t ui32Value, ui32Len;
+    bool bNeg = false;
+
+    switch(cConversion)
+    {
+        case 'c':
+        {
+            pcBuf[0] = (char)va_arg(*pvaArg, int);
+            UFormatPut(psOut, pcBuf, 1);
+            return;
+        }
+
+        case 'd':
+        case 'i':
+        {
+            ui32Value = (uint32_t)va_arg(*pvaArg, int32_t);
+            if((int32_t)ui32Value < 0)
+            {
+                ui32Value = 0 - ui32Value;
+                bNeg = true;
+            }
+            pcDigits = UFormatDecimal(pcEnd, ui32Value);
+            break;
+        }
+
+        case 'u':
+        {
+            pcDigits = UFormatDecimal(pcEnd, va_arg(*pvaArg, uint32_t));
+            break;
+        }
+
+        case 'x':
+        case 'X':
+        {
+            pcDigits = UFormatHex(pcEnd, va_arg(*pvaArg, uint32_t));
+            break;
+        }
+
+        case 'p':
+        {
+            pcDigits = UFormatHex(pcEnd,
+                                  (uint32_t)(uintptr_t)va_arg(*pvaArg,
+                                                              void *));
+            break;
+        }
+
+        case 's':
+        {
+            pcStr = va_arg(*pvaArg, const char *);
+            for(ui32Len = 0; pcStr[ui32Len] != '\0'; ui32Len++)
+            {
+            }
+            UFormatPut(psOut, pcStr, ui32Len);
+            if(ui32Width > ui32Len)
+            {
+                UFormatFill(psOut, ' ', ui32Width - ui32Len);
+            }
+            return;
+        }
+
+        case '%':
+        {
+            UFormatPut(psOut, "%", 1);
+            return;
+        }
+
+        default:
+        {
+            UFormatPut(psOut, "ERROR", 5);
+            return;
+        }
+    }
+
+    //
+    // Pad a number to its field width, with the minus sign before zeros and
+    // after spaces.
+    //
+    ui32Len = (pcEnd - pcDigits) + bNeg;
+    if((ui32Width > ui32Len) && (ui32Width < 65536))
+    {
+        if(ui32Flags & UFORMAT_FLAG_ZERO)
+        {
+            if(bNeg)
+            {
+                UFormatPut(psOut, "-", 1);
+                bNeg = false;
+            }
+            UFormatFill(psOut, '0', ui32Width - ui32Len);
+        }
+        else
+        {
+            UFormatFill(psOut, ' ', ui32Width - ui32Len);
+        }
+    }
+    if(bNeg)
+    {
+        *--pcDigits = '-';
+    }
+    UFormatPut(psOut, pcDigits, pcEnd - pcDigits);
+}
+
+//*****************************************************************************
+//
+// Format a string and its arguments into the output, and return the number
+// of characters formatted.
+//
+//*****************************************************************************
+static inline uint32_t
+UFormatRun(tUFormatOut *psOut, const char *pcFormat, va_list *pvaArg)
+{
+    uint32_t ui32Flags, ui32Width;
+
+    while(1)
+    {
+        pcFormat = UFormatText(psOut, pcFormat);
+        if(*pcFormat == '\0')
+        {
+            break;
+        }
+        pcFormat++;
+
+        //
+        // Most conversions have neither flags nor a field width: a letter
+        // follows the % directly.
+        //
+        if(*pcFormat > '9')
+        {
+            UFormatConvert(psOut, *pcFormat++, 0, 0, pvaArg);
+            continue;
+        }
+
+        pcFormat = UFormatSpec(pcFormat, &ui32Flags, &ui32Width);
+        UFormatConvert(psOut, *pcFormat, ui32Flags, ui32Width, pvaArg);
+
+        //
+        // A % at the end of the string gives ERROR, and ends the string.
+        //
+        if(*pcFormat != '\0')
+        {
+            pcFormat++;
+        }
+    }
+
+    return(psOut->ui32Count);
+}
+
+//*****************************************************************************
+//
+//! Parses a format string once, for usnprintfc() and UARTprintfc().
+//!
+//! \param psFormat points to the pre-parsed format to fill in.
+//! \param pcFormat is the format string, with the conversions of usnprintf().
+//!
+//! This function splits a format string into its literal text and its
+//! conversions, so that a log line printed again and again does not parse its
+//! format every time.  The pre-parsed format refers to the string, which must
+//! outlive it; a string literal does.
+//!
+//! \return Returns \b true, or \b false if the string has an unknown
+//! conversion or more than \b UFORMAT_MAX_STEPS - 1 of them.
+//
+//*****************************************************************************
+static inline bool
+UFormatCompile(tUFormat *psFormat, const char *pcFormat)
+{
+    tUFormatStep *psStep;
+    const char *pcText;
+    uint32_t ui32Flags, ui32Width;
+
+    psFormat->pcFormat = pcFormat;
+    psFormat->ui32Steps = 0;
+
+    while(1)
+    {
+        if(psFormat->ui32Steps == UFORMAT_MAX_STEPS)
+        {
+            return(false);
+        }
+        psStep = &psFormat->psSteps[psFormat->ui32Steps++];
+
+        //
+        // Note the literal text before the next conversion.
+        //
+        for(pcText = pcFormat; (*pcFormat != '%') && (*pcFormat != '\0');
+            pcFormat++)
+        {
+        }
+        if((pcFormat - psFormat->pcFormat) > 65535)
+        {
+            return(false);
+        }
+        psStep->ui16Offset = pcText - psFormat->pcFormat;
+        psStep->ui16Length = pcFormat - pcText;
+        psStep->cConversion = 0;
+        psStep->ui8Flags = 0;
+        psStep->ui16Width = 0;
+        if(*pcFormat == '\0')
+        {
+            return(true);
+        }
+
+        //
+        // Parse the conversion.
+        //
+        pcFormat = UFormatSpec(pcFormat + 1, &ui32Flags, &ui32Width);
+        switch(*pcFormat)
+        {
+            case 'c':
+            case 'd':
+            case 'i':
+            case 'p':
+            case 's':
+            case 'u':
+            case 'x':
+            case 'X':
+            case '%':
+            {
+                break;
+            }
+
+            default:
+            {
+                return(false);
+            }
+        }
+        psStep->cConversion = *pcFormat++;
+        psStep->ui8Flags = ui32Flags;
+        psStep->ui16Width = (ui32Width < 65536) ? ui32Width : 65535;
+    }
+}
+
+//*****************************************************************************
+//
+// Format a pre-parsed format and its arguments into the output, and return
+// the number of characters formatted.
+//
+//*****************************************************************************
+static inline uint32_t
+UFormatRunCompiled(tUFormatOut *psOut, const tUFormat *psFormat,
+                   va_list *pvaArg)
+{
+    const tUFormatStep *psStep = psFormat->psSteps;
+    uint32_t ui32Step;
+
+    for(ui32Step = 0; ui32Step < psFormat->ui32Steps; ui32Step++, psStep++)
+    {
+        if(psStep->ui16Length)
+        {
+            UFormatPut(psOut, psFormat->pcFormat + psStep->ui16Offset,
+                       psStep->ui16Length);
+        }
+        if(psStep->cConversion)
+        {
+            UFormatConvert(psOut, psStep->cConversion, psStep->ui8Flags,
+                           psStep->ui16Width, pvaArg);
+        }
+    }
+
+    return(psOut->ui32Count);
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __UFORMAT_CORE_H__
@@ -33,6 +33,7 @@
 //
 //*****************************************************************************
 
+#if !UFORMAT_CORE
 //*****************************************************************************
 //
 // A mapping from an integer between 0 and 15 to its ASCII character
@@ -40,6 +41,7 @@
 //
 //*****************************************************************************
 static const char * const g_pcHex = "0123456789abcdef";
+#endif
 
 //*****************************************************************************
 //
@@ -149,6 +151,9 @@ ustrncpy(char * restrict s1, const char * restrict s2, size_t n)
 //! the function to return a count that is greater than the specified buffer
 //! size.  If this happens, it means that the output was truncated.
 //!
+//! The formatting is done by the engine in utils/uformat_core.h, which
+//! UARTvprintf() shares, unless \b UFORMAT_CORE is defined to 0.
+//!
 //! \return Returns the number of characters that were to be stored, not
 //! including the NULL termination character, regardless of space in the
 //! buffer.
@@ -158,6 +163,40 @@ int
 uvsnprintf(char * restrict s, size_t n, const char * restrict format,
            va_list arg)
 {
+#if UFORMAT_CORE
+    tUFormatOut sOut;
+    va_list vaArg;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(s);
+    ASSERT(n);
+    ASSERT(format);
+
+    //
+    // Format into the buffer, leaving one space for null termination, and
+    // drop what does not fit.
+    //
+    sOut.pcStart = s;
+    sOut.pcPos = s;
+    sOut.pcEnd = n ? (s + n - 1) : s;
+    sOut.ui32Count = 0;
+    sOut.pfnFlush = 0;
+    va_copy(vaArg, arg);
+    UFormatRun(&sOut, format, &vaArg);
+    va_end(vaArg);
+
+    //
+    // Null terminate the string in the buffer.
+    //
+    *sOut.pcPos = 0;
+
+    //
+    // Return the number of characters in the full converted string.
+    //
+    return(sOut.ui32Count);
+#else
     unsigned long ulIdx, ulValue, ulCount, ulBase, ulNeg;
     char *pcStr, cFill;
     int iConvertCount = 0;
@@ -684,6 +723,63 @@ convert:
     // Return the number of characters in the full converted string.
     //
     return(iConvertCount);
+#endif
+}
+
+//*****************************************************************************
+//
+//! A vsnprintf function for a format string parsed by UFormatCompile().
+//!
+//! \param s points to the buffer where the converted string is stored.
+//! \param n is the size of the buffer.
+//! \param psFormat is the pre-parsed format.
+//! \param arg is the list of optional arguments, which depend on the
+//! contents of the format string.
+//!
+//! This function gives the same result as uvsnprintf() given the format
+//! string of \e psFormat, without parsing the string again.
+//!
+//! \return Returns the number of characters that were to be stored, not
+//! including the NULL termination character, regardless of space in the
+//! buffer.
+//
+//*****************************************************************************
+int
+uvsnprintfc(char * restrict s, size_t n, const tUFormat *psFormat,
+            va_list arg)
+{
+    tUFormatOut sOut;
+    va_list vaArg;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(s);
+    ASSERT(n);
+    ASSERT(psFormat);
+
+    //
+    // Format into the buffer, leaving one space for null termination, and
+    // drop what does not fit.
+    //
+    sOut.pcStart = s;
+    sOut.pcPos = s;
+    sOut.pcEnd = n ? (s + n - 1) : s;
+    sOut.ui32Count = 0;
+    sOut.pfnFlush = 0;
+    va_copy(vaArg, arg);
+    UFormatRunCompiled(&sOut, psFormat, &vaArg);
+    va_end(vaArg);
+
+    //
+    // Null terminate the string in the buffer.
+    //
+    *sOut.pcPos = 0;
+
+    //
+    // Return the number of characters in the full converted string.
+    //
+    return(sOut.ui32Count);
 }
 
 //*****************************************************************************
@@ -832,6 +928,62 @@ usnprintf(char * restrict s, size_t n, const char * restrict format, ...)
     return(ret);
 }
 
+//*****************************************************************************
+//
+//! An snprintf function for a format string parsed by UFormatCompile().
+//!
+//! \param s is the buffer where the converted string is stored.
+//! \param n is the size of the buffer.
+//! \param psFormat is the pre-parsed format.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function gives the same result as usnprintf() given the format string
+//! of \e psFormat, without parsing the string again.  For a log line printed
+//! often:
+//!
+//! \verbatim
+//!     static tUFormat sFormat;
+//!
+//!     if(!sFormat.pcFormat)
+//!     {
+//!         UFormatCompile(&sFormat, "%6u.%03u %s\n");
+//!     }
+//!     usnprintfc(pcBuf, sizeof(pcBuf), &sFormat, ui32Sec, ui32Ms, pcName);
+//! \endverbatim
+//!
+//! \return Returns the number of characters that were to be stored, not
+//! including the NULL termination character, regardless of space in the
+//! buffer.
+//
+//*****************************************************************************
+int
+usnprintfc(char * restrict s, size_t n, const tUFormat *psFormat, ...)
+{
+    va_list arg;
+    int ret;
+
+    //
+    // Start the varargs processing.
+    //
+    va_start(arg, psFormat);
+
+    //
+    // Call vsnprintfc to perform the conversion.
+    //
+    ret = uvsnprintfc(s, n, psFormat, arg);
+
+    //
+    // End the varargs processing.
+    //
+    va_end(arg);
+
+    //
+    // Return the conversion count.
+    //
+    return(ret);
+}
+
 //*****************************************************************************
 //
 // This array contains the number of days in a year at the beginning of each
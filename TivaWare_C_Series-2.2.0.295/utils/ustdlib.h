@@ -32,6 +32,7 @@
 //*****************************************************************************
 #include <stdarg.h>
 #include <time.h>
+#include "utils/uformat_core.h"
 
 //*****************************************************************************
 //
@@ -53,8 +54,11 @@ extern void ulocaltime(time_t timer, struct tm *tm);
 extern time_t umktime(struct tm *timeptr);
 extern int urand(void);
 extern int usnprintf(char * restrict s, size_t n, const char * restrict format,
-                     ...);
-extern int usprintf(char * restrict s, const char * restrict format, ...);
+                     ...) UFORMAT_PRINTF(3, 4);
+extern int usnprintfc(char * restrict s, size_t n, const tUFormat *psFormat,
+                      ...);
+extern int usprintf(char * restrict s, const char * restrict format, ...)
+                    UFORMAT_PRINTF(2, 3);
 extern void usrand(unsigned int seed);
 extern int ustrcasecmp(const char *s1, const char *s2);
 extern int ustrcmp(const char *s1, const char *s2);
@@ -68,7 +72,10 @@ extern float ustrtof(const char * restrict nptr,
 extern unsigned long int ustrtoul(const char * restrict nptr,
                                   const char ** restrict endptr, int base);
 extern int uvsnprintf(char * restrict s, size_t n,
-                      const char * restrict format, va_list arg);
+                      const char * restrict format, va_list arg)
+                      UFORMAT_PRINTF(3, 0);
+extern int uvsnprintfc(char * restrict s, size_t n, const tUFormat *psFormat,
+                       va_list arg);
 
 //*****************************************************************************
 //
@@ -0,0 +1,68 @@
+/*
+ * dma.c: uDMA controller setup shared by the drivers
+ *
+ * ----------------------------
+ *  Created on: Dec 7, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * The uDMA controller has a single channel control table for all channels, so it is set up
+ * once here, from LaunchPadInit(). Drivers then only configure their own channels.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/udma.h>
+#include "launchpad.h"
+
+// Channel control table: primary and alternate structures of the 32 channels. The controller
+// requires it to be aligned to 1024 bytes.
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(dma_control_table, 1024)
+static uint8_t dma_control_table[1024];
+#else
+static uint8_t dma_control_table[1024] __attribute__((aligned(1024)));
+#endif
+
+// Number of uDMA bus errors so far
+static volatile uint32_t dma_error_count = 0;
+
+/*
+ * uDMA error ISR: a transfer hit a bus error; count and clear it
+ */
+static void DmaErrorISR()
+{
+    if (uDMAErrorStatusGet())
+    {
+        uDMAErrorStatusClear();
+        dma_error_count++;
+    }
+}
+
+/*
+ * Enable the uDMA controller with the channel control table
+ */
+void DmaInit()
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_UDMA);
+    uDMAEnable();
+    uDMAControlBaseSet(dma_control_table);
+
+    uDMAIntRegister(INT_UDMAERR, DmaErrorISR);
+}
+
+/*
+ * Return the number of uDMA bus errors so far
+ */
+uint32_t DmaErrorCount()
+{
+    return dma_error_count;
+}
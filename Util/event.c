@@ -39,24 +39,282 @@
  */
 
 #include "event.h"
+#include "launchpad.h"
+#include <inc/hw_memmap.h>
+#include <inc/hw_nvic.h>
+#include <inc/hw_types.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+#if EVENT_PROFILE
+#include <string.h>
+#include <utils/cpu_usage.h>
+#endif
 
 /*************************************************************************************
  * An event-driven scheduling system using sysTime
  ************************************************************************************/
 
+#if EVENT_TICKLESS
+// In tickless mode, Wide Timer 1 is concatenated into a 64-bit up-counter that
+// free-runs at the system clock rate. Its counter supplies the system time, and
+// its match interrupt is used as a one-shot timer for the earliest event.
+#define EVENT_TIMER_PERIPH      SYSCTL_PERIPH_WTIMER1
+#define EVENT_TIMER_BASE        WTIMER1_BASE
+#define EVENT_TIMER_INT         INT_WTIMER1A
+
+// Set while EventExecute() runs; the one-shot timer is re-armed once at its end
+static volatile bool executing = false;
+#else
+// A system time in ticks since the LaunchPad is powered on
+static volatile time_t sys_time = 0;
+#endif
+
+// Number of scheduler interrupts that woke up the CPU
+static volatile uint32_t wakeup_count = 0;
+
+// Index of the highest set bit of a non-zero word
+static inline uint32_t HighestBit(uint32_t x)
+{
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(x);
+#else
+    uint32_t bit = 0;
+    if (x & 0xFFFF0000) { x >>= 16; bit += 16; }
+    if (x & 0xFF00) { x >>= 8; bit += 8; }
+    if (x & 0xF0) { x >>= 4; bit += 4; }
+    if (x & 0xC) { x >>= 2; bit += 2; }
+    if (x & 0x2) bit += 1;
+    return bit;
+#endif
+}
+
+#if EVENT_WHEEL
+/*************************************************************************************
+ * Hierarchical timing wheel
+ *
+ * The wheel has 16 levels of 16 slots, one level per 4-bit digit of the 64-bit
+ * time. An event goes to the level of the highest digit in which its time differs
+ * from the wheel time, in the slot of that digit; so every event of a level is
+ * later than those of the levels below, and the slots of a level are in time
+ * order. Events at or before the wheel time are due, and wait in a FIFO list.
+ * Event.bin holds level * WHEEL_SLOTS + slot, and Event.flags.due marks the due.
+ *
+ * Inserting and cancelling are O(1). Expiring an event moves the wheel time to
+ * it, and cascades the slots that the wheel time reaches into the lower levels;
+ * an event cascades at most once per level, so expiry is amortized O(1).
+ ************************************************************************************/
+
+#define WHEEL_DIGIT_BITS    4
+#define WHEEL_SLOTS         (1 << WHEEL_DIGIT_BITS)
+#define WHEEL_SLOT_MASK     (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS        (64 / WHEEL_DIGIT_BITS)
+
+// Slot lists are doubly linked and NULL-terminated, unsorted
+static Event *wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint16_t wheel_occupied[WHEEL_LEVELS];
+
+// The time of the last expiry
+static time_t wheel_time = 0;
+
+// FIFO list of due events
+static Event *due_head = NULL, *due_tail = NULL;
+
+// The earliest event time. Inserting keeps it exact; taking out the earliest event
+// invalidates it until WheelNextTime() searches again.
+static time_t next_time = MAX_EVENT_TIME;
+static bool next_time_valid = true;
+
+// Index of the lowest set bit of a non-zero word
+static inline uint32_t LowestBit(uint32_t x)
+{
+    return HighestBit(x & -x);
+}
+
+/*
+ * Put a scheduled event in the due list or in its wheel slot
+ */
+static void WheelInsert(Event *ev)
+{
+    if (ev->time <= wheel_time)
+    {
+        ev->next = NULL;
+        ev->prev = due_tail;
+        if (due_tail != NULL)
+            due_tail->next = ev;
+        else
+            due_head = ev;
+        due_tail = ev;
+        ev->flags.due = true;
+        return;
+    }
+
+    time_t diff = ev->time ^ wheel_time;
+    uint32_t high_bit = (diff >> 32) ? 32 + HighestBit(diff >> 32) : HighestBit((uint32_t) diff);
+    uint32_t level = high_bit / WHEEL_DIGIT_BITS;
+    uint32_t slot = (ev->time >> (level * WHEEL_DIGIT_BITS)) & WHEEL_SLOT_MASK;
+    Event **head = &wheel[level][slot];
+
+    ev->prev = NULL;
+    ev->next = *head;
+    if (*head != NULL)
+        (*head)->prev = ev;
+    *head = ev;
+    wheel_occupied[level] |= 1 << slot;
+    ev->bin = level * WHEEL_SLOTS + slot;
+    ev->flags.due = false;
+}
+
+/*
+ * Take a scheduled event out of its list
+ */
+static void WheelRemove(Event *ev)
+{
+    if (ev->time == next_time)
+        next_time_valid = false;
+
+    if (ev->flags.due)
+    {
+        if (ev->prev != NULL)
+            ev->prev->next = ev->next;
+        else
+            due_head = ev->next;
+        if (ev->next != NULL)
+            ev->next->prev = ev->prev;
+        else
+            due_tail = ev->prev;
+        return;
+    }
+
+    uint32_t level = ev->bin / WHEEL_SLOTS, slot = ev->bin % WHEEL_SLOTS;
+    if (ev->prev != NULL)
+        ev->prev->next = ev->next;
+    else
+        wheel[level][slot] = ev->next;
+    if (ev->next != NULL)
+        ev->next->prev = ev->prev;
+    if (wheel[level][slot] == NULL)
+        wheel_occupied[level] &= ~(1 << slot);
+}
+
+/*
+ * Return the earliest event time: that of the due events if any, the slot time of
+ * the first slot of level 0, or else the earliest time in the first slot of the
+ * lowest level with events
+ */
+static time_t WheelNextTime()
+{
+    uint32_t level;
+
+    if (next_time_valid)
+        return next_time;
+
+    next_time = MAX_EVENT_TIME;
+    if (due_head != NULL)
+    {
+        Event *ev;
+        for (ev = due_head; ev != NULL; ev = ev->next)
+            if (ev->time < next_time)
+                next_time = ev->time;
+    }
+    else
+    {
+        for (level = 0; level < WHEEL_LEVELS; level++)
+        {
+            if (wheel_occupied[level] == 0)
+                continue;
+
+            uint32_t slot = LowestBit(wheel_occupied[level]);
+            if (level == 0)
+            {
+                next_time = (wheel_time & ~(time_t) WHEEL_SLOT_MASK) | slot;
+            }
+            else
+            {
+                Event *ev;
+                for (ev = wheel[level][slot]; ev != NULL; ev = ev->next)
+                    if (ev->time < next_time)
+                        next_time = ev->time;
+            }
+            break;
+        }
+    }
+
+    next_time_valid = true;
+    return next_time;
+}
+
+/*
+ * Move the wheel time forward to the earliest event time. The slots it reaches are
+ * emptied first and their events re-inserted, which makes those at the new wheel
+ * time due and moves the others to lower levels. Slot lists have the newest event
+ * first, so they are re-inserted from the tail, to keep events of the same time in
+ * the order they were scheduled.
+ */
+static void WheelAdvance(time_t time)
+{
+    time_t old_time = wheel_time;
+    Event *moved = NULL, *moved_tail = NULL;
+    uint32_t level;
+
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint32_t shift = level * WHEEL_DIGIT_BITS;
+        uint32_t mask = wheel_occupied[level];
+
+        // Once a higher digit changes, the whole level is reached; otherwise the
+        // slots up to the new digit are
+        bool higher_changed = level < WHEEL_LEVELS - 1 &&
+                              (old_time >> (shift + WHEEL_DIGIT_BITS)) != (time >> (shift + WHEEL_DIGIT_BITS));
+        if (!higher_changed)
+            mask &= (2 << ((time >> shift) & WHEEL_SLOT_MASK)) - 1;
+
+        while (mask != 0)
+        {
+            uint32_t slot = LowestBit(mask);
+            Event *ev = wheel[level][slot];
+
+            mask &= ~(1 << slot);
+            while (ev->next != NULL)
+                ev = ev->next;
+            for (; ev != NULL; ev = ev->prev)
+            {
+                ev->next = NULL;
+                if (moved_tail != NULL)
+                    moved_tail->next = ev;
+                else
+                    moved = ev;
+                moved_tail = ev;
+            }
+            wheel[level][slot] = NULL;
+            wheel_occupied[level] &= ~(1 << slot);
+        }
+    }
+
+    wheel_time = time;
+    while (moved != NULL)
+    {
+        Event *ev = moved;
+        moved = ev->next;
+        WheelInsert(ev);
+    }
+}
+
+#else
+/*************************************************************************************
+ * Bins of sorted linked lists, behind a heap of their earliest event times
+ ************************************************************************************/
+
 // Number of bins
 #define BIN_BITSIZE     4
 #define BIN_NUM         (1 << BIN_BITSIZE)
 #define BIN_MASK        (BIN_NUM - 1)
 
-// A system time in milliseconds since the LaunchPad is powered on
-static volatile time_t sys_time = 0;
-
-// The data type for the head event of each bin. The sequence of those three fields must be consistent
-// with that of Event type.
+// The data type for the head event of each bin: the sentinel of its circular list, with the
+// time MAX_EVENT_TIME, and the bin's position in the heap. The sentinel is a real Event, so the
+// list walks never access a HeadEvent through an Event pointer (which the compiler may assume
+// cannot happen, and did at -O2).
 struct HeadEvent {
-    Event *prev, *next;
-    time_t time;
+    Event list;
     uint8_t heap_position;
 };
 
@@ -68,7 +326,7 @@ static uint8_t current_bin_selection = 0;
 static uint8_t bin_head_heap[BIN_NUM];
 
 // Bin head time is defined as the earliest event time for all events in a bin
-#define BIN_HEAD_TIME(i) (bin_head[bin_head_heap[(i)]].next->time)
+#define BIN_HEAD_TIME(i) (bin_head[bin_head_heap[(i)]].list.next->time)
 
 /*
  * Heapify the bin head heap downwards
@@ -77,8 +335,8 @@ void HeapifyDownwards(uint8_t i)
 {
     while (i < BIN_NUM)
     {
-        // Check on the left child
-        int left = (i << 1);
+        // Check on the left child; the root is at index 0
+        int left = (i << 1) + 1;
         if (left >= BIN_NUM)
             return;
 
@@ -112,7 +370,7 @@ void HeapifyUpwards(uint8_t i)
 {
     while (i > 0)
     {
-        int parent = (i >> 1);
+        int parent = (i - 1) >> 1;
         if (BIN_HEAD_TIME(i) < BIN_HEAD_TIME(parent))
         {
             // Swap the parent and the child
@@ -126,45 +384,447 @@ void HeapifyUpwards(uint8_t i)
     }
 }
 
-// System tick interrupt handler, for maintaining system time in microseconds
-// FIXME The system can be made more efficient if the CPU sleeps until the next
-// event arrives. Right now the system wakes up every 1 millisecond.
+/*
+ * Restore the heap order after the earliest event time of a bin changed
+ */
+static void BinHeadTimeChanged(HeadEvent *head, time_t old_bin_head_time)
+{
+    if (head->list.next->time < old_bin_head_time)
+        HeapifyUpwards(head->heap_position);
+    else if (head->list.next->time > old_bin_head_time)
+        HeapifyDownwards(head->heap_position);
+}
+#endif
+
+/*************************************************************************************
+ * Post queues from the ISRs to the scheduler
+ ************************************************************************************/
+
+// One queue per interrupt priority level; the TM4C123 implements the top 3 bits
+// of the priority. ISRs of one level never preempt each other, so each queue has
+// one producer at a time (the running ISR of its level) and one consumer
+// (EventExecute() in thread context), and needs no lock or interrupt masking.
+#define POST_LEVELS         8
+#define POST_LEVEL_SHIFT    5
+
+// Posts that each level can hold between two EventExecute() runs; a power of two
+#define POST_QUEUE_SIZE     8
+
+typedef struct
+{
+    struct
+    {
+        Event *ev;
+        time_t time;
+    } volatile entry[POST_QUEUE_SIZE];
+    volatile uint8_t head;              // posts so far, written by the ISRs only
+    volatile uint8_t tail;              // posts taken, written by EventExecute() only
+    volatile uint32_t dropped;          // posts to a full queue, written by the ISRs only
+} PostQueue;
+
+static PostQueue post_queue[POST_LEVELS];
+
+/*
+ * Schedule the events posted by the ISRs, in the order of their posting per level
+ */
+static void PostQueueDrain()
+{
+    int level;
+
+    for (level = 0; level < POST_LEVELS; level++)
+    {
+        PostQueue *queue = &post_queue[level];
+        uint8_t tail = queue->tail;
+
+        while (tail != queue->head)
+        {
+            Event *ev = queue->entry[tail % POST_QUEUE_SIZE].ev;
+            time_t time = queue->entry[tail % POST_QUEUE_SIZE].time;
+
+            // Give the entry back before scheduling, which may take a while
+            queue->tail = ++tail;
+            EventSchedule(ev, time);
+        }
+    }
+}
+
+/*************************************************************************************
+ * Ready lists: the events whose time has come, one list per priority class
+ ************************************************************************************/
+
+// Doubly linked and NULL-terminated, in the order of the deadlines; the events
+// of one deadline, or with none, in the order they became ready
+static Event *ready_head[EVENT_PRIORITIES], *ready_tail[EVENT_PRIORITIES];
+
+// The absolute deadline of an event, MAX_EVENT_TIME for none
+static inline time_t Deadline(Event *ev)
+{
+    return ev->deadline != 0 ? ev->time + ev->deadline : MAX_EVENT_TIME;
+}
+
+static void ReadyInsert(Event *ev)
+{
+    Event *prev = ready_tail[ev->priority], *next = NULL;
+    time_t deadline = Deadline(ev);
+
+    // Search from the tail, where most events go: those without a deadline
+    while (prev != NULL && Deadline(prev) > deadline)
+    {
+        next = prev;
+        prev = prev->prev;
+    }
+
+    ev->prev = prev;
+    ev->next = next;
+    if (prev != NULL)
+        prev->next = ev;
+    else
+        ready_head[ev->priority] = ev;
+    if (next != NULL)
+        next->prev = ev;
+    else
+        ready_tail[ev->priority] = ev;
+    ev->flags.ready = true;
+}
+
+static void ReadyRemove(Event *ev)
+{
+    if (ev->prev != NULL)
+        ev->prev->next = ev->next;
+    else
+        ready_head[ev->priority] = ev->next;
+    if (ev->next != NULL)
+        ev->next->prev = ev->prev;
+    else
+        ready_tail[ev->priority] = ev->prev;
+    ev->flags.ready = false;
+}
+
+/*
+ * Take out the first ready event of the highest class, NULL if none
+ */
+static Event *ReadyTake()
+{
+    int priority;
+
+    for (priority = 0; priority < EVENT_PRIORITIES; priority++)
+    {
+        Event *ev = ready_head[priority];
+        if (ev != NULL)
+        {
+            ReadyRemove(ev);
+            return ev;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Take the earliest event out of the scheduler if its time has come, NULL if not
+ */
+static Event *TakeExpired(time_t now)
+{
+    Event *ev;
+
+#if EVENT_WHEEL
+    // Once the due events run out, move the wheel to the next event time, if ready
+    if (due_head == NULL)
+    {
+        time_t time = WheelNextTime();
+        if (time > now)
+            return NULL;
+        WheelAdvance(time);
+    }
+
+    ev = due_head;
+    WheelRemove(ev);
+#else
+    // If the first event of the root bin is not yet ready, there is none
+    ev = bin_head[bin_head_heap[0]].list.next;
+    if (ev->time > now)
+        return NULL;
+
+    // Remove the event from the linked list
+    ev->prev->next = ev->next;
+    ev->next->prev = ev->prev;
+
+    // Heapify the bin heap because the bin head time may have changed
+    HeapifyDownwards(bin_head[ev->bin].heap_position);
+#endif
+
+    return ev;
+}
+
+#if EVENT_PROFILE
+/*************************************************************************************
+ * Profiling
+ ************************************************************************************/
+
+// Timer 3 counts down the CPU cycles outside wfi; see CPUUsageInit() in
+// utils/cpu_usage.c. That turns on peripheral clock gating, so every other
+// peripheral in use is enabled in sleep mode as well (SysCtlPeripheralSleepEnable).
+#define PROFILE_TIMER           3
+#define PROFILE_TIMER_BASE      TIMER3_BASE
+
+// Time between two parts of EventProfileDump(); a line drains from the UART in 7 ms
+#define PROFILE_DUMP_INTERVAL   MS_TO_TICKS(20)
+
+// The longest line uprintf() sends, with its line end
+#define PROFILE_LINE_SIZE       80
+
+// The profiles, in the order they were set
+static EventProfile *profile_list = NULL;
+
+// CPU cycles outside wfi since EventSchedulerInit(). CPUUsageTick() would need a
+// call at a fixed rate, and its 32-bit product overflows beyond 671,088 busy cycles
+// per period, so the timer is read on every EventExecute() pass instead.
+static uint64_t busy_cycles = 0;
+static uint32_t busy_timer_last = 0xFFFFFFFF;
+static time_t profile_start = 0;
+
+// The dump under way: the internal event that sends it, and the next profile
+static Event dump_event;
+static EventProfile *dump_next;
+static bool dump_header;
+
+static void StatsReset(EventStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->min = UINT32_MAX;
+}
+
+static void StatsRecord(EventStats *stats, uint32_t value)
+{
+    uint32_t bin = value == 0 ? 0 : HighestBit(value) + 1;
+
+    stats->count[bin < EVENT_HISTOGRAM_BINS ? bin : EVENT_HISTOGRAM_BINS - 1]++;
+    if (value < stats->min)
+        stats->min = value;
+    if (value > stats->max)
+        stats->max = value;
+    stats->sum += value;
+}
+
+/*
+ * Count a dispatch of a profiled event that came the given ticks after its time
+ */
+static void ProfileDispatch(Event *ev, time_t late)
+{
+    EventProfile *profile = ev->profile;
+    uint32_t ticks = late > UINT32_MAX ? UINT32_MAX : (uint32_t) late;
+
+    profile->runs++;
+    StatsRecord(&profile->lateness, ticks);
+    if (ev->deadline != 0 && ticks > ev->deadline)
+        profile->missed++;
+}
+
+/*
+ * Add the busy cycles counted by the timer since the last read
+ */
+static void ProfileCpuSample()
+{
+    uint32_t value = TimerValueGet(PROFILE_TIMER_BASE, TIMER_A);
+
+    busy_cycles += busy_timer_last - value;
+    busy_timer_last = value;
+}
+
+// Microseconds in tenths, for printing as "%u.%u"
+#define TENTHS_OF_US(ticks)     ((uint32_t) ((ticks) * 10 / EVENT_TICKS_PER_US))
+
+// Print a histogram on one line, as the upper bound of each non-empty bin, in cycles, and its
+// count; the bins that do not fit in the line are left out
+static void ProfileHistogram(const char *label, const EventStats *stats)
+{
+    char line[PROFILE_LINE_SIZE + 1];
+    int length, bin;
+
+    length = snprintf(line, sizeof(line), "  %-8s", label);
+    for (bin = 0; bin < EVENT_HISTOGRAM_BINS; bin++)
+    {
+        int n;
+
+        if (stats->count[bin] == 0)
+            continue;
+        if (bin == 0)
+            n = snprintf(line + length, sizeof(line) - length, " 0:%u", stats->count[bin]);
+        else if (bin < EVENT_HISTOGRAM_BINS - 1)
+            n = snprintf(line + length, sizeof(line) - length, " <%u:%u", 1u << bin, stats->count[bin]);
+        else
+            n = snprintf(line + length, sizeof(line) - length, " more:%u", stats->count[bin]);
+        if (length + n > PROFILE_LINE_SIZE - 2)
+        {
+            line[length] = '\0';
+            break;
+        }
+        length += n;
+    }
+
+    uprintf("%s\n\r", line);
+}
+
+/*
+ * Send one part of the dump: the header, then a profile with its histograms, then
+ * the CPU time
+ */
+static void ProfileDumpNext(Event *ev)
+{
+    if (dump_header)
+    {
+        uprintf("Event profiles, in us; histograms in CPU cycles\n\r");
+        uprintf("%-8s %6s %8s %8s %8s %8s %8s %8s %6s\n\r", "event", "runs", "late min", "mean", "max",
+                "run min", "mean", "max", "missed");
+        dump_header = false;
+    }
+    else if (dump_next != NULL)
+    {
+        EventProfile *profile = dump_next;
+        uint32_t runs = profile->runs != 0 ? profile->runs : 1;
+        uint32_t figures[6] = {
+            TENTHS_OF_US(profile->runs != 0 ? profile->lateness.min : 0),
+            TENTHS_OF_US(profile->lateness.sum / runs),
+            TENTHS_OF_US(profile->lateness.max),
+            TENTHS_OF_US(profile->runs != 0 ? profile->duration.min : 0),
+            TENTHS_OF_US(profile->duration.sum / runs),
+            TENTHS_OF_US(profile->duration.max),
+        };
+
+        uprintf("%-8s %6u %6u.%u %6u.%u %6u.%u %6u.%u %6u.%u %6u.%u %6u\n\r", profile->name, profile->runs,
+                figures[0] / 10, figures[0] % 10, figures[1] / 10, figures[1] % 10, figures[2] / 10,
+                figures[2] % 10, figures[3] / 10, figures[3] % 10, figures[4] / 10, figures[4] % 10,
+                figures[5] / 10, figures[5] % 10, profile->missed);
+        ProfileHistogram("late", &profile->lateness);
+        ProfileHistogram("run", &profile->duration);
+        dump_next = profile->next;
+    }
+    else
+    {
+        time_t elapsed = EventGetCurrentTime() - profile_start;
+        uint32_t busy, seconds;
+
+        ProfileCpuSample();
+        busy = elapsed != 0 ? (uint32_t) (busy_cycles * 10000 / elapsed) : 0;
+        seconds = (uint32_t) (elapsed * 10 / EVENT_TICK_RATE);
+        uprintf("CPU busy %u.%02u%%, idle in wfi %u.%02u%%, over %u.%u s\n\r", busy / 100, busy % 100,
+                (10000 - busy) / 100, (10000 - busy) % 100, seconds / 10, seconds % 10);
+        return;
+    }
+
+    EventSchedule(ev, ev->time + PROFILE_DUMP_INTERVAL);
+}
+#endif
+
+/*
+ * Return the time of the earliest scheduled event, MAX_EVENT_TIME if none
+ */
+static time_t NextEventTime()
+{
+#if EVENT_WHEEL
+    return WheelNextTime();
+#else
+    return BIN_HEAD_TIME(0);
+#endif
+}
+
+#if EVENT_TICKLESS
+// Event timer interrupt handler. It does nothing but clear the match flag: waking
+// the CPU from wfi is enough for the main loop to call EventExecute().
+static void
+EventTimerIntHandler()
+{
+    TimerIntClear(EVENT_TIMER_BASE, TIMER_TIMA_MATCH);
+    wakeup_count++;
+}
+
+/*
+ * Program the one-shot timer to the earliest deadline
+ */
+static void EventTimerArm()
+{
+    time_t next_time = NextEventTime();
+
+    // Nothing is scheduled, no need to wake up
+    if (next_time == MAX_EVENT_TIME)
+    {
+        TimerIntDisable(EVENT_TIMER_BASE, TIMER_TIMA_MATCH);
+        return;
+    }
+
+    TimerMatchSet64(EVENT_TIMER_BASE, next_time);
+    TimerIntEnable(EVENT_TIMER_BASE, TIMER_TIMA_MATCH);
+
+    // The match interrupt only fires when the counter passes the match value,
+    // so raise it by software if the deadline is already due
+    if (TimerValueGet64(EVENT_TIMER_BASE) >= next_time)
+        IntPendSet(EVENT_TIMER_INT);
+}
+#else
+// System tick interrupt handler, for maintaining system time in ticks.
+// The CPU wakes up every 1 millisecond; see EVENT_TICKLESS for the alternative.
 static void
 SysTickIntHandler()
 {
-    sys_time++;
+    sys_time += EVENT_TICKS_PER_MS;
+    wakeup_count++;
 }
+#endif
 
 /*
  * Initialize the event scheduler
  */
 void EventSchedulerInit()
 {
+#if EVENT_WHEEL
+    // The wheel starts empty at time 0; see the static initializers
+#else
     uint8_t i;
 
     // Initialize bin_head and bin_head_heap
     for (i = 0; i < BIN_NUM; i++)
     {
         HeadEvent *head = &bin_head[i];
-        head->prev = (Event *)head;
-        head->next = (Event *)head;
-        head->time = MAX_EVENT_TIME;
+        head->list.prev = &head->list;
+        head->list.next = &head->list;
+        head->list.time = MAX_EVENT_TIME;
 
         bin_head_heap[i] = i;
         head->heap_position = i;
     }
+#endif
 
-    /// Get the system running clock
+    /// Get the system running clock, which is also the event tick rate
     uint32_t clock_rate = SysCtlClockGet();
+    assert(clock_rate == EVENT_TICK_RATE);
 
+#if EVENT_TICKLESS
+    // Configure Wide Timer 1 as a 64-bit free-running up-counter. The periodic
+    // mode also sets the TAMIE bit, so that the match interrupt can be used; it
+    // is only unmasked once an event is scheduled.
+    SysCtlPeripheralEnable(EVENT_TIMER_PERIPH);
+    SysCtlPeripheralSleepEnable(EVENT_TIMER_PERIPH);
+    TimerConfigure(EVENT_TIMER_BASE, TIMER_CFG_PERIODIC_UP);
+    TimerLoadSet64(EVENT_TIMER_BASE, 0xFFFFFFFFFFFFFFFFULL);
+    TimerIntRegister(EVENT_TIMER_BASE, TIMER_A, EventTimerIntHandler);
+    TimerEnable(EVENT_TIMER_BASE, TIMER_A);
+#else
     // Configure and enable System Tick for 1 millisecond period,
     // and register an interrupt handler to maintain system time.
-    // FIXME The overhead of 1ms interrupt can be high for some application.
-    // It is desirable to make the period configurable.
     SysTickPeriodSet(clock_rate / 1000 - 1);
     SysTickIntRegister(SysTickIntHandler);
     SysTickIntEnable();
     SysTickEnable();
+#endif
+
+#if EVENT_PROFILE
+    // Count the CPU cycles outside wfi from here on; CPUUsageTick() is not used, see
+    // busy_cycles
+    CPUUsageInit(clock_rate, 1, PROFILE_TIMER);
+    busy_timer_last = 0xFFFFFFFF;
+    busy_cycles = 0;
+    profile_start = EventGetCurrentTime();
+#endif
 }
 
 /*
@@ -172,38 +832,130 @@ void EventSchedulerInit()
  */
 void EventInit(Event *ev, Callback callback)
 {
-    // Set callback function and map the event to an event bin
     ev->callback = callback;
-    ev->bin = current_bin_selection;
     ev->time = MAX_EVENT_TIME;
     ev->flags.initialized = true;
     ev->flags.scheduled = false;
+    ev->flags.due = false;
+    ev->flags.ready = false;
+    ev->priority = EVENT_PRIORITY_NORMAL;
+    ev->deadline = 0;
+    ev->profile = NULL;
+    ev->period = NULL;
+    ev->flags.periodic = false;
+
+#if !EVENT_WHEEL
+    // Map the event to an event bin
+    ev->bin = current_bin_selection;
     current_bin_selection = (current_bin_selection + 1) % BIN_NUM;
+#endif
 }
 
 /*
- * Schedule an event at a given time
+ * Set the priority class of an event, and its deadline in ticks after the event
+ * time, 0 for none
  */
-void EventSchedule(Event *ev, time_t time)
+void EventSetPriority(Event *ev, EventPriority priority, uint32_t deadline)
 {
-    assert(ev->flags.initialized == true);
+    assert(ev->flags.initialized == true && !ev->flags.ready);
+    ev->priority = priority;
+    ev->deadline = deadline;
+}
 
+/*
+ * Collect the figures of an event's dispatches in a profile, under the given name;
+ * NULL stops it. The profile starts over, and is listed by EventProfileDump().
+ */
+void EventSetProfile(Event *ev, EventProfile *profile, const char *name)
+{
+#if EVENT_PROFILE
+    if (profile != NULL)
+    {
+        EventProfile **link = &profile_list;
+
+        profile->name = name;
+        profile->runs = 0;
+        profile->missed = 0;
+        StatsReset(&profile->lateness);
+        StatsReset(&profile->duration);
+
+        while (*link != NULL && *link != profile)
+            link = &(*link)->next;
+        if (*link == NULL)
+        {
+            profile->next = NULL;
+            *link = profile;
+        }
+    }
+
+    ev->profile = profile;
+#endif
+}
+
+/*
+ * Start sending the profiles and the CPU time on UART0. The lines go out from a
+ * low-priority event, a few at a time, so that they never fill the UART buffer,
+ * and nothing waits for them.
+ */
+void EventProfileDump()
+{
+#if EVENT_PROFILE
+    if (!EventInitialized(&dump_event))
+    {
+        EventInit(&dump_event, ProfileDumpNext);
+        EventSetPriority(&dump_event, EVENT_PRIORITY_LOW, 0);
+    }
+
+    // One dump at a time
+    if (dump_event.flags.scheduled)
+        return;
+
+    dump_header = true;
+    dump_next = profile_list;
+    EventSchedule(&dump_event, EventGetCurrentTime());
+#endif
+}
+
+/*
+ * Schedule an event at a given time, whether it is scheduled already or not
+ */
+static void Schedule(Event *ev, time_t time)
+{
+
+#if EVENT_WHEEL
+    // A scheduled event is moved: take it out first
+    if (ev->flags.ready)
+        ReadyRemove(ev);
+    else if (ev->flags.scheduled)
+        WheelRemove(ev);
+
+    ev->time = time;
+    ev->flags.scheduled = true;
+    WheelInsert(ev);
+    if (time < next_time)
+        next_time = time;
+#else
     HeadEvent *head = &bin_head[ev->bin];
-    time_t old_bin_head_time = head->next->time;
-    Event *ev2 = head->next;
+    time_t old_bin_head_time = head->list.next->time;
 
     // Double check the event is not scheduled; if it is, remove
     // it from the linked list (it will be re-inserted)
-    if (ev->flags.scheduled)
+    if (ev->flags.ready)
+    {
+        ReadyRemove(ev);
+    }
+    else if (ev->flags.scheduled)
     {
         ev->prev->next = ev->next;
         ev->next->prev = ev->prev;
     }
 
-    // Search for the insert position of the event in the linked list
-    while (ev2 != (Event *) head)
+    // Search for the insert position of the event in the linked list,
+    // after the events of the same time
+    Event *ev2 = head->list.next;
+    while (ev2 != &head->list)
     {
-        if (ev2->time > ev->time)
+        if (ev2->time > time)
             break;
         ev2 = ev2->next;
     }
@@ -218,21 +970,136 @@ void EventSchedule(Event *ev, time_t time)
 
     // The bin head time may decrease for a new event, or increase for
     // a re-scheduled event, so heapify may be needed
-    if (head->next->time < old_bin_head_time)
-        HeapifyUpwards(head->heap_position);
-    else if (head->next->time > old_bin_head_time)
-        HeapifyDownwards(head->heap_position);
+    BinHeadTimeChanged(head, old_bin_head_time);
+#endif
+
+#if EVENT_TICKLESS
+    // The earliest deadline may have changed; EventExecute() re-arms on exit
+    if (!executing)
+        EventTimerArm();
+#endif
+}
+
+/*
+ * Schedule an event at a given time. A periodic event becomes a one-shot event.
+ */
+void EventSchedule(Event *ev, time_t time)
+{
+    assert(ev->flags.initialized == true);
+
+    ev->flags.periodic = false;
+    Schedule(ev, time);
+}
+
+/*
+ * The time of the occurrence after the current one of a period, leaving the
+ * period as it is
+ */
+static inline time_t PeriodNextTime(const EventPeriod *period)
+{
+    return period->time + period->ticks + (period->phase + period->remainder >= period->divisor);
 }
 
 /*
- * De-schedule a scheduled event
+ * Schedule the next occurrence of a periodic event that has run. With the SKIP
+ * policy, the occurrences already past are dropped one by one, so a long stall
+ * with a short period takes a while here; BURST schedules the missed ones.
+ */
+static void PeriodicReschedule(Event *ev)
+{
+    EventPeriod *period = ev->period;
+
+    if (period->overrun == EVENT_OVERRUN_SKIP)
+    {
+        time_t now = EventGetCurrentTime();
+
+        while (PeriodNextTime(period) < now)
+        {
+            EventPeriodAdvance(period);
+            period->skipped++;
+        }
+    }
+
+    Schedule(ev, PeriodNextTime(period));
+}
+
+/*
+ * Give an event its period: ticks + remainder / divisor ticks, with remainder
+ * below divisor, and what to do on an overrun. The period is kept in the given
+ * structure. On a periodic event that has run, the new period counts from its
+ * current occurrence, and the occurrence scheduled next moves to match.
+ */
+void EventSetPeriod(Event *ev, EventPeriod *period, uint32_t ticks, uint32_t remainder, uint32_t divisor,
+                    EventOverrun overrun)
+{
+    assert(ev->flags.initialized == true && ticks > 0 && remainder < divisor);
+
+    if (ev->period != period)
+    {
+        ev->period = period;
+        ev->flags.periodic = false;
+        period->skipped = 0;
+    }
+    period->ticks = ticks;
+    period->remainder = remainder;
+    period->divisor = divisor;
+    period->phase = 0;
+    period->overrun = overrun;
+
+    // Waiting for an occurrence after the current one, rather than for the anchor
+    if (ev->flags.periodic && ev->flags.scheduled && ev->time != period->time)
+        PeriodicReschedule(ev);
+}
+
+/*
+ * Start a periodic event: its first occurrence is at the anchor time, and every
+ * later one a whole number of periods after it. With the SKIP policy, an anchor
+ * in the past starts the event at the first occurrence still ahead.
+ */
+void EventSchedulePeriodic(Event *ev, time_t anchor)
+{
+    EventPeriod *period = ev->period;
+
+    assert(ev->flags.initialized == true && period != NULL);
+
+    period->time = anchor;
+    period->phase = 0;
+    period->skipped = 0;
+    ev->flags.periodic = true;
+
+    if (period->overrun == EVENT_OVERRUN_SKIP && anchor < EventGetCurrentTime())
+        PeriodicReschedule(ev);
+    else
+        Schedule(ev, anchor);
+}
+
+/*
+ * De-schedule a scheduled event. A periodic event stops, also from its own
+ * callback, where it is not scheduled.
  */
 void EventDeschedule(Event *ev)
 {
+    assert(ev->flags.scheduled || ev->flags.periodic);
+
+    ev->flags.periodic = false;
+    if (!ev->flags.scheduled)
+        return;
+
+    // An event whose time has come waits in its ready list
+    if (ev->flags.ready)
+    {
+        ReadyRemove(ev);
+        ev->flags.scheduled = false;
+        return;
+    }
+
+#if EVENT_WHEEL
+    WheelRemove(ev);
+    ev->flags.scheduled = false;
+#else
     // Get the current bin head and bin head time
-    assert(ev->flags.scheduled);
     HeadEvent *head = &bin_head[ev->bin];
-    time_t old_bin_head_time = head->next->time;
+    time_t old_bin_head_time = head->list.next->time;
 
     // Remove the event from the linked list
     ev->prev->next = ev->next;
@@ -240,8 +1107,49 @@ void EventDeschedule(Event *ev)
     ev->flags.scheduled = false;
 
     // The bin's earliest event time may increase, if so, heapfiy downwards
-    if (head->next->time > old_bin_head_time)
-        HeapifyDownwards(ev->bin);
+    BinHeadTimeChanged(head, old_bin_head_time);
+#endif
+
+#if EVENT_TICKLESS
+    if (!executing)
+        EventTimerArm();
+#endif
+}
+
+/*
+ * Schedule an event from an ISR: queue it for the next EventExecute(), in
+ * constant time. The ISR that returns wakes the main loop from wfi, which
+ * then runs EventExecute(); a post that comes after EventExecute() took in
+ * the queues keeps EventSleep() from sleeping. A post to a full queue is
+ * dropped and counted. In thread context this is EventSchedule().
+ */
+void EventPost(Event *ev, time_t time)
+{
+    uint32_t active = HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M;
+
+    assert(ev->flags.initialized == true);
+
+    if (active == 0)
+    {
+        EventSchedule(ev, time);
+        return;
+    }
+
+    // NMI and hard fault have fixed priorities above every level
+    assert(active >= FAULT_MPU);
+    PostQueue *queue = &post_queue[IntPriorityGet(active) >> POST_LEVEL_SHIFT];
+    uint8_t head = queue->head;
+
+    if ((uint8_t) (head - queue->tail) == POST_QUEUE_SIZE)
+    {
+        queue->dropped++;
+        return;
+    }
+
+    // Fill in the entry before publishing it with the new head
+    queue->entry[head % POST_QUEUE_SIZE].ev = ev;
+    queue->entry[head % POST_QUEUE_SIZE].time = time;
+    queue->head = head + 1;
 }
 
 /*
@@ -249,30 +1157,119 @@ void EventDeschedule(Event *ev)
  */
 void EventExecute()
 {
+#if EVENT_TICKLESS
+    executing = true;
+#endif
+
     while (true)
     {
-        // If the first event of the root bin is not yet ready, exit loop
-        Event *ev = bin_head[bin_head_heap[0]].next;
-        if (ev->time > sys_time)
-            break;
+        Event *ev;
+        time_t now = EventGetCurrentTime();
+#if EVENT_PROFILE
+        uint32_t now_cycles = CycleCounterGet();
+        ProfileCpuSample();
+#endif
 
-        // Remove the event from the linked list and update its state
-        ev->prev->next = ev->next;
-        ev->next->prev = ev->prev;
+        // Take in what the ISRs posted, also while the callbacks run
+        PostQueueDrain();
+
+        // Move every event whose time has come to its ready list, and run the
+        // first of the highest class
+        while ((ev = TakeExpired(now)) != NULL)
+            ReadyInsert(ev);
+        ev = ReadyTake();
+        if (ev == NULL)
+            break;
         ev->flags.scheduled = false;
 
-        // Heapify the bin heap because the bin head time may have changed
-        HeapifyDownwards(0);
+        // A periodic event's current occurrence becomes the one running
+        if (ev->flags.periodic && ev->time != ev->period->time)
+            EventPeriodAdvance(ev->period);
 
         // Call the callback function
+        TRACE2(TRACE_EVENT_DISPATCH, (uint32_t) (uintptr_t) ev->callback, (uint32_t) (now - ev->time));
+#if EVENT_PROFILE
+        // The lateness counts up to this dispatch, from the cycles since 'now' was read
+        EventProfile *profile = ev->profile;
+        uint32_t start = CycleCounterGet();
+        if (profile != NULL)
+            ProfileDispatch(ev, now - ev->time + (start - now_cycles));
         ev->callback(ev);
+        if (profile != NULL)
+            StatsRecord(&profile->duration, CycleCounterGet() - start);
+#else
+        ev->callback(ev);
+#endif
+
+        // Unless its callback scheduled or stopped it, a periodic event runs again
+        if (ev->flags.periodic && !ev->flags.scheduled)
+            PeriodicReschedule(ev);
     }
+
+#if EVENT_TICKLESS
+    // Sleep until the earliest remaining deadline
+    executing = false;
+    EventTimerArm();
+#endif
+}
+
+/*
+ * Sleep until an interrupt, unless there is work already: an event that an
+ * ISR posted since EventExecute() last took in the queues, or one that came
+ * due meanwhile, whose timer interrupt may have run before the sleep. Either
+ * would otherwise wait for some unrelated interrupt. The interrupts are masked
+ * from the check to the wfi, which a pending interrupt still ends, so no post
+ * can slip in between; the ISR runs once they are unmasked.
+ */
+void EventSleep()
+{
+    uint32_t masked = CPUcpsid();
+    bool work = NextEventTime() <= EventGetCurrentTime();
+    int level;
+
+    for (level = 0; level < POST_LEVELS; level++)
+        work |= post_queue[level].head != post_queue[level].tail;
+
+    if (!work)
+        CPUwfi();
+
+    if (!masked)
+        CPUcpsie();
 }
 
 time_t EventGetCurrentTime()
 {
-    return sys_time;
+#if EVENT_TICKLESS
+    return TimerValueGet64(EVENT_TIMER_BASE);
+#else
+    // A 64-bit read is not atomic; retry if SysTick updated it in between
+    time_t time;
+    do
+    {
+        time = sys_time;
+    } while (time != sys_time);
+    return time;
+#endif
 }
 
+/*
+ * Return the number of times the scheduler interrupt has woken up the CPU
+ */
+uint32_t EventGetWakeupCount()
+{
+    return wakeup_count;
+}
 
+/*
+ * Return the number of posts dropped because their queue was full
+ */
+uint32_t EventPostDroppedCount()
+{
+    uint32_t count = 0;
+    int level;
 
+    for (level = 0; level < POST_LEVELS; level++)
+        count += post_queue[level].dropped;
+
+    return count;
+}
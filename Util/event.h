@@ -50,14 +50,100 @@
 #include <driverlib/systick.h>
 #include <driverlib/sysctl.h>
 
-// Use 32-bit time in the current implementation
-typedef uint32_t time_t;
-#define MAX_EVENT_TIME      0xFFFFFFFF
+// Use 64-bit time, counted in ticks of the system clock. A tick is 20 ns at
+// 50 MHz, and the counter does not wrap during the lifetime of the system.
+typedef uint64_t time_t;
+#define MAX_EVENT_TIME      0xFFFFFFFFFFFFFFFFULL
 #define IMMEDIATE           0x00000000
 
+// Event tick rate and conversions from milliseconds and microseconds
+#define EVENT_TICK_RATE     50000000ULL
+#define EVENT_TICKS_PER_MS  (EVENT_TICK_RATE / 1000)
+#define EVENT_TICKS_PER_US  (EVENT_TICK_RATE / 1000000)
+#define MS_TO_TICKS(ms)     ((time_t)(ms) * EVENT_TICKS_PER_MS)
+#define US_TO_TICKS(us)     ((time_t)(us) * EVENT_TICKS_PER_US)
+
+// In tickless mode the scheduler sleeps until the next deadline: a free-running
+// wide timer supplies the system time, and its match interrupt is programmed to
+// the earliest scheduled event. Define to 0 for the 1 ms SysTick time base.
+#ifndef EVENT_TICKLESS
+#define EVENT_TICKLESS      1
+#endif
+
+// Keep the scheduled events in a hierarchical timing wheel, with O(1) scheduling
+// and cancelling; see event.c. Define to 0 for the bins of sorted lists behind
+// a heap, where scheduling walks the bin's list.
+#ifndef EVENT_WHEEL
+#define EVENT_WHEEL         1
+#endif
+
 typedef struct Event Event;
 typedef struct HeadEvent HeadEvent;
 
+// Priority classes. Of the events ready in one EventExecute() pass, those of a
+// higher class run first, and within a class, those of the earliest deadline.
+typedef enum
+{
+    EVENT_PRIORITY_HIGH,                // timing: beats and buzzer
+    EVENT_PRIORITY_NORMAL,              // the default
+    EVENT_PRIORITY_LOW,                 // user interface and display
+    EVENT_PRIORITIES
+} EventPriority;
+
+// Profiling: per-event dispatch figures (EventSetProfile()), and the CPU time
+// spent outside wfi, measured with utils/cpu_usage.c on Timer 3. Both are
+// sent on UART0 by EventProfileDump(). Define to 0 to leave them out.
+#ifndef EVENT_PROFILE
+#define EVENT_PROFILE       1
+#endif
+
+// Figures of one quantity over the dispatches of an event, in ticks. Histogram
+// bin 0 counts the zeros, bin k the values 2^(k-1) to 2^k - 1, and the last bin
+// all the larger ones.
+#define EVENT_HISTOGRAM_BINS 24
+
+typedef struct
+{
+    uint32_t count[EVENT_HISTOGRAM_BINS];
+    uint32_t min, max;
+    uint64_t sum;                       // for the mean
+} EventStats;
+
+// Profile of an event: how late it was dispatched after its time, and how long
+// its callback ran, measured with the DWT cycle counter
+typedef struct EventProfile
+{
+    const char *name;
+    uint32_t runs;
+    uint32_t missed;                    // dispatches after the deadline
+    EventStats lateness;
+    EventStats duration;
+    struct EventProfile *next;          // the list of profiles, for EventProfileDump()
+} EventProfile;
+
+// What a periodic event does when its callback ran past the next occurrence
+typedef enum
+{
+    EVENT_OVERRUN_SKIP,                 // drop the occurrences already past; keep the phase
+    EVENT_OVERRUN_BURST,                // run every missed occurrence, back to back
+} EventOverrun;
+
+// Period of a periodic event. The period is rarely a whole number of ticks, so
+// its fractional part is kept as a phase accumulator in units of 1/divisor
+// tick: occurrence N falls exactly floor(N * period) ticks after the anchor,
+// however many have run, with no division on the way.
+typedef struct
+{
+    time_t time;                        // ideal time of the current occurrence, the one
+                                        // running or last run (the anchor before the first)
+    uint32_t ticks;                     // whole ticks per period
+    uint32_t remainder;                 // fractional ticks per period, in 1/divisor tick
+    uint32_t divisor;
+    uint32_t phase;                     // accumulated fractional ticks, in 1/divisor tick
+    uint32_t skipped;                   // occurrences dropped by EVENT_OVERRUN_SKIP
+    EventOverrun overrun;
+} EventPeriod;
+
 // Define a type for callback functions
 typedef void (*Callback)(Event *ev);
 
@@ -66,25 +152,67 @@ struct Event
 {
     Event *prev, *next;                 // linked list of events
     time_t time;                        // time of this event, 0 if immediately
-    uint8_t bin;                        // the bin that the event is mapped to; see event.c
+    uint8_t bin;                        // the bin or wheel slot that the event is mapped to; see event.c
+    uint8_t priority;                   // priority class, EVENT_PRIORITY_NORMAL by default
     struct
     {
         uint8_t initialized : 1;        // if the event is initialized
         uint8_t scheduled : 1;          // if the event is scheduled
+        uint8_t due : 1;                // if the event waits in the due list of the wheel
+        uint8_t ready : 1;              // if the event's time has come and it waits to run
+        uint8_t periodic : 1;           // if the event runs again one period after each run
     } flags;
+    uint32_t deadline;                  // ticks after the event time it should run by, 0 for none
+    EventProfile *profile;              // figures to collect, NULL for none
+    EventPeriod *period;                // the period of a periodic event, NULL for none
     Callback callback;                  // callback function of this event
 };
 
+// EventSchedule() and EventDeschedule() are for thread context (the event
+// callbacks and main). ISRs use EventPost(), which queues the event for the
+// next EventExecute() without touching the scheduler. The main loop waits for
+// work in EventSleep(), which sees the posts that arrive after EventExecute().
+//
+// A periodic event is given its period with EventSetPeriod(), and started with
+// EventSchedulePeriodic(): it runs at the anchor time, and the scheduler
+// schedules it again one period after every run, until EventDeschedule(), or
+// EventSchedule() makes it a one-shot event again.
 void EventSchedulerInit();
 void EventInit(Event *event, Callback callback);
 void EventSchedule(Event *event, time_t time);
+void EventSchedulePeriodic(Event *event, time_t anchor);
+void EventSetPeriod(Event *event, EventPeriod *period, uint32_t ticks, uint32_t remainder, uint32_t divisor,
+                    EventOverrun overrun);
 void EventDeschedule(Event* event);
+void EventPost(Event *event, time_t time);
+void EventSetPriority(Event *event, EventPriority priority, uint32_t deadline);
+void EventSetProfile(Event *event, EventProfile *profile, const char *name);
+void EventProfileDump();
 void EventExecute();
+void EventSleep();
 time_t EventGetCurrentTime();
+uint32_t EventGetWakeupCount();
+uint32_t EventPostDroppedCount();
 
-inline bool EventInitialized(Event *event)
+static inline bool EventInitialized(Event *event)
 {
     return event->flags.initialized;
 }
 
+// Move a period to its next occurrence and return the occurrence's ideal time
+static inline time_t EventPeriodAdvance(EventPeriod *period)
+{
+    period->time += period->ticks;
+
+    // Carry one tick whenever the fractional ticks add up to a whole tick
+    period->phase += period->remainder;
+    if (period->phase >= period->divisor)
+    {
+        period->phase -= period->divisor;
+        period->time++;
+    }
+
+    return period->time;
+}
+
 #endif /* EVENT_H_ */
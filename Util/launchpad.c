@@ -41,6 +41,7 @@
  */
 
 #include "launchpad.h"
+#include <inc/hw_nvic.h>
 
 // System tick clock frequency, which is the PIOSC in this library
 #define SYSTICK_CLOCK_RATE 		16000000L
@@ -48,6 +49,19 @@
 // maximum size for callback queue, see below
 #define MAX_CALLBACK		    32
 
+// DWT control register, see CycleCounterInit()
+#define DWT_CTRL                0xE0001000
+
+#if EVENT_PROFILE
+// 'p' on UART0 sends the event profiles and the CPU time; see EventProfileDump()
+static Event profile_command_event;
+
+static void ProfileCommand(Event *event)
+{
+    EventProfileDump();
+}
+#endif
+
 /***************************************************************************************
  * System time wait functions
  **************************************************************************************/
@@ -67,6 +81,17 @@ void WaitUs(uint32_t timeUs)
     SysCtlDelay(delay_count);
 }
 
+/*
+ * Start the DWT cycle counter: enable the trace block (TRCENA in DEMCR),
+ * then the counter itself (CYCCNTENA in DWT_CTRL)
+ */
+void CycleCounterInit()
+{
+    HWREG(NVIC_DBG_INT) |= 0x01000000;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= 0x00000001;
+}
+
 /*
  * Initialize Tiva C LaunchPad for ECE 266 labs
  */
@@ -83,9 +108,15 @@ void LaunchPadInit()
                     | SYSCTL_XTAL_16MHZ);
     assert(SysCtlClockGet() == CPU_CLOCK_RATE);
 
+    // Start the cycle counter for profiling
+    CycleCounterInit();
+
     // Initialize the event-based scheduler
     EventSchedulerInit();
 
+    // Initialize the uDMA controller
+    DmaInit();
+
     // Initialize push button
     PushButtonInit();
 
@@ -94,4 +125,10 @@ void LaunchPadInit()
 
     // Initialize UART0
     UartInit();
+
+#if EVENT_PROFILE
+    EventInit(&profile_command_event, ProfileCommand);
+    EventSetPriority(&profile_command_event, EVENT_PRIORITY_LOW, 0);
+    UartCommandRegister('p', &profile_command_event);
+#endif
 }
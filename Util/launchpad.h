@@ -62,6 +62,7 @@
 #include <driverlib/uart.h>
 #include <driverlib/adc.h>
 #include <driverlib/timer.h>
+#include <driverlib/cpu.h>
 #include <assert.h>
 
 #include "event.h"
@@ -78,6 +79,30 @@ void LaunchPadInit();
 // Wait for a given number of microseconds, using loop waiting
 void WaitUs(uint32_t timeUs);
 
+// DWT cycle counter, which counts CPU clock cycles. It wraps around every 86
+// seconds at 50 MHz, so it is meant for measuring short durations.
+#define DWT_CYCCNT      0xE0001004
+
+// Start the cycle counter. This function is called from LaunchPadInit().
+void CycleCounterInit();
+
+// Read the cycle counter
+static inline uint32_t CycleCounterGet()
+{
+    return HWREG(DWT_CYCCNT);
+}
+
+/*****************************************************************************
+ * uDMA functions
+ ****************************************************************************/
+
+// Enable the uDMA controller and its channel control table. This function is
+// called from LaunchPadInit(); drivers then configure their own channels.
+void DmaInit();
+
+// Return the number of uDMA bus errors so far
+uint32_t DmaErrorCount();
+
 /*****************************************************************************
  * LEDs functions
  *
@@ -92,38 +117,153 @@ void LedTurnOnOff(bool red, bool blue, bool green);
 
 /****************************************************************************
  * Push button functions
+ *
+ * Each button is debounced on its own, by events, and its presses, releases,
+ * long presses and auto-repeats are queued as inputs, with the two buttons
+ * pressed together reported as a chord.
  ****************************************************************************/
 
+// Buttons, as in PushButtonInput.buttons
+#define PUSH_BUTTON_SW1             1
+#define PUSH_BUTTON_SW2             2
+
+// Timing of the inputs, in ms. A press is held back for the chord window, in
+// case the other button follows; a long press comes after the long-press delay,
+// and then an auto-repeat every repeat interval while the button stays down.
+#define PUSH_BUTTON_DEBOUNCE_DELAY  20
+#define PUSH_BUTTON_CHORD_WINDOW    50
+#define PUSH_BUTTON_LONG_DELAY      600
+#define PUSH_BUTTON_REPEAT_INTERVAL 150
+
+// Inputs queued for the program
+typedef enum
+{
+    PUSH_BUTTON_PRESS,
+    PUSH_BUTTON_RELEASE,
+    PUSH_BUTTON_LONG,
+    PUSH_BUTTON_REPEAT,
+    PUSH_BUTTON_CHORD,          // both buttons, instead of their presses
+} PushButtonInputType;
+
+typedef struct
+{
+    uint8_t type;               // PushButtonInputType
+    uint8_t buttons;            // PUSH_BUTTON_SW1 and/or PUSH_BUTTON_SW2
+    time_t time;                // of the first edge of a press or release, so
+                                // tapping keeps its rhythm; else of the input
+} PushButtonInput;
+
 // Initialize the push button. This function is called from LaunchPadInit().
 void PushButtonInit();
 
-// Read push button input recorded by push button ISR
+// Take the oldest input from the queue; return false if there is none
+bool PushButtonGetInput(PushButtonInput *input);
+
+// Return the button of the next press in the queue, 1 for SW1 and 2 for SW2,
+// or 0 if there is none; the other inputs before it are dropped
 int PushButtonRead();
 
-// Set callback event for push button ISR
+// Set the event scheduled whenever an input is queued
 void PushButtonEventRegister(Event *callback_event);
 
-// Change the de-bouncing delay
+// Change the de-bouncing delay, in ms
 void PushButtonSetDebouncingDelay(int debouncing_delay);
 
+// Inputs lost to a full queue
+uint32_t PushButtonDroppedCount();
+
 /****************************************************************************
  * UART functions
+ *
+ * Output goes through a transmit buffer that the UART0 TX interrupt drains,
+ * or the uDMA with UART_TX_UDMA, so sending never waits for the line. The
+ * send functions are for thread code (event callbacks); from an ISR, the
+ * output is dropped and counted, whatever the policy.
  ****************************************************************************/
 
+// Drain the transmit buffer with the uDMA instead of the TX FIFO interrupt
+#ifndef UART_TX_UDMA
+#define UART_TX_UDMA 0
+#endif
+
+// What the send functions do with output that does not fit in the transmit buffer
+typedef enum
+{
+    UART_TX_DROP,       // drop it whole, and count the dropped bytes (the default)
+    UART_TX_BLOCK,      // sleep until it fits
+} UartTxPolicy;
+
 // Enable UART0 with baud rate of 115,200 bps, and 8-N-1 frame
 void UartInit();
 
+// Set the overflow policy of the transmit buffer
+void UartSetTxPolicy(UartTxPolicy policy);
+
 // Send a character
 void UartPutChar(char ch);
 
-// Receive a character
+// Receive a character. Not for use once a command is registered.
 char UartGetChar();
 
-// Send a string
+// Have a character received on UART0 post an event from the UART ISR, as a
+// command. Up to 4 commands; see LaunchPadInit() for those of the library.
+void UartCommandRegister(char ch, Event *event);
+
+// Send a string. Return the number of characters queued, 0 if it was dropped.
 int UartPutString(char *buffer);
 
 // Print a string through UART0 using an internal buffer of 80 characters.
-// Return the number of characters printed.
+// Return the number of characters queued, 0 if it was dropped.
 int uprintf(char* fmt, ...);
 
+// Number of bytes dropped by the UART_TX_DROP policy so far
+uint32_t UartTxDroppedCount();
+
+// Most bytes ever waiting in the transmit buffer
+uint32_t UartTxHighWater();
+
+/****************************************************************************
+ * Trace functions
+ *
+ * A trace message is a format ID from trace_formats.h and up to three 32-bit
+ * arguments. The call stores them, with a sequence number and a cycle counter
+ * timestamp, in a binary trace buffer, which the UART ISR then sends between
+ * the lines of text; formatting is left to the host (Host/trace_decode.c).
+ * A message costs a few dozen cycles, and may be logged from any ISR.
+ ****************************************************************************/
+
+// Compile the TRACE macros into the firmware
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+typedef enum
+{
+#define TRACE_FORMAT(id, format) id,
+#include "trace_formats.h"
+#undef TRACE_FORMAT
+} TraceId;
+
+// First word of a record on the wire: a byte with the top bit set (text is 7-bit
+// ASCII) holding the argument count, the format ID, then the 16-bit sequence number
+#define TRACE_HEADER(id, count)     (0x80 | (count) | ((uint32_t) (id) << 8))
+
+#if TRACE_ENABLED
+#define TRACE0(id)              TraceLog(TRACE_HEADER(id, 0), 0, 0, 0)
+#define TRACE1(id, a)           TraceLog(TRACE_HEADER(id, 1), (a), 0, 0)
+#define TRACE2(id, a, b)        TraceLog(TRACE_HEADER(id, 2), (a), (b), 0)
+#define TRACE3(id, a, b, c)     TraceLog(TRACE_HEADER(id, 3), (a), (b), (c))
+#else
+#define TRACE0(id)              ((void) 0)
+#define TRACE1(id, a)           ((void) 0)
+#define TRACE2(id, a, b)        ((void) 0)
+#define TRACE3(id, a, b, c)     ((void) 0)
+#endif
+
+// Log a trace message; use the TRACE macros instead
+void TraceLog(uint32_t header, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+
+// Number of trace messages dropped on a full trace buffer so far
+uint32_t TraceDroppedCount();
+
 #endif  // LAUNCHPAD_H_
@@ -34,6 +34,7 @@ void LedInit()
 {
     /// Enable the GPIO used by LED (Port F)
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_GPIOF);
 
     /// Enable the three pins used by LED
     GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_1);     // RED
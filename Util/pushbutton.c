@@ -11,7 +11,12 @@
  *     (zzhang)
  * ----------------------------
  *
- * The latest version uses push button ISR
+ * The latest version debounces each button with events: the pin interrupt, on both edges, is
+ * turned off at the first edge and an event samples the pin once the debouncing delay is over,
+ * then turns it back on. An edge in the meantime is latched and starts another delay, so a
+ * bouncing contact is sampled once it has been still; the buttons never lock each other out.
+ * The debounced presses and releases, long presses, auto-repeats and chords are queued as
+ * inputs for the program, each press with the time of its first edge.
  *
  * Pushbutton pin map: SW1 => PF4, SW2 => PF0
  *
@@ -26,31 +31,60 @@
  * Global declarations
  */
 
+#define INPUT_QUEUE_SIZE    16          // inputs, a power of 2
+
+// State of one button
+typedef struct {
+    uint8_t pin;                        // GPIO_PIN_4 for SW1, GPIO_PIN_0 for SW2
+    uint8_t code;                       // PUSH_BUTTON_SW1 or PUSH_BUTTON_SW2
+    bool down;                          // the debounced state
+    bool press_pending;                 // down, and the press held back for the chord window
+    bool long_sent;                     // the long press of this press is queued
+    time_t edge_time;                   // first edge of the current debouncing delay
+    time_t press_time;                  // first edge of the current press
+    time_t hold_time;                   // time of the next long press or repeat
+    Event settle_event;                 // samples the pin after the debouncing delay
+    Event hold_event;                   // the press after the chord window, the long press
+                                        // and the repeats
+} Button;
+
 // Pushbutton input state
 typedef struct {
     Event *callback_event;
-    uint32_t debouncing_delay;
-    uint32_t pin_value;
-    bool new_input;
+    time_t debouncing_delay;            // in ticks
+    Button button[2];                   // SW1, SW2
+    PushButtonInput queue[INPUT_QUEUE_SIZE];
+    uint8_t head, tail;                 // queue indices, wrapping
+    uint32_t dropped;
 } PushButtonState;
 
 static PushButtonState push_button;
 
-// pre-declare the ISR function
+// pre-declare the ISR and event functions
 static void PushButtonISR();
+static void PushButtonSettle(Event *event);
+static void PushButtonHold(Event *event);
 
 /*
  * Initialize the push button with interrupt enabled
  */
 void PushButtonInit()
 {
+    int i;
+
     // Initialize push button state
     push_button.callback_event = NULL;
-    push_button.debouncing_delay = 250;
-    push_button.new_input = false;
+    push_button.debouncing_delay = MS_TO_TICKS(PUSH_BUTTON_DEBOUNCE_DELAY);
+    push_button.head = push_button.tail = 0;
+    push_button.dropped = 0;
+    push_button.button[0].pin = GPIO_PIN_4;
+    push_button.button[0].code = PUSH_BUTTON_SW1;
+    push_button.button[1].pin = GPIO_PIN_0;
+    push_button.button[1].code = PUSH_BUTTON_SW2;
 
     /// Enable PF and configure PF0 and PF4 to output
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_GPIOF);
     GPIOPinTypeGPIOInput(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4);
 
     /// The following comment and code are copied from buttons.c
@@ -70,11 +104,22 @@ void PushButtonInit()
     GPIOPadConfigSet(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4,
             GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
 
-    // Set interrupt on Port F, pin 0 (SW1) and pin 4 (SW2)
+    // A button held down at reset is taken as down, without a press
+    for (i = 0; i < 2; i++) {
+        Button *button = &push_button.button[i];
+
+        button->down = GPIOPinRead(GPIO_PORTF_BASE, button->pin) == 0;
+        button->press_pending = false;
+        EventInit(&button->settle_event, PushButtonSettle);
+        EventInit(&button->hold_event, PushButtonHold);
+    }
+
+    // Set interrupt on Port F, pin 0 (SW2) and pin 4 (SW1)
     GPIOIntRegister(GPIO_PORTF_BASE, PushButtonISR); // register the interrupt handler
-    GPIOIntTypeSet(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4, // interrupt on falling edge, note that SW1 and SW2 are active low
-                   GPIO_FALLING_EDGE);
+    GPIOIntTypeSet(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4, // interrupt on both edges, to debounce
+                   GPIO_BOTH_EDGES);                        // presses and releases alike
     IntPrioritySet(INT_GPIOF, 0); // set interrupt level to 0 (0 is the highest for programmable interrupts)
+    GPIOIntClear(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4);
     GPIOIntEnable(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4); // enable interrupts on SW1 and SW2 input
 }
 
@@ -86,7 +131,24 @@ void PushButtonEventRegister(Event* callback_event)
 
 void PushButtonSetDebouncingDelay(int debouncing_delay)
 {
-    push_button.debouncing_delay = debouncing_delay;
+    push_button.debouncing_delay = MS_TO_TICKS(debouncing_delay);
+}
+
+uint32_t PushButtonDroppedCount()
+{
+    return push_button.dropped;
+}
+
+/*
+ * Take the oldest input from the queue
+ */
+bool PushButtonGetInput(PushButtonInput *input)
+{
+    if (push_button.tail == push_button.head)
+        return false;
+
+    *input = push_button.queue[push_button.tail++ % INPUT_QUEUE_SIZE];
+    return true;
 }
 
 /*
@@ -94,47 +156,153 @@ void PushButtonSetDebouncingDelay(int debouncing_delay)
  */
 int PushButtonRead()
 {
-    // If there is no new input, return 0
-    if (!push_button.new_input)
-        return 0;
+    PushButtonInput input;
 
-    // Reset new input flag
-    push_button.new_input = false;
+    // Skip to the next press; if there is none, return 0
+    while (PushButtonGetInput(&input)) {
+        if (input.type == PUSH_BUTTON_PRESS)
+            return input.buttons;
+    }
 
-    // Convert raw input to input code and return it
-    if (push_button.pin_value & GPIO_PIN_4) {
-        return 1;       // for SW1
+    return 0;
+}
+
+/*
+ * Queue an input and schedule the callback event. The queue is only used in thread context.
+ */
+static void PushButtonQueue(PushButtonInputType type, uint8_t buttons, time_t time)
+{
+    PushButtonInput *input;
+
+    if ((uint8_t) (push_button.head - push_button.tail) == INPUT_QUEUE_SIZE) {
+        push_button.dropped++;
+        return;
     }
-    else if (push_button.pin_value & GPIO_PIN_0) {
-        return 2;       // for SW2
+
+    input = &push_button.queue[push_button.head % INPUT_QUEUE_SIZE];
+    input->type = type;
+    input->buttons = buttons;
+    input->time = time;
+    push_button.head++;
+    TRACE2(TRACE_BUTTON_INPUT, buttons, type);
+
+    if (push_button.callback_event != NULL)
+        EventSchedule(push_button.callback_event, EventGetCurrentTime());
+}
+
+// The button of an event of its own
+static Button *ButtonOf(Event *event)
+{
+    Button *button = &push_button.button[0];
+
+    if (event != &button->settle_event && event != &button->hold_event)
+        button++;
+    return button;
+}
+
+/*
+ * A debounced press: held back for the chord window, unless it completes a chord
+ */
+static void ButtonPressed(Button *button)
+{
+    Button *other = &push_button.button[button == &push_button.button[0]];
+    time_t now = EventGetCurrentTime();
+
+    button->press_time = button->edge_time;
+    button->long_sent = false;
+
+    // Both down within the chord window: one chord instead of two presses; neither button
+    // then has a long press or repeats
+    if (other->press_pending) {
+        other->press_pending = false;
+        EventDeschedule(&other->hold_event);
+        PushButtonQueue(PUSH_BUTTON_CHORD, PUSH_BUTTON_SW1 | PUSH_BUTTON_SW2, other->press_time);
+        return;
     }
-    else
-        return 0;
+
+    button->press_pending = true;
+    EventSchedule(&button->hold_event, now + MS_TO_TICKS(PUSH_BUTTON_CHORD_WINDOW));
 }
 
 /*
- * Push button ISR
+ * A debounced release. A press shorter than the chord window is queued first.
  */
-static void PushButtonISR()
+static void ButtonReleased(Button *button)
 {
-    static uint32_t last_event_time = 0;      // remember last pushing time
+    if (button->press_pending) {
+        button->press_pending = false;
+        PushButtonQueue(PUSH_BUTTON_PRESS, button->code, button->press_time);
+    }
+    if (button->hold_event.flags.scheduled)
+        EventDeschedule(&button->hold_event);
 
-    // Read Port F. SW1 and SW2 are active low, so invert the reading
-    uint32_t pin_value = ~GPIOPinRead(GPIO_PORTF_BASE, GPIO_PIN_4 | GPIO_PIN_0);
+    PushButtonQueue(PUSH_BUTTON_RELEASE, button->code, button->edge_time);
+}
 
-    // De-bouncing: If a key was pushed within 250 ms, ignore this event
-    uint32_t current_time = EventGetCurrentTime();
-    if (current_time > last_event_time + push_button.debouncing_delay) {
-        push_button.pin_value = pin_value;
-        push_button.new_input = true;
-        last_event_time = current_time;
+/*
+ * Settle event: the debouncing delay is over; take the state of the pin and watch it again
+ */
+static void PushButtonSettle(Event *event)
+{
+    Button *button = ButtonOf(event);
+    bool down = GPIOPinRead(GPIO_PORTF_BASE, button->pin) == 0; // SW1 and SW2 are active low
+
+    if (down != button->down) {
+        button->down = down;
+        if (down)
+            ButtonPressed(button);
+        else
+            ButtonReleased(button);
     }
 
-    // Schedule callback event
-    if (push_button.callback_event != NULL)
-        EventSchedule(push_button.callback_event, EventGetCurrentTime());
+    // An edge during the delay is still latched, and interrupts at once for another delay
+    GPIOIntEnable(GPIO_PORTF_BASE, button->pin);
+}
 
-    // IMPORTANT: Clear interrupt flag
-    GPIOIntClear(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4);
+/*
+ * Hold event: the press once the chord window is over, then the long press, then a repeat
+ * every repeat interval, on a fixed grid from the first edge of the press
+ */
+static void PushButtonHold(Event *event)
+{
+    Button *button = ButtonOf(event);
+
+    if (button->press_pending) {
+        button->press_pending = false;
+        PushButtonQueue(PUSH_BUTTON_PRESS, button->code, button->press_time);
+        button->hold_time = button->press_time + MS_TO_TICKS(PUSH_BUTTON_LONG_DELAY);
+    }
+    else {
+        PushButtonQueue(button->long_sent ? PUSH_BUTTON_REPEAT : PUSH_BUTTON_LONG, button->code,
+                        button->hold_time);
+        button->long_sent = true;
+        button->hold_time += MS_TO_TICKS(PUSH_BUTTON_REPEAT_INTERVAL);
+    }
+
+    EventSchedule(&button->hold_event, button->hold_time);
 }
 
+/*
+ * Push button ISR
+ */
+static void PushButtonISR()
+{
+    // Read which pins changed; IMPORTANT: clear their interrupt flags
+    uint32_t status = GPIOIntStatus(GPIO_PORTF_BASE, true);
+    time_t current_time = EventGetCurrentTime();
+    int i;
+
+    GPIOIntClear(GPIO_PORTF_BASE, status);
+
+    // De-bouncing: leave a changed pin alone for the debouncing delay, then sample it in thread
+    // context; the other button keeps its interrupt
+    for (i = 0; i < 2; i++) {
+        Button *button = &push_button.button[i];
+
+        if (status & button->pin) {
+            GPIOIntDisable(GPIO_PORTF_BASE, button->pin);
+            button->edge_time = current_time;
+            EventPost(&button->settle_event, current_time + push_button.debouncing_delay);
+        }
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ * trace_formats.h: Format strings of the binary trace log
+ *
+ * ----------------------------
+ *  Created on: Dec 9, 2025
+ *     Author: Brian Reeder
+ *
+ *  Contact:
+ *   brianreeder124@gmail.com
+ *   brian-reeder-1 (GitHub)
+ * ----------------------------
+ *
+ * One TRACE_FORMAT(id, format) entry per trace message. launchpad.h builds the TraceId
+ * enumeration from this list and the host decoder (Host/trace_decode.c) its format table, so
+ * the IDs on the wire always match. Arguments are 32-bit integers, printed with the format on
+ * the host. Add new entries at the end, so older captures still decode.
+ *
+ * This file has no include guard; define TRACE_FORMAT before including it.
+ */
+
+TRACE_FORMAT(TRACE_EVENT_DISPATCH,  "event %08x dispatched %u ticks late")
+TRACE_FORMAT(TRACE_TEMPO_CHANGE,    "tempo changed to %u BPM")
+TRACE_FORMAT(TRACE_BUTTON_INPUT,    "button %u input %u")
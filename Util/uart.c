@@ -17,15 +17,66 @@
 #include <stdbool.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <inc/hw_ints.h>
 #include <inc/hw_memmap.h>
+#include <inc/hw_nvic.h>
+#include <inc/hw_uart.h>
 #include <driverlib/gpio.h>
 #include <driverlib/pin_map.h>
 #include <driverlib/sysctl.h>
 #include <driverlib/uart.h>
+#include <driverlib/udma.h>
+#include <utils/ringbuf.h>
+#include "launchpad.h"
 
 #define LINE_SIZE 	80		// Line size limit for uprintf
 
+// Transmit buffer size: about 44 ms of output at 115,200 bps; a power of 2 for the
+// lock-free ring buffer (RINGBUF_SPSC)
+#define TX_BUFFER_SIZE	512
+
+// Largest uDMA transfer
+#define TX_DMA_MAX		1024
+
+// Transmit buffer, written by the send functions and read by the UART ISR
+static uint8_t tx_buffer[TX_BUFFER_SIZE];
+static tRingBufObject tx_ring;
+
+static UartTxPolicy tx_policy = UART_TX_DROP;
+static volatile uint32_t tx_dropped = 0;
+static uint32_t tx_high_water = 0;
+
+#if UART_TX_UDMA
+// Length of the transfer in progress; its bytes stay in the buffer until it completes
+static uint32_t tx_dma_length = 0;
+#endif
+
+static bool uart_ready = false;
+
+// Commands: a received character that matches one posts its event
+#define MAX_COMMANDS	4
+
+static struct {
+	char ch;
+	Event *event;
+} commands[MAX_COMMANDS];
+static int command_count = 0;
+
+// Trace buffer, in words; a power of 2. Records are written by TraceLog() from any context,
+// and moved to the transmit buffer by the UART ISR. A writer claims the words of its record
+// and its sequence number together, in trace_claim: the head in the low half, counting words
+// and wrapping at 2^16, and the next sequence number in the high half. The header of a record
+// is written last, and the ISR zeroes every word it moves out, so a zero header is a record
+// still being written.
+#define TRACE_BUFFER_WORDS	256
+#define TRACE_BUFFER_MASK	(TRACE_BUFFER_WORDS - 1)
+
+static volatile uint32_t trace_buffer[TRACE_BUFFER_WORDS];
+static volatile uint32_t trace_claim = 0;
+static volatile uint16_t trace_tail = 0;
+static volatile uint32_t trace_dropped = 0;
+
 // Declare GPIO_PA0_U0RX and GPIO_PA1_U0TX if they are not declared yet
 // For some reason, those are not declared in TivaWare for device LM4F120H5QR
 #ifndef GPIO_PA0_U0RX
@@ -35,12 +86,141 @@
 #define GPIO_PA1_U0TX           0x00000401
 #endif
 
+// Keep the UART ISR out of the transmit buffer while thread code writes it. Only the UART
+// interrupt is masked, so the beat timer and the other ISRs keep their timing.
+static inline void UartTxLock()
+{
+	IntDisable(INT_UART0);
+}
+
+static inline void UartTxUnlock()
+{
+	if (uart_ready)
+		IntEnable(INT_UART0);
+}
+
+// Move output from the transmit buffer to the UART: fill the TX FIFO, or start the next
+// uDMA transfer once the last one is complete. Called from the UART ISR, or with the
+// UART interrupt disabled.
+static void UartTxService()
+{
+	// Move whole trace records to the transmit buffer while they fit, up to one still being
+	// written; its writer sends the UART interrupt when it is done
+	while ((uint16_t) trace_claim != trace_tail) {
+		uint32_t tail = trace_tail;
+		uint32_t header = trace_buffer[tail & TRACE_BUFFER_MASK];
+		uint32_t words = 2 + (header & 0x03);
+		uint32_t i;
+
+		if (header == 0 || RingBufFree(&tx_ring) < 4 * words)
+			break;
+		RingBufBarrier();
+		for (i = 0; i < words; i++) {
+			RingBufWrite(&tx_ring, (uint8_t *) &trace_buffer[(tail + i) & TRACE_BUFFER_MASK], 4);
+			trace_buffer[(tail + i) & TRACE_BUFFER_MASK] = 0;
+		}
+		RingBufBarrier();
+		trace_tail = tail + words;
+	}
+
+#if UART_TX_UDMA
+	tRingBufSpan span[2];
+
+	if (uDMAChannelIsEnabled(UDMA_CHANNEL_UART0TX))
+		return;
+
+	// The transfer is complete; release its bytes and send the next contiguous run, in place;
+	// the run after the wrap, if any, goes next time
+	RingBufReadRelease(&tx_ring, tx_dma_length);
+	RingBufReadPeek(&tx_ring, TX_DMA_MAX, span);
+	tx_dma_length = span[0].ui32Length;
+
+	if (tx_dma_length > 0) {
+		uDMAChannelTransferSet(UDMA_CHANNEL_UART0TX | UDMA_PRI_SELECT, UDMA_MODE_BASIC, span[0].pui8Data,
+							   (void *) (UART0_BASE + UART_O_DR), tx_dma_length);
+		uDMAChannelEnable(UDMA_CHANNEL_UART0TX);
+	}
+#else
+	while (!RingBufEmpty(&tx_ring) && UARTSpaceAvail(UART0_BASE))
+		UARTCharPutNonBlocking(UART0_BASE, RingBufReadOne(&tx_ring));
+#endif
+}
+
+// Look up the received characters among the commands
+static void UartRxService()
+{
+	int i;
+
+	while (UARTCharsAvail(UART0_BASE)) {
+		char ch = UARTCharGetNonBlocking(UART0_BASE);
+		for (i = 0; i < command_count; i++)
+			if (commands[i].ch == ch)
+				EventPost(commands[i].event, EventGetCurrentTime());
+	}
+}
+
+// UART0 ISR: the TX FIFO drained to its trigger level, a uDMA transfer completed, or
+// characters were received
+static void UartISR()
+{
+	uint32_t status = UARTIntStatus(UART0_BASE, true);
+
+	UARTIntClear(UART0_BASE, status);
+	if (status & (UART_INT_RX | UART_INT_RT))
+		UartRxService();
+	UartTxService();
+}
+
+// Queue bytes for sending, following the overflow policy. Return the number of bytes queued.
+// Thread code is the only caller that writes the buffer: output from an ISR is dropped, since
+// it could land in the middle of a write that it interrupted (ISRs have the trace log).
+static int UartWrite(uint8_t *data, uint32_t length)
+{
+	bool in_isr = (HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M) != 0;
+	uint32_t written = 0, used;
+
+	// Dropping the whole message keeps partial lines out of the output
+	if (in_isr || (length > RingBufFree(&tx_ring) && tx_policy == UART_TX_DROP)) {
+		tx_dropped += length;
+		return 0;
+	}
+
+	// Messages longer than the buffer go in pieces, waiting for the ISR to make room. The UART
+	// ISR adds trace records to the buffer, so it is held off while writing. The TX interrupt
+	// comes only when the FIFO drains past its trigger level, so output written to an idle UART
+	// is moved by hand.
+	while (true) {
+		uint32_t n;
+
+		UartTxLock();
+		n = RingBufFree(&tx_ring);
+		if (n > length - written)
+			n = length - written;
+		RingBufWrite(&tx_ring, data + written, n);
+		written += n;
+
+		used = RingBufUsed(&tx_ring);
+		if (used > tx_high_water)
+			tx_high_water = used;
+
+		UartTxService();
+		UartTxUnlock();
+		if (written == length)
+			break;
+		CPUwfi();
+	}
+
+	return length;
+}
+
 // Enable UART0 with baud rate of 115,200 bps, and 8-N-1 frame
 void UartInit()
 {
 	// Enable UART0 and GPIO Port A as peripherals
 	SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+	SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_UART0);
 	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+	SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_GPIOA);
 
 	// Connect UART0 RX and TX pins
 	GPIOPinConfigure(GPIO_PA0_U0RX);
@@ -50,12 +230,52 @@ void UartInit()
 	// Configure baud rate and frame format
 	UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(), 115200,
 			            UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+
+	RingBufInit(&tx_ring, tx_buffer, TX_BUFFER_SIZE);
+
+#if UART_TX_UDMA
+	// The uDMA refills the TX FIFO in bursts of 8 whenever it is half empty, and the
+	// completion of a transfer raises the UART0 interrupt
+	UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+	uDMAChannelAttributeDisable(UDMA_CHANNEL_UART0TX, UDMA_ATTR_ALL);
+	uDMAChannelControlSet(UDMA_CHANNEL_UART0TX | UDMA_PRI_SELECT,
+						  UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_8);
+	UARTDMAEnable(UART0_BASE, UART_DMA_TX);
+#else
+	// The TX interrupt comes when the FIFO drains to 2 characters, which leaves the ISR
+	// 170 us to refill it before the line goes idle
+	UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
+	UARTIntEnable(UART0_BASE, UART_INT_TX);
+#endif
+
+	// Output is the least urgent work, so the ISR has the lowest priority
+	UARTIntRegister(UART0_BASE, UartISR);
+	IntPrioritySet(INT_UART0, 0xE0);
+	uart_ready = true;
+}
+
+// Set the overflow policy of the transmit buffer
+void UartSetTxPolicy(UartTxPolicy policy)
+{
+	tx_policy = policy;
 }
 
 // Send a character through UART0
 void UartPutChar(char ch)
 {
-    UARTCharPut(UART0_BASE, ch);
+	UartWrite((uint8_t *) &ch, 1);
+}
+
+// Have a character received on UART0 post an event
+void UartCommandRegister(char ch, Event *event)
+{
+	assert(command_count < MAX_COMMANDS && EventInitialized(event));
+	commands[command_count].ch = ch;
+	commands[command_count].event = event;
+	command_count++;
+
+	// The RX interrupt comes with 8 characters in the FIFO, or after a pause of 32 bit times
+	UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
 }
 
 // Receive a character through UART0
@@ -65,22 +285,14 @@ char UartGetChar()
 	return ch;
 }
 
+// Send a string through UART0. Return the number of characters queued.
 int UartPutString(char *buffer)
 {
-	char ch;
-	int n = 0;
-
-	// Repeat sending the char at the head until the NULL is seen
-	while ((ch = *buffer++) != '\0') {
-		UartPutChar(ch);
-		n++;
-	}
-
-	return n;
+	return UartWrite((uint8_t *) buffer, strlen(buffer));
 }
 
 // Print a string through UART0 using an internal buffer of 80 characters.
-// Return the number of characters printed.
+// Return the number of characters queued.
 int uprintf(char* fmt, ...)
 {
 	static char buffer[LINE_SIZE+1];	// an internal buffer of 81 characters
@@ -95,3 +307,97 @@ int uprintf(char* fmt, ...)
 	return UartPutString(buffer);
 }
 
+// Return the number of bytes dropped by the UART_TX_DROP policy so far
+uint32_t UartTxDroppedCount()
+{
+	return tx_dropped;
+}
+
+// Return the most bytes ever waiting in the transmit buffer
+uint32_t UartTxHighWater()
+{
+	return tx_high_water;
+}
+
+// Claim trace words: store next in trace_claim if it still holds *claim, or else load it into
+// *claim. GCC and clang, tiarmclang among them, compile the builtin to LDREX/STREX; other
+// compilers mask the interrupts for the compare and store.
+static inline bool TraceClaim(uint32_t *claim, uint32_t next)
+{
+#if defined(__GNUC__) && !defined(__TI_COMPILER_VERSION__)
+	return __atomic_compare_exchange_n(&trace_claim, claim, next, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+	bool masked = CPUcpsid();
+	bool claimed = trace_claim == *claim;
+
+	if (claimed)
+		trace_claim = next;
+	else
+		*claim = trace_claim;
+	if (!masked)
+		CPUcpsie();
+	return claimed;
+#endif
+}
+
+// Count a dropped trace message, from any context
+static inline void TraceDrop()
+{
+#if defined(__GNUC__) && !defined(__TI_COMPILER_VERSION__)
+	__atomic_fetch_add(&trace_dropped, 1, __ATOMIC_RELAXED);
+#else
+	bool masked = CPUcpsid();
+
+	trace_dropped++;
+	if (!masked)
+		CPUcpsie();
+#endif
+}
+
+/*
+ * Log a trace message: store its header, timestamp and arguments in the trace buffer,
+ * and have the UART ISR send it. A message that does not fit is dropped, and its
+ * sequence number skipped so the decoder sees the gap. No interrupt is disabled: the
+ * words and the sequence number are claimed with a compare-and-swap (LDREX/STREX on
+ * the Cortex-M4), which fails and is tried again if an ISR logs in between.
+ */
+void TraceLog(uint32_t header, uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+	uint32_t count = header & 0x03;
+	uint32_t claim = trace_claim, next;
+	uint16_t head;
+	bool fits;
+
+	do {
+		head = (uint16_t) claim;
+		fits = (uint16_t) (head - trace_tail) + 2 + count <= TRACE_BUFFER_WORDS;
+		next = (claim & 0xFFFF0000) + 0x10000 + (uint16_t) (fits ? head + 2 + count : head);
+	} while (!TraceClaim(&claim, next));
+
+	if (!fits) {
+		TraceDrop();
+		return;
+	}
+
+	trace_buffer[(head + 1) & TRACE_BUFFER_MASK] = CycleCounterGet();
+	if (count > 0)
+		trace_buffer[(head + 2) & TRACE_BUFFER_MASK] = arg0;
+	if (count > 1)
+		trace_buffer[(head + 3) & TRACE_BUFFER_MASK] = arg1;
+	if (count > 2)
+		trace_buffer[(head + 4) & TRACE_BUFFER_MASK] = arg2;
+	RingBufBarrier();
+	trace_buffer[head & TRACE_BUFFER_MASK] = header | (claim & 0xFFFF0000);
+	RingBufBarrier();
+
+	// The ISR keeps going until the trace buffer is empty or it reaches a record still being
+	// written, so a record starts it only if the ISR stopped at it
+	if (trace_tail == head && uart_ready)
+		IntPendSet(INT_UART0);
+}
+
+// Return the number of trace messages dropped on a full trace buffer so far
+uint32_t TraceDroppedCount()
+{
+	return trace_dropped;
+}